@@ -0,0 +1,97 @@
+// Per-packet cost of AnomalyDetector state lookups at varying source
+// cardinalities: the previous string-keyed map layout against the interned,
+// ID-indexed layout used by AnomalyDetector.
+//
+// Run under `perf stat -e cache-misses,cache-references` to see the
+// difference in cache misses per packet as cardinality grows.
+
+#include "AnomalyDetector.h"
+#include "SourceInterner.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace anomaly;
+
+namespace {
+
+constexpr size_t kPackets = 2'000'000;
+
+std::vector<Packet> makeTraffic(size_t cardinality) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, cardinality - 1);
+
+    std::vector<std::string> sources;
+    sources.reserve(cardinality);
+    for (size_t i = 0; i < cardinality; ++i) {
+        sources.push_back("10." + std::to_string((i >> 16) & 0xFF) + "." +
+                          std::to_string((i >> 8) & 0xFF) + "." +
+                          std::to_string(i & 0xFF));
+    }
+
+    std::vector<Packet> packets;
+    packets.reserve(kPackets);
+    for (size_t i = 0; i < kPackets; ++i) {
+        packets.emplace_back(sources[pick(rng)], "10.200.0.1", 5000, 80,
+                             Protocol::TCP, 512, 5.0);
+    }
+    return packets;
+}
+
+template <typename Fn>
+double nsPerPacket(const std::vector<Packet>& packets, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& p : packets) fn(p);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(packets.size());
+}
+
+struct LegacyWindow {
+    int64_t index{0};
+    uint32_t count{0};
+};
+
+} // namespace
+
+int main() {
+    std::printf("%12s %16s %16s %16s\n",
+                "sources", "string-map ns", "interned ns", "analyze() ns");
+
+    for (size_t cardinality : {1'000u, 100'000u, 1'000'000u}) {
+        auto packets = makeTraffic(cardinality);
+
+        // Previous layout: one string hash per lookup plus count()/at()
+        std::unordered_map<std::string, LegacyWindow> legacy;
+        uint64_t sink = 0;
+        double legacy_ns = nsPerPacket(packets, [&](const Packet& p) {
+            auto& w = legacy[p.src_ip];
+            ++w.count;
+            sink += legacy.count(p.src_ip) ? legacy.at(p.src_ip).count : 0;
+        });
+
+        // Interned layout: one integer hash, then array indexing
+        SourceInterner interner;
+        std::vector<LegacyWindow> dense;
+        double interned_ns = nsPerPacket(packets, [&](const Packet& p) {
+            uint32_t id = interner.intern(p.src_ip);
+            if (id >= dense.size()) dense.resize(interner.capacity());
+            sink += ++dense[id].count;
+        });
+
+        DetectorConfig config;
+        config.flood_threshold = UINT32_MAX;
+        AnomalyDetector detector(config);
+        double analyze_ns = nsPerPacket(packets, [&](const Packet& p) {
+            sink += detector.analyze(p).has_value();
+        });
+
+        std::printf("%12zu %16.1f %16.1f %16.1f\n",
+                    cardinality, legacy_ns, interned_ns, analyze_ns);
+        if (sink == 0) std::printf("\n");
+    }
+    return 0;
+}
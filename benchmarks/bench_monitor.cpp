@@ -0,0 +1,129 @@
+// NetworkMonitor throughput against worker count. Each run uses as many
+// feeding threads as workers and a detector with one shard per worker, so
+// ideal scaling is linear until producers or memory bandwidth saturate.
+// A second table shows the producer-side cost of each ingest entry point.
+//
+//   bench_monitor [max_workers]   (default: hardware threads)
+
+#include "NetworkMonitor.h"
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace anomaly;
+
+namespace {
+
+constexpr size_t kPackets = 4'000'000;
+
+std::vector<Packet> makeTraffic(size_t cardinality) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, cardinality - 1);
+
+    std::vector<Packet> packets;
+    packets.reserve(kPackets);
+    for (size_t i = 0; i < kPackets; ++i) {
+        size_t s = pick(rng);
+        packets.emplace_back("10." + std::to_string((s >> 16) & 0xFF) + "." +
+                                 std::to_string((s >> 8) & 0xFF) + "." +
+                                 std::to_string(s & 0xFF),
+                             "10.200.0.1", 5000, 80, Protocol::TCP, 512, 5.0,
+                             fromNanos(1'700'000'000'000'000'000LL +
+                                       static_cast<int64_t>(i) * 1000));
+    }
+    return packets;
+}
+
+double packetsPerSecond(const std::vector<Packet>& packets, size_t workers) {
+    DetectorConfig detector_config;
+    detector_config.flood_threshold = UINT32_MAX;
+    detector_config.shard_count     = static_cast<uint32_t>(workers);
+
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+
+    MonitorConfig config;
+    config.workers = workers;
+
+    auto detector = std::make_shared<AnomalyDetector>(detector_config);
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", alert_config);
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    auto start = std::chrono::steady_clock::now();
+    monitor.start();
+    std::vector<std::thread> producers;
+    for (size_t t = 0; t < workers; ++t) {
+        producers.emplace_back([&, t] {
+            for (size_t i = t; i < packets.size(); i += workers) {
+                monitor.feedPacket(packets[i]);
+            }
+        });
+    }
+    for (auto& p : producers) p.join();
+    monitor.stop();
+    double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(monitor.stats().processed) / secs;
+}
+
+// Producer cost alone: workers are not started, the queue holds everything
+template <typename Feed>
+double producerNsPerPacket(const std::vector<Packet>& packets, Feed&& feed) {
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+    MonitorConfig config;
+    config.queue_capacity = packets.size();
+    config.overflow       = QueueOverflowPolicy::DROP_NEWEST;
+
+    auto detector = std::make_shared<AnomalyDetector>();
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", alert_config);
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    std::vector<Packet> input = packets;  // copied outside the timed region
+    auto start = std::chrono::steady_clock::now();
+    feed(monitor, input);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(packets.size());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t max_workers = argc > 1 ? std::strtoul(argv[1], nullptr, 10)
+                                  : std::thread::hardware_concurrency();
+    if (max_workers == 0) max_workers = 1;
+
+    auto packets = makeTraffic(100'000);
+    std::printf("%8s %16s %10s\n", "workers", "packets/s", "speedup");
+
+    double base = 0;
+    for (size_t workers = 1; workers <= max_workers; workers *= 2) {
+        double pps = packetsPerSecond(packets, workers);
+        if (workers == 1) base = pps;
+        std::printf("%8zu %16.0f %9.2fx\n", workers, pps, pps / base);
+    }
+
+    std::vector<Packet> ingest(packets.begin(), packets.begin() + 1'000'000);
+    std::printf("\n%-28s %12s\n", "ingest path", "ns/packet");
+    std::printf("%-28s %12.1f\n", "feedPacket(const Packet&)",
+                producerNsPerPacket(ingest, [](NetworkMonitor& m, std::vector<Packet>& in) {
+                    for (const auto& p : in) m.feedPacket(p);
+                }));
+    std::printf("%-28s %12.1f\n", "feedPacket(Packet&&)",
+                producerNsPerPacket(ingest, [](NetworkMonitor& m, std::vector<Packet>& in) {
+                    for (auto& p : in) m.feedPacket(std::move(p));
+                }));
+    std::printf("%-28s %12.1f\n", "feedBatch(1024)",
+                producerNsPerPacket(ingest, [](NetworkMonitor& m, std::vector<Packet>& in) {
+                    for (size_t i = 0; i < in.size(); i += 1024) {
+                        m.feedBatch(in.data() + i, std::min<size_t>(1024, in.size() - i));
+                    }
+                }));
+    return 0;
+}
@@ -0,0 +1,721 @@
+// Benchmark suite: per-call cost of the hot entry points plus end-to-end
+// NetworkMonitor throughput and latency, as a table and optionally as JSON
+// for benchmarks/compare.py. generator measures one TrafficGenerator stream
+// of several.
+//
+//   bench_suite [--json PATH] [--filter SUBSTR] [--quick]
+//
+// Micro results are the median of several repetitions. Latency runs feed
+// a fixed rate well below capacity and time each packet from feedBatch to
+// the end of its analyzed batch (NetworkMonitor::onBatch). On Linux the
+// ingest benchmark sends records through IngestServer over a Unix socket;
+// file_ingest reads a binary trace through FileIngest with each backend;
+// ring pushes records through the shared-memory PacketRing; rollups
+// times TrafficRollups::observe and RollupReader queries. The allocs
+// results count global operator new calls, which this binary replaces.
+
+#include "AlertManager.h"
+#include "AnomalyDetector.h"
+#include "JsonUtil.h"
+#include "Metrics.h"
+#include "NetworkMonitor.h"
+#include "PacketProcessor.h"
+#include "Rollups.h"
+#include "TrafficGenerator.h"
+#ifdef __unix__
+#include "FileIngest.h"
+#include "PacketRing.h"
+#include "TraceFile.h"
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include "IngestServer.h"
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace anomaly;
+
+static std::atomic<uint64_t> g_allocations{0};
+
+// Array and nothrow forms of global new forward to these two; the
+// aligned one is what std::pmr::new_delete_resource() calls
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t size, std::align_val_t align) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Result {
+    std::string name;
+    double value;
+    const char* unit;
+    bool higher_is_better;
+    double tolerance;  // relative change compare.py accepts as noise
+};
+
+std::vector<Result> results;
+std::string filter;
+bool quick = false;
+
+bool selected(const std::string& name) {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void report(std::string name, double value, const char* unit,
+            bool higher_is_better = false, double tolerance = 0.20) {
+    std::printf("%-40s %14.1f %s\n", name.c_str(), value, unit);
+    std::fflush(stdout);
+    results.push_back({std::move(name), value, unit, higher_is_better, tolerance});
+}
+
+// Keep the compiler from discarding a computed value
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Median over reps of the ns per op of body(), which performs `ops` ops
+template <typename Body>
+double medianNsPerOp(size_t ops, Body&& body, int reps = 5) {
+    std::vector<double> samples;
+    for (int r = 0; r < (quick ? 2 : reps); ++r) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() /
+                          static_cast<double>(ops));
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+// Global allocations per op of one run of body(), which performs `ops` ops
+template <typename Body>
+double allocsPerOp(size_t ops, Body&& body) {
+    uint64_t before = g_allocations.load();
+    body();
+    return static_cast<double>(g_allocations.load() - before) / static_cast<double>(ops);
+}
+
+std::string sourceAddr(size_t s) {
+    return "10." + std::to_string((s >> 16) & 0xFF) + "." +
+           std::to_string((s >> 8) & 0xFF) + "." + std::to_string(s & 0xFF);
+}
+
+std::vector<Packet> makeTraffic(size_t count, size_t cardinality) {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, cardinality - 1);
+    std::vector<Packet> packets;
+    packets.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        packets.emplace_back(sourceAddr(pick(rng)), "10.200.0.1", 5000, 443,
+                             Protocol::TCP, 512, 5.0,
+                             fromNanos(1'700'000'000'000'000'000LL +
+                                       static_cast<int64_t>(i) * 1000));
+    }
+    return packets;
+}
+
+DetectorConfig quietDetector(uint32_t shards = 1) {
+    DetectorConfig config;
+    config.flood_threshold = UINT32_MAX;
+    config.shard_count     = shards;
+    return config;
+}
+
+AlertManagerConfig quietAlerts() {
+    AlertManagerConfig config;
+    config.log.console = false;
+    return config;
+}
+
+void benchProcessor() {
+    PacketProcessor processor;
+    std::vector<std::string> raw;
+    std::vector<std::string> ips;
+    for (size_t i = 0; i < 1024; ++i) {
+        ips.push_back(sourceAddr(i * 7919));
+        raw.push_back(ips.back() + ":" + std::to_string(1024 + i) +
+                      "->10.0.0.1:443|" + std::to_string(64 + i) + "|12.5");
+    }
+    const size_t ops = quick ? 50'000 : 200'000;
+
+    if (selected("processor/parsePacket")) {
+        report("processor/parsePacket", medianNsPerOp(ops, [&] {
+            for (size_t i = 0; i < ops; ++i) keep(processor.parsePacket(raw[i & 1023]));
+        }), "ns/op");
+    }
+    if (selected("processor/parseInto")) {
+        Packet pkt;
+        report("processor/parseInto", medianNsPerOp(ops, [&] {
+            for (size_t i = 0; i < ops; ++i) keep(processor.parseInto(raw[i & 1023], pkt));
+        }), "ns/op");
+    }
+    if (selected("processor/isValidIP")) {
+        report("processor/isValidIP", medianNsPerOp(ops, [&] {
+            for (size_t i = 0; i < ops; ++i) keep(processor.isValidIP(ips[i & 1023]));
+        }), "ns/op");
+    }
+    if (selected("processor/detectProtocol")) {
+        const size_t n = ops * 50;
+        report("processor/detectProtocol", medianNsPerOp(n, [&] {
+            for (size_t i = 0; i < n; ++i) {
+                keep(processor.detectProtocol(static_cast<uint16_t>(i * 2654435761u)));
+            }
+        }), "ns/op");
+    }
+    if (selected("processor/processBatch")) {
+        report("processor/processBatch/allocs", allocsPerOp(raw.size(), [&] {
+            keep(processor.processBatch(raw));
+        }), "allocs/packet", false, 0.05);
+    }
+}
+
+void benchDetector() {
+    const size_t count = quick ? 200'000 : 1'000'000;
+    for (size_t cardinality : {1'000u, 100'000u, 1'000'000u}) {
+        std::string suffix = "/sources=" + std::to_string(cardinality);
+        if (!selected("detector/analyze" + suffix) &&
+            !selected("detector/analyzeBatch" + suffix)) {
+            continue;
+        }
+        auto packets = makeTraffic(count, cardinality);
+
+        // A fresh detector per repetition, so first sightings are included
+        if (selected("detector/analyze" + suffix)) {
+            report("detector/analyze" + suffix, medianNsPerOp(count, [&] {
+                AnomalyDetector detector(quietDetector());
+                for (const auto& p : packets) keep(detector.analyze(p));
+            }, 3), "ns/op");
+        }
+        if (selected("detector/analyzeBatch" + suffix)) {
+            std::vector<std::vector<Packet>> batches;
+            for (size_t i = 0; i < packets.size(); i += 256) {
+                batches.emplace_back(packets.begin() + i,
+                                     packets.begin() + std::min(packets.size(), i + 256));
+            }
+            std::vector<AnomalyReport> out;
+            report("detector/analyzeBatch" + suffix, medianNsPerOp(count, [&] {
+                AnomalyDetector detector(quietDetector());
+                for (const auto& b : batches) {
+                    out.clear();
+                    detector.analyzeBatch(b, out);
+                }
+            }, 3), "ns/op");
+        }
+    }
+
+    // Every 4th packet over the latency threshold, so each 256-packet batch
+    // yields 64 reports
+    if (selected("detector/reports")) {
+        auto packets = makeTraffic(quick ? 64 * 256 : 512 * 256, 1'000);
+        for (size_t i = 0; i < packets.size(); i += 4) packets[i].latency_ms = 250.0;
+        const size_t batches = packets.size() / 256;
+        AnomalyDetector detector(quietDetector());
+        std::vector<AnomalyReport> out;
+        auto run = [&] {
+            for (size_t i = 0; i < packets.size(); i += 256) {
+                out.clear();
+                detector.analyzeBatch(packets.data() + i, 256, out);
+            }
+        };
+        run();  // sources interned, out at capacity
+        report("detector/reports/heap", medianNsPerOp(packets.size(), run), "ns/op");
+        report("detector/reports/heap_allocs", allocsPerOp(batches, run),
+               "allocs/batch", false, 0.05);
+
+        // As NetworkMonitor's workers do: a per-batch arena, released after each batch
+        std::vector<std::byte> buffer(64 * 1024);
+        std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+        auto run_arena = [&] {
+            for (size_t i = 0; i < packets.size(); i += 256) {
+                {
+                    std::pmr::vector<AnomalyReport> reports(&arena);
+                    detector.analyzeBatch(packets.data() + i, 256, reports);
+                }
+                arena.release();
+            }
+        };
+        report("detector/reports/arena", medianNsPerOp(packets.size(), run_arena), "ns/op");
+        report("detector/reports/arena_allocs", allocsPerOp(batches, run_arena),
+               "allocs/batch", false, 0.05);
+    }
+}
+
+void benchAlerts() {
+    const size_t count = quick ? 20'000 : 100'000;
+    std::vector<AnomalyReport> reports(count);
+    for (size_t i = 0; i < count; ++i) {
+        reports[i].type        = AnomalyType::HIGH_LATENCY;
+        reports[i].source_ip   = sourceAddr(i % 5000);
+        reports[i].description = "High latency detected: 250.000000 ms (threshold: 100.000000 ms)";
+        reports[i].severity    = 0.5 + static_cast<double>(i % 50) / 100.0;
+        reports[i].detected_at = fromNanos(1'700'000'000'000'000'000LL +
+                                           static_cast<int64_t>(i) * 1'000'000);
+    }
+
+    if (selected("alerts/raise")) {
+        report("alerts/raise", medianNsPerOp(count, [&] {
+            AlertManager alerts("/dev/null", quietAlerts());
+            for (const auto& r : reports) alerts.raise(r);
+        }, 3), "ns/op");
+    }
+    if (selected("alerts/raiseBatch/allocs")) {
+        AlertManager alerts("/dev/null", quietAlerts());
+        report("alerts/raiseBatch/allocs", allocsPerOp(count, [&] {
+            alerts.raiseBatch(reports);
+        }), "allocs/alert", false, 0.05);
+    }
+    if (selected("alerts/exportToJSON")) {
+        AlertManager alerts("/dev/null", quietAlerts());
+        alerts.raiseBatch(reports);
+        const std::string path = "bench_suite_export.json";
+        report("alerts/exportToJSON", medianNsPerOp(count, [&] {
+            alerts.exportToJSON(path);
+        }, 3), "ns/alert");
+        std::filesystem::remove(path);
+    }
+}
+
+// Packets/s from one of `count` generator streams. Each stream enumerates
+// only its own packets, so this should not fall as count grows.
+void benchGenerator() {
+    TrafficConfig config;
+    config.sources = 100'000;
+    const double own = quick ? 200'000 : 1'000'000;  // packets per measured stream
+    for (size_t count : {size_t{1}, size_t{8}, size_t{64}}) {
+        std::string name = "generator/stream/count=" + std::to_string(count);
+        if (!selected(name)) continue;
+        TrafficGenerator generator(config);
+        double duration = own * static_cast<double>(count) / config.packets_per_sec;
+        std::vector<Packet> out;
+        out.reserve(4096);
+        size_t produced = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto stream = generator.stream(0, count, duration);
+        for (;;) {
+            out.clear();
+            size_t n = stream.next(out, 4096);
+            if (n == 0) break;
+            produced += n;
+        }
+        double secs = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        report(name, static_cast<double>(produced) / secs, "packets/s", true);
+    }
+}
+
+double monitorThroughput(const std::vector<Packet>& packets, size_t workers) {
+    MonitorConfig config;
+    config.workers = workers;
+    auto detector = std::make_shared<AnomalyDetector>(
+        quietDetector(static_cast<uint32_t>(workers)));
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    std::vector<Packet> input = packets;
+    auto start = std::chrono::steady_clock::now();
+    monitor.start();
+    std::vector<std::thread> producers;
+    size_t per = (input.size() + workers - 1) / workers;
+    for (size_t t = 0; t < workers; ++t) {
+        producers.emplace_back([&, t] {
+            size_t end = std::min(input.size(), (t + 1) * per);
+            for (size_t i = t * per; i < end; i += 1024) {
+                monitor.feedBatch(input.data() + i, std::min<size_t>(1024, end - i));
+            }
+        });
+    }
+    for (auto& p : producers) p.join();
+    monitor.stop();
+    double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(monitor.stats().processed) / secs;
+}
+
+// Global allocations per worker batch through a 1-worker monitor, fed in
+// 1024-packet chunks; includes the alerts raised for the reports
+double monitorAllocations(const std::vector<Packet>& packets) {
+    auto detector = std::make_shared<AnomalyDetector>(quietDetector());
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts);
+    std::vector<Packet> input = packets;
+    monitor.start();
+    double allocs = allocsPerOp(1, [&] {
+        for (size_t i = 0; i < input.size(); i += 1024) {
+            monitor.feedBatch(input.data() + i, std::min<size_t>(1024, input.size() - i));
+        }
+        monitor.stop();
+    });
+    return allocs / static_cast<double>(std::max<uint64_t>(1, monitor.stats().batches));
+}
+
+// Feed `rate` packets/s in 1 ms ticks for `seconds`; returns sorted
+// enqueue-to-analyzed latencies in microseconds
+std::vector<double> monitorLatencies(const std::vector<Packet>& packets,
+                                     double rate, double seconds) {
+    auto detector = std::make_shared<AnomalyDetector>(quietDetector());
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts);
+
+    std::mutex mtx;
+    std::vector<double> latencies;
+    monitor.onBatch([&](const std::vector<Packet>& batch) {
+        int64_t now = metrics::nowNs();
+        std::lock_guard<std::mutex> lock(mtx);
+        for (const auto& p : batch) {
+            latencies.push_back(static_cast<double>(now - p.ingest_ns) / 1e3);
+        }
+    });
+    monitor.start();
+
+    const size_t per_tick = std::max<size_t>(1, static_cast<size_t>(rate / 1000));
+    const size_t ticks    = static_cast<size_t>(seconds * 1000);
+    std::vector<Packet> tick;
+    auto next = std::chrono::steady_clock::now();
+    for (size_t t = 0, i = 0; t < ticks; ++t) {
+        std::this_thread::sleep_until(next);
+        next += std::chrono::milliseconds(1);
+        tick.clear();
+        int64_t now = metrics::nowNs();
+        for (size_t k = 0; k < per_tick; ++k, ++i) {
+            tick.push_back(packets[i % packets.size()]);
+            tick.back().ingest_ns = now;  // restamped by feedBatch when metrics are on
+        }
+        monitor.feedBatch(tick.data(), tick.size());
+    }
+    monitor.stop();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+double percentile(const std::vector<double>& sorted, double q) {
+    if (sorted.empty()) return 0.0;
+    return sorted[static_cast<size_t>(q * static_cast<double>(sorted.size() - 1))];
+}
+
+void benchMonitor() {
+    auto packets = makeTraffic(quick ? 500'000 : 2'000'000, 100'000);
+    size_t hw = std::max(1u, std::thread::hardware_concurrency());
+
+    for (size_t workers : {size_t{1}, hw}) {
+        std::string name = "monitor/throughput/workers=" + std::to_string(workers);
+        if (selected(name)) {
+            report(name, monitorThroughput(packets, workers), "packets/s", true);
+        }
+        if (hw == 1) break;
+    }
+    if (selected("monitor/allocs")) {
+        // One report per 64 packets
+        std::vector<Packet> mixed(packets.begin(), packets.begin() + (quick ? 100'000 : 500'000));
+        for (size_t i = 0; i < mixed.size(); i += 64) mixed[i].latency_ms = 250.0;
+        report("monitor/allocs_per_batch", monitorAllocations(mixed), "allocs/batch", false, 0.10);
+    }
+    if (selected("monitor/latency")) {
+        auto lat = monitorLatencies(packets, 100'000, quick ? 0.5 : 2.0);
+        report("monitor/latency/p50@100kpps", percentile(lat, 0.50), "us", false, 0.5);
+        report("monitor/latency/p99@100kpps", percentile(lat, 0.99), "us", false, 0.5);
+    }
+}
+
+#ifdef __linux__
+// Records/s through IngestServer into a 1-worker monitor over a Unix
+// datagram socket, 16 records per datagram. Unix datagram sends block on a
+// full receive queue, so this measures receive capacity without loss.
+double ingestThroughput(const std::vector<Packet>& packets) {
+    auto detector = std::make_shared<AnomalyDetector>(quietDetector());
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts);
+    IngestConfig config;
+    config.unix_path = "bench_ingest.sock";
+    auto server = IngestServer::create(monitor, config);
+    if (!server) return 0.0;
+
+    PacketProcessor processor;
+    std::vector<std::string> datagrams;
+    for (size_t i = 0; i < packets.size(); i += 16) {
+        std::string d;
+        for (size_t k = i; k < std::min(packets.size(), i + 16); ++k) {
+            d += processor.formatPacket(packets[k]);
+            d += '\n';
+        }
+        datagrams.push_back(std::move(d));
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, config.unix_path.c_str());
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        return 0.0;
+    }
+
+    monitor.start();
+    server->start();
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& d : datagrams) {
+        if (::send(fd, d.data(), d.size(), 0) < 0) break;
+    }
+    while (server->stats().datagrams < datagrams.size()) std::this_thread::yield();
+    server->stop();
+    monitor.stop();
+    double secs = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    ::close(fd);
+    return static_cast<double>(monitor.stats().processed) / secs;
+}
+#endif
+
+void benchIngest() {
+#ifdef __linux__
+    if (selected("ingest/unix/throughput")) {
+        auto packets = makeTraffic(quick ? 200'000 : 1'000'000, 100'000);
+        report("ingest/unix/throughput", ingestThroughput(packets), "records/s", true);
+    }
+#endif
+}
+
+#ifdef __unix__
+// MB/s of binary trace read, parsed and analyzed by a 1-worker monitor.
+// The file is freshly written, so this measures the page-cache path.
+double fileIngestThroughput(const std::string& path, bool io_uring) {
+    auto detector = std::make_shared<AnomalyDetector>(quietDetector());
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts);
+    FileIngestConfig config;
+    config.use_io_uring = io_uring;
+    FileIngest ingest(config);
+    if (io_uring && std::strcmp(ingest.backend(), "io_uring") != 0) return 0.0;
+    monitor.start();
+    FileIngestStats stats = ingest.run({path}, monitor);
+    monitor.stop();
+    return stats.mb_per_sec;
+}
+#endif
+
+void benchFileIngest() {
+#ifdef __unix__
+    if (!selected("file_ingest")) return;
+    const std::string path = "bench_file_ingest.bin";
+    {
+        TraceWriter writer(path);
+        auto packets = makeTraffic(quick ? 200'000 : 1'000'000, 100'000);
+        writer.write(packets);
+    }
+    for (bool io_uring : {true, false}) {
+        std::string name = std::string("file_ingest/") + (io_uring ? "io_uring" : "pread");
+        if (!selected(name)) continue;
+        double mbps = fileIngestThroughput(path, io_uring);
+        if (mbps > 0.0) report(name, mbps, "MB/s", true);
+    }
+    std::filesystem::remove(path);
+#endif
+}
+
+#ifdef __unix__
+// Records/s pushed through a PacketRing by this thread and drained into a
+// 1-worker monitor by PacketRingIngest
+double ringThroughput(const std::vector<Packet>& packets) {
+    std::vector<trace::PacketRecord> records(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) trace::encodeRecord(packets[i], records[i]);
+
+    const std::string name = "/5g-bench-ring-" + std::to_string(::getpid());
+    auto consumer = PacketRingConsumer::create(name);
+    auto producer = consumer ? PacketRingProducer::open(name) : nullptr;
+    if (!producer) return 0.0;
+
+    auto detector = std::make_shared<AnomalyDetector>(quietDetector());
+    auto alerts   = std::make_shared<AlertManager>("/dev/null", quietAlerts());
+    NetworkMonitor monitor(detector, alerts);
+    PacketRingIngest ingest(std::move(consumer), monitor);
+    monitor.start();
+    ingest.start();
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t sent = 0; sent < records.size();) {
+        size_t n = producer->tryPush(records.data() + sent,
+                                     std::min<size_t>(256, records.size() - sent));
+        if (n == 0) std::this_thread::yield();
+        sent += n;
+    }
+    ingest.stop();
+    monitor.stop();
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(monitor.stats().processed) / secs;
+}
+#endif
+
+void benchRing() {
+#ifdef __unix__
+    if (selected("ring/throughput")) {
+        auto packets = makeTraffic(quick ? 200'000 : 1'000'000, 100'000);
+        report("ring/throughput", ringThroughput(packets), "records/s", true);
+    }
+#endif
+}
+
+void benchRollups() {
+    const std::string path = "bench_rollups.bin";
+    auto removeFiles = [&] {
+        std::remove(path.c_str());
+        std::remove((path + ".idx").c_str());
+    };
+    if (selected("rollups/observe")) {
+        auto packets = makeTraffic(quick ? 100'000 : 1'000'000, 100'000);
+        std::vector<std::vector<Packet>> batches;
+        for (size_t i = 0; i < packets.size(); i += 256) {
+            batches.emplace_back(packets.begin() + i,
+                                 packets.begin() + std::min(packets.size(), i + 256));
+        }
+        report("rollups/observe", medianNsPerOp(packets.size(), [&] {
+            removeFiles();
+            TrafficRollups rollups(path);
+            for (const auto& batch : batches) rollups.observe(batch);
+        }), "ns/packet");
+
+        // Same batches from four threads at once, as a 4-worker monitor
+        // would call it; wall time per packet
+        const size_t threads = 4;
+        report("rollups/observe/threads=4", medianNsPerOp(packets.size(), [&] {
+            removeFiles();
+            TrafficRollups rollups(path);
+            std::vector<std::thread> pool;
+            for (size_t t = 0; t < threads; ++t) {
+                pool.emplace_back([&, t] {
+                    for (size_t b = t; b < batches.size(); b += threads) {
+                        rollups.observe(batches[b]);
+                    }
+                });
+            }
+            for (auto& th : pool) th.join();
+        }), "ns/packet");
+    }
+    if (selected("rollups/series")) {
+        // 10 minutes of 2000 keys, written directly
+        const int64_t seconds = 600;
+        const uint32_t keys   = 2000;
+        removeFiles();
+        {
+            RollupWriter writer(path, RollupKey::DST_PORT, 60);
+            std::vector<rollup::Record> rows(keys + 1);
+            for (int64_t s = 0; s < seconds; ++s) {
+                for (uint32_t k = 0; k <= keys; ++k) {
+                    rows[k] = rollup::Record{};
+                    rows[k].second  = 1'700'000'000 + s;
+                    rows[k].key     = k == 0 ? 0 : k - 1;
+                    rows[k].kind    = static_cast<uint8_t>(k == 0 ? RollupKey::NONE
+                                                                  : RollupKey::DST_PORT);
+                    rows[k].packets = 1;
+                }
+                writer.append(rows.data(), rows.size());
+            }
+        }
+        auto reader = RollupReader::open(path);
+        const size_t queries = quick ? 20 : 100;
+        report("rollups/series/600s_2000keys", medianNsPerOp(queries, [&] {
+            for (size_t q = 0; q < queries; ++q) {
+                keep(reader->series(1'700'000'000, 1'700'000'000 + seconds - 1,
+                                    RollupKey::DST_PORT, static_cast<uint32_t>(q * 17 % keys)));
+            }
+        }) / 1000.0, "us/query");
+    }
+    removeFiles();
+}
+
+bool writeJson(const std::string& path) {
+    std::string out = "{\n  \"context\": {\"date\": ";
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    appendJsonString(out, date);
+    out += ", \"hardware_threads\": ";
+    appendJsonNumber(out, static_cast<uint64_t>(std::thread::hardware_concurrency()));
+    out += ", \"metrics\": ";
+    out += metrics::kEnabled ? "true" : "false";
+    out += ", \"quick\": ";
+    out += quick ? "true" : "false";
+    out += "},\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out += "    {\"name\": ";
+        appendJsonString(out, r.name);
+        out += ", \"value\": ";
+        appendJsonNumber(out, r.value);
+        out += ", \"unit\": ";
+        appendJsonString(out, r.unit);
+        out += ", \"higher_is_better\": ";
+        out += r.higher_is_better ? "true" : "false";
+        out += ", \"tolerance\": ";
+        appendJsonNumber(out, r.tolerance);
+        out += i + 1 < results.size() ? "},\n" : "}\n";
+    }
+    out += "  ]\n}\n";
+
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string json_path;
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--quick")) {
+            quick = true;
+        } else if (!std::strcmp(argv[i], "--json") && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: %s [--json PATH] [--filter SUBSTR] [--quick]\n",
+                         argv[0]);
+            return 1;
+        }
+    }
+
+    benchProcessor();
+    benchDetector();
+    benchAlerts();
+    benchGenerator();
+    benchMonitor();
+    benchIngest();
+    benchFileIngest();
+    benchRing();
+    benchRollups();
+
+    if (!json_path.empty() && !writeJson(json_path)) {
+        std::fprintf(stderr, "cannot write %s\n", json_path.c_str());
+        return 1;
+    }
+    return 0;
+}
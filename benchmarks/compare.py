@@ -0,0 +1,125 @@
+"""
+Compare two bench_suite JSON results and flag regressions.
+
+    python benchmarks/compare.py benchmarks/baseline.json build/bench.json
+
+A benchmark regresses when it moves the wrong way by more than its
+tolerance (recorded per benchmark by bench_suite, or --threshold to
+override). Exits 1 if anything regressed, so CI can gate on it.
+A zero baseline (e.g. an allocation count) is gated on the absolute
+difference instead: for lower-is-better benchmarks any increase regresses.
+Benchmarks the baseline does not have are listed as new; re-record the
+baseline to gate them. Baseline benchmarks missing from the current run
+also fail the comparison unless --allow-missing is given (filtered runs). Runs recorded with different settings (--quick,
+metrics, hardware threads) are not comparable and exit 2 unless
+--ignore-context is given.
+"""
+
+import argparse
+import json
+import sys
+from typing import Optional
+
+
+# Context keys that change what the numbers mean
+CONTEXT_KEYS = ("quick", "metrics", "hardware_threads")
+
+
+def load(path: str) -> tuple[dict, dict[str, dict]]:
+    with open(path, "r") as f:
+        data = json.load(f)
+    return data.get("context", {}), {b["name"]: b for b in data["benchmarks"]}
+
+
+def context_mismatches(baseline: dict, current: dict) -> list[str]:
+    """Context keys whose values differ, as "key: baseline -> current"."""
+    return [f"{key}: {baseline.get(key)} -> {current.get(key)}"
+            for key in CONTEXT_KEYS if baseline.get(key) != current.get(key)]
+
+
+def unmatched(baseline: dict[str, dict], current: dict[str, dict]) -> list[str]:
+    """Benchmarks in the current run that the baseline cannot gate."""
+    return sorted(name for name in current if name not in baseline)
+
+
+def compare(baseline: dict[str, dict], current: dict[str, dict],
+            threshold: Optional[float] = None) -> list[dict]:
+    """One row per benchmark present in both runs."""
+    rows = []
+    for name, cur in current.items():
+        base = baseline.get(name)
+        if base is None:
+            continue
+        tolerance = threshold if threshold is not None else cur.get("tolerance", 0.20)
+        if base["value"] == 0:
+            # No relative change from zero: compare absolute values, and
+            # let nothing above zero through when lower is better
+            change = None
+            diff = cur["value"] - base["value"]
+            worse = -diff if cur.get("higher_is_better") else diff
+            regressed = worse > (tolerance if cur.get("higher_is_better") else 0)
+            improved = worse < -tolerance
+        else:
+            change = cur["value"] / base["value"] - 1.0
+            # Positive `worse` means the benchmark got slower / lower throughput
+            worse = -change if cur.get("higher_is_better") else change
+            regressed = worse > tolerance
+            improved = worse < -tolerance
+        rows.append({
+            "name": name,
+            "unit": cur["unit"],
+            "baseline": base["value"],
+            "current": cur["value"],
+            "change": change,
+            "regressed": regressed,
+            "improved": improved,
+        })
+    return rows
+
+
+def print_table(rows: list[dict]) -> None:
+    print(f"{'benchmark':<40} {'baseline':>12} {'current':>12} {'change':>8}")
+    for r in rows:
+        flag = "  REGRESSION" if r["regressed"] else "  improved" if r["improved"] else ""
+        change = "n/a" if r["change"] is None else f"{100 * r['change']:+.1f}%"
+        print(f"{r['name']:<40} {r['baseline']:>12.1f} {r['current']:>12.1f} "
+              f"{change:>8}{flag}")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("baseline", help="stored bench_suite JSON")
+    parser.add_argument("current", help="fresh bench_suite JSON")
+    parser.add_argument("--threshold", type=float, default=None,
+                        help="relative tolerance for every benchmark (e.g. 0.1)")
+    parser.add_argument("--allow-missing", action="store_true",
+                        help="do not fail when baseline benchmarks are absent (--filter runs)")
+    parser.add_argument("--ignore-context", action="store_true",
+                        help="compare even if --quick, metrics or thread count differ")
+    args = parser.parse_args()
+
+    base_context, baseline = load(args.baseline)
+    cur_context, current = load(args.current)
+    mismatches = context_mismatches(base_context, cur_context)
+    if mismatches and not args.ignore_context:
+        print(f"runs are not comparable ({'; '.join(mismatches)}); "
+              "re-record the baseline or pass --ignore-context")
+        sys.exit(2)
+
+    rows = compare(baseline, current, args.threshold)
+    print_table(rows)
+
+    new = unmatched(baseline, current)
+    if new:
+        print(f"\nnew, no baseline: {', '.join(new)}")
+    missing = sorted(set(baseline) - set(current))
+    if missing:
+        print(f"\nnot in current run: {', '.join(missing)}")
+
+    regressions = [r["name"] for r in rows if r["regressed"]]
+    if regressions:
+        print(f"\n{len(regressions)} regression(s): {', '.join(regressions)}")
+    if regressions or (missing and not args.allow_missing):
+        sys.exit(1)
+    print("\nno regressions")
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace anomaly {
+
+// Thread placement through the standard Linux affinity and memory-policy
+// syscalls. Everything degrades to a no-op (returning false / -1) on other
+// platforms or when the kernel refuses.
+
+// Restrict the calling thread to one CPU
+bool pinCurrentThread(int cpu);
+
+// CPU the calling thread is running on, or -1
+int currentCpu();
+
+// NUMA node owning a CPU (0 on non-NUMA machines), or -1 if the CPU is unknown
+int numaNodeOfCpu(int cpu);
+
+// Prefer the given node for the calling thread's future page allocations
+// (set_mempolicy MPOL_PREFERRED; falls back to other nodes when full)
+bool preferNumaNode(int node);
+
+// Pin to cpu and prefer its node; what a placed thread calls first
+bool placeCurrentThread(int cpu);
+
+struct NumaNode {
+    int id{0};
+    std::vector<int> cpus;
+};
+
+// Nodes and their CPUs from /sys; one node holding every online CPU when
+// the machine exposes no NUMA information
+std::vector<NumaNode> numaTopology();
+
+// One-line summary, e.g. "2 NUMA node(s): node0 cpus 0-15, node1 cpus 16-31"
+std::string describeTopology();
+
+} // namespace anomaly
@@ -0,0 +1,28 @@
+#pragma once
+#include "Packet.h"
+#include <string>
+#include <cstdint>
+
+namespace anomaly {
+
+enum class AlertLevel { LOW, MEDIUM, HIGH, CRITICAL };
+
+inline const char* alertLevelName(AlertLevel level) {
+    switch (level) {
+        case AlertLevel::CRITICAL: return "CRITICAL";
+        case AlertLevel::HIGH:     return "HIGH";
+        case AlertLevel::MEDIUM:   return "MEDIUM";
+        case AlertLevel::LOW:      return "LOW";
+        default:                   return "UNKNOWN";
+    }
+}
+
+struct Alert {
+    AlertLevel level;
+    std::string message;
+    AnomalyReport report;
+    std::string timestamp_str;
+    uint64_t sequence{0};  // position in the AlertManager's raise order
+};
+
+} // namespace anomaly
@@ -0,0 +1,124 @@
+#pragma once
+#include "Alert.h"
+#include <array>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace anomaly {
+
+// Running mean/variance/min/max (Welford)
+struct SeverityMoments {
+    uint64_t count{0};
+    double mean{0.0};
+    double m2{0.0};
+    double min{0.0};
+    double max{0.0};
+
+    void add(double x);
+    double variance() const { return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0; }
+};
+
+struct Offender {
+    std::string source_ip;
+    uint64_t count{0};
+    uint64_t error{0};  // upper bound on over-counting (Space-Saving)
+};
+
+// Bounded heavy-hitters sketch (Space-Saving): tracks at most `capacity`
+// sources and reports the top-K by count with a bounded error instead of
+// keeping a counter per distinct source. Counters sit in a stream summary,
+// a list of count buckets in ascending order, so an update (increment, or
+// replacing the minimum) is one hash lookup plus O(1) list moves, and
+// top(k) walks k counters from the largest bucket down.
+class TopOffenders {
+public:
+    explicit TopOffenders(size_t capacity = 64);
+
+    void add(const std::string& source_ip);
+    std::vector<Offender> top(size_t k) const;
+    void clear();
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    // Counters and buckets live in fixed pools and link by index
+    struct Counter {
+        std::string source_ip;
+        uint64_t error{0};
+        uint32_t bucket{kNone};
+        uint32_t prev{kNone}, next{kNone};  // within the bucket
+    };
+    struct Bucket {
+        uint64_t count{0};
+        uint32_t prev{kNone}, next{kNone};  // ascending by count
+        uint32_t head{kNone};               // first counter
+    };
+    size_t capacity_;
+    std::vector<Counter> counters_;
+    std::vector<Bucket> buckets_;
+    std::vector<uint32_t> free_buckets_;
+    uint32_t min_bucket_{kNone};
+    uint32_t max_bucket_{kNone};
+    std::unordered_map<std::string, uint32_t> index_;  // source -> counter
+
+    void increment(uint32_t c);
+    uint32_t newBucket(uint64_t count, uint32_t after);  // after == kNone: at the front
+    void attach(uint32_t c, uint32_t b);
+    void detach(uint32_t c);  // frees the bucket when it empties
+};
+
+struct AggregateSnapshot {
+    uint64_t total{0};
+    std::array<uint64_t, 4> by_level{};  // indexed by AlertLevel
+    std::array<uint64_t, 5> by_type{};   // indexed by AnomalyType
+    SeverityMoments severity;
+    std::vector<Offender> top_offenders;
+    TimePoint window_start{};            // zero for lifetime snapshots
+};
+
+struct AggregateConfig {
+    uint32_t window_sec{60};   // tumbling window (event time) for live stats
+    size_t top_k{5};
+    size_t top_capacity{64};   // counters in the top-offender sketch
+};
+
+// Summaries maintained in O(1) per alert, both over the lifetime of the
+// manager and over the current event-time window, so dashboards never have
+// to rescan raw alerts. Not thread-safe; AlertManager serialises access.
+class AlertAggregates {
+public:
+    explicit AlertAggregates(AggregateConfig config = AggregateConfig{});
+
+    void add(const Alert& alert);
+
+    AggregateSnapshot lifetime() const;
+    AggregateSnapshot window() const;
+    void clear();
+
+    // Write both snapshots as a small JSON document
+    bool writeSummary(const std::string& filepath) const;
+
+private:
+    struct Totals {
+        uint64_t total{0};
+        std::array<uint64_t, 4> by_level{};
+        std::array<uint64_t, 5> by_type{};
+        SeverityMoments severity;
+        TopOffenders offenders;
+
+        explicit Totals(size_t capacity) : offenders(capacity) {}
+        void add(const Alert& alert);
+        void clear();
+        AggregateSnapshot snapshot(size_t top_k) const;
+    };
+
+    AggregateConfig config_;
+    Totals lifetime_;
+    Totals window_;
+    int64_t window_index_{INT64_MIN};
+
+    int64_t windowOf(TimePoint t) const;
+};
+
+} // namespace anomaly
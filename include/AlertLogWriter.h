@@ -0,0 +1,94 @@
+#pragma once
+#include "Clock.h"
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+namespace anomaly {
+
+enum class FsyncPolicy { NEVER, INTERVAL, EVERY_BATCH };
+enum class LogOverflowPolicy { BLOCK, DROP_NEWEST, DROP_OLDEST };
+
+struct LogWriterConfig {
+    size_t queue_capacity{65536};    // lines buffered before overflow policy applies
+    size_t batch_size{256};          // wake the writer early once this many are queued
+    uint32_t flush_interval_ms{200}; // max delay before queued lines hit the file
+    FsyncPolicy fsync{FsyncPolicy::NEVER};
+    LogOverflowPolicy overflow{LogOverflowPolicy::DROP_NEWEST};
+    bool console{true};              // echo lines to stdout from the writer thread
+    int cpu{-1};                     // pin the writer thread to this CPU, -1 = unpinned
+};
+
+struct LogWriterStats {
+    uint64_t written{0};
+    uint64_t dropped{0};
+    uint64_t batches{0};
+    uint64_t fsyncs{0};
+};
+
+// Formats "YYYY-MM-DD HH:MM:SS" and reuses the result while the second
+// does not change, so bursts of alerts skip localtime/put_time entirely.
+// Not thread-safe.
+class TimestampFormatter {
+public:
+    const std::string& format(TimePoint t);
+
+private:
+    int64_t cached_sec_{INT64_MIN};
+    std::string cached_;
+};
+
+// Background writer for the alert log: producers enqueue finished lines
+// into a bounded queue and return immediately; a single thread keeps the
+// file open and writes them out in batches.
+class AlertLogWriter {
+public:
+    explicit AlertLogWriter(std::string path,
+                            LogWriterConfig config = LogWriterConfig{});
+    ~AlertLogWriter();  // drains the queue, then closes the file
+
+    AlertLogWriter(const AlertLogWriter&) = delete;
+    AlertLogWriter& operator=(const AlertLogWriter&) = delete;
+
+    // Queue one line (newline included). Returns false if it was dropped.
+    // A nonzero trace_id is stamped ALERT_PERSISTED once the line is written.
+    bool submit(std::string line, uint64_t trace_id = 0);
+
+    // Block until every line submitted before the call has been written
+    void flush();
+
+    LogWriterStats stats() const;
+
+private:
+    std::string path_;
+    LogWriterConfig config_;
+    std::FILE* file_{nullptr};
+
+    std::deque<std::string> queue_;
+    std::vector<uint64_t> traced_;  // trace ids of queued lines
+    uint64_t submitted_{0};   // lines accepted or dropped so far
+    uint64_t completed_{0};   // lines written or dropped so far
+    bool flush_requested_{false};
+    bool stopping_{false};
+    mutable std::mutex mtx_;
+    std::condition_variable work_cv_;
+    std::condition_variable space_cv_;
+    std::condition_variable done_cv_;
+
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> fsyncs_{0};
+
+    std::thread thread_;
+
+    void run();
+    void writeBatch(std::vector<std::string>& batch, bool force_sync);
+};
+
+} // namespace anomaly
@@ -1,34 +1,66 @@
 #pragma once
-#include "Packet.h"
+#include "Alert.h"
+#include "AlertStore.h"
+#include "AlertAggregates.h"
+#include "AlertSuppressor.h"
+#include "AlertLogWriter.h"
 #include <vector>
 #include <string>
 #include <mutex>
-#include <fstream>
+#include <memory>
+#include <functional>
 
 namespace anomaly {
 
-enum class AlertLevel { LOW, MEDIUM, HIGH, CRITICAL };
-
-struct Alert {
-    AlertLevel level;
-    std::string message;
-    AnomalyReport report;
-    std::string timestamp_str;
+struct AlertManagerConfig {
+    SuppressionConfig suppression;  // storm suppression (off by default)
+    LogWriterConfig log;            // background log/console writer
+    AlertStoreConfig store;         // in-memory alert history bounds
+    AggregateConfig aggregates;     // running summaries
 };
 
 class AlertManager {
 public:
-    explicit AlertManager(const std::string& log_file = "alerts.log");
+    using AlertCallback = std::function<void(const Alert&)>;
+
+    explicit AlertManager(const std::string& log_file = "alerts.log",
+                          AlertManagerConfig config = AlertManagerConfig{});
     ~AlertManager() = default;
 
     // Raise an alert from anomaly report
     void raise(const AnomalyReport& report);
 
-    // Get all alerts raised so far
-    const std::vector<Alert>& getAlerts() const { return alerts_; }
+    // Raise several alerts under one lock acquisition
+    void raiseBatch(const std::vector<AnomalyReport>& reports);
+    void raiseBatch(const AnomalyReport* reports, size_t count);
+
+    // Called for every recorded alert, under the manager lock: callbacks
+    // must be fast and must not call back into the manager
+    void onAlert(AlertCallback callback);
+
+    // Emit summaries for all open suppression windows (e.g. before export)
+    void flushSuppressed();
+
+    // Emitted vs suppressed counters of the suppression stage
+    SuppressionStats suppressionStats() const;
+
+    // Block until all raised alerts have been written to the log
+    void flushLog();
+
+    // Written/dropped counters of the background log writer
+    LogWriterStats logStats() const;
 
-    // Get alerts filtered by level
-    std::vector<Alert> getAlertsByLevel(AlertLevel level) const;
+    // Snapshot of the alerts still held (oldest first). Snapshots share
+    // the stored alerts and stay valid after they are evicted.
+    AlertSnapshot getAlerts() const;
+
+    // Indexed lookups, O(results)
+    AlertSnapshot getAlertsByLevel(AlertLevel level) const;
+    AlertSnapshot getAlertsBySource(const std::string& source_ip) const;
+    AlertSnapshot getAlertsInRange(TimePoint from, TimePoint to) const;
+
+    // Alerts with sequence >= seq; seq is advanced past the last returned
+    AlertSnapshot getAlertsSince(uint64_t& seq) const;
 
     // Export alerts to JSON file (for Python layer)
     void exportToJSON(const std::string& filepath) const;
@@ -36,17 +68,36 @@ public:
     // Clear all alerts
     void clearAlerts();
 
-    // Get alert count
-    size_t count() const { return alerts_.size(); }
+    // Running summaries (O(1) per alert): since start and current window
+    AggregateSnapshot lifetimeAggregates() const;
+    AggregateSnapshot windowAggregates() const;
+
+    // Write the running summaries as a small JSON file next to an export
+    bool writeSummary(const std::string& filepath) const;
+
+    // Number of alerts currently held
+    size_t count() const;
+
+    // Alerts dropped from the history once the store was full
+    uint64_t evictedCount() const;
 
 private:
-    std::vector<Alert> alerts_;
+    AlertStore store_;
+    AlertAggregates aggregates_;
     std::string log_file_;
+    AlertManagerConfig config_;
+    AlertSuppressor suppressor_;
+    std::vector<AnomalyReport> pending_;  // suppressor output, reused
+    TimestampFormatter timestamps_;
+    std::unique_ptr<AlertLogWriter> log_writer_;
+    std::vector<AlertCallback> callbacks_;
     mutable std::mutex mtx_;
 
+    void raiseLocked(const AnomalyReport& report);
+    void record(const AnomalyReport& report);
+
     AlertLevel severityToLevel(double severity) const;
     std::string levelToString(AlertLevel level) const;
-    std::string getCurrentTimestamp() const;
     void writeToLog(const Alert& alert);
 };
 
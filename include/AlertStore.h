@@ -0,0 +1,64 @@
+#pragma once
+#include "Alert.h"
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace anomaly {
+
+using AlertPtr      = std::shared_ptr<const Alert>;
+using AlertSnapshot = std::vector<AlertPtr>;  // shares alerts, never copies them
+
+struct AlertStoreConfig {
+    size_t capacity{100000};  // alerts kept before the oldest are overwritten
+    uint32_t bucket_sec{60};  // granularity of the time index
+};
+
+// Fixed-capacity ring of alerts with secondary indexes by level, source and
+// time bucket. Queries cost O(results) and return shared handles, so a
+// snapshot stays valid after the alert is evicted. Not thread-safe;
+// AlertManager serialises access.
+class AlertStore {
+public:
+    explicit AlertStore(AlertStoreConfig config = AlertStoreConfig{});
+
+    // Append an alert, evicting the oldest once full; returns its sequence
+    uint64_t push(Alert alert);
+
+    AlertSnapshot all() const;
+    AlertSnapshot byLevel(AlertLevel level) const;
+    AlertSnapshot bySource(const std::string& source_ip) const;
+    AlertSnapshot byTimeRange(TimePoint from, TimePoint to) const;  // [from, to)
+
+    // Alerts with sequence >= seq that are still held
+    AlertSnapshot since(uint64_t seq) const;
+
+    size_t size() const { return static_cast<size_t>(next_seq_ - head_seq_); }
+    uint64_t firstSequence() const { return head_seq_; }
+    uint64_t nextSequence() const { return next_seq_; }
+    uint64_t evicted() const { return evicted_; }
+    void clear();
+
+private:
+    AlertStoreConfig config_;
+    std::vector<AlertPtr> ring_;  // slot = sequence % capacity
+    uint64_t head_seq_{0};        // oldest held sequence
+    uint64_t next_seq_{0};
+    uint64_t evicted_{0};
+
+    // Index entries are sequences in ascending order, so eviction always
+    // pops from the front
+    std::array<std::deque<uint64_t>, 4> by_level_;
+    std::unordered_map<std::string, std::deque<uint64_t>> by_source_;
+    std::map<int64_t, std::deque<uint64_t>> by_bucket_;
+
+    const AlertPtr& at(uint64_t seq) const { return ring_[seq % ring_.size()]; }
+    int64_t bucketOf(TimePoint t) const;
+    void evictOldest();
+    AlertSnapshot resolve(const std::deque<uint64_t>& seqs) const;
+};
+
+} // namespace anomaly
@@ -0,0 +1,108 @@
+#pragma once
+#include "Alert.h"
+#include "SharedMemory.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace anomaly {
+
+// Shared-memory broadcast ring for live alert consumers.
+//
+// One publisher (the engine) writes; any number of local readers follow it
+// independently. The publisher never waits for readers: a reader that falls
+// more than `capacity` alerts behind skips ahead and counts the overrun.
+//
+// Layout (native endianness, all offsets from the start of the region):
+//
+//   0    StreamHeader   magic "5GALRT1\0", uint32 version, uint32 slot_size,
+//                       uint64 capacity (power of two), then on its own
+//                       cache line: atomic uint64 write_seq (next sequence)
+//   256  Slot[capacity] each: atomic uint64 version, AlertRecord record
+//
+// Slot for sequence s is s % capacity. Its version is 2s+1 while the
+// publisher writes it and 2s+2 once complete (a per-slot seqlock): a reader
+// copies the record and accepts it only if the version read before and
+// after the copy is 2s+2.
+namespace stream {
+constexpr char kMagic[8]    = {'5', 'G', 'A', 'L', 'R', 'T', '1', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct AlertRecord {
+    int64_t ts_ns;          // event time
+    double severity;
+    uint64_t alert_seq;     // AlertManager sequence
+    uint32_t source_addr;   // IPv4, host order (0 if not IPv4)
+    uint8_t level;          // AlertLevel
+    uint8_t type;           // AnomalyType
+    uint16_t message_len;
+    char source_ip[48];     // NUL-terminated
+    char message[168];      // not terminated; message_len bytes
+};
+
+struct alignas(64) Slot {
+    std::atomic<uint64_t> version;
+    AlertRecord record;
+};
+
+struct StreamHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t slot_size;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> write_seq;
+};
+
+constexpr size_t kSlotsOffset = 256;
+
+static_assert(sizeof(AlertRecord) == 248, "AlertRecord layout");
+static_assert(sizeof(Slot) == 256, "Slot layout");
+static_assert(sizeof(StreamHeader) <= kSlotsOffset, "StreamHeader layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+} // namespace stream
+
+class AlertStreamPublisher {
+public:
+    // nullptr if the region cannot be created; capacity rounds up to 2^n
+    static std::unique_ptr<AlertStreamPublisher> create(const std::string& name,
+                                                        size_t capacity = 4096);
+
+    // Wait-free; overwrites the oldest slot once the ring has wrapped
+    void publish(const Alert& alert);
+
+    uint64_t published() const;
+
+private:
+    explicit AlertStreamPublisher(std::unique_ptr<SharedMemoryRegion> region);
+
+    std::unique_ptr<SharedMemoryRegion> region_;
+    stream::StreamHeader* header_;
+    stream::Slot* slots_;
+    uint64_t mask_;
+};
+
+class AlertStreamReader {
+public:
+    // nullptr if the stream does not exist or has a different layout.
+    // The reader starts at the publisher's current position.
+    static std::unique_ptr<AlertStreamReader> open(const std::string& name);
+
+    // Copy up to max_records new records into out; returns how many
+    size_t poll(std::vector<stream::AlertRecord>& out, size_t max_records = 1024);
+
+    // Records skipped because the publisher lapped this reader
+    uint64_t overruns() const { return overruns_; }
+
+private:
+    explicit AlertStreamReader(std::unique_ptr<SharedMemoryRegion> region);
+
+    std::unique_ptr<SharedMemoryRegion> region_;
+    const stream::StreamHeader* header_;
+    const stream::Slot* slots_;
+    uint64_t capacity_;
+    uint64_t cursor_;
+    uint64_t overruns_{0};
+};
+
+} // namespace anomaly
@@ -0,0 +1,74 @@
+#pragma once
+#include "Packet.h"
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <string>
+
+namespace anomaly {
+
+struct SuppressionConfig {
+    bool enabled{false};
+    uint32_t window_sec{60};   // aggregation window per key (event time)
+    size_t max_keys{10000};    // bound on concurrently tracked keys
+};
+
+struct SuppressionStats {
+    uint64_t emitted{0};     // reports passed through (first of a window)
+    uint64_t suppressed{0};  // reports folded into a summary
+    uint64_t summaries{0};   // aggregated summaries emitted
+    uint64_t evicted{0};     // keys closed early to respect max_keys
+};
+
+// Collapses alert storms: for each (type, source, window) key the first
+// report is passed through and later ones are counted; when the window
+// closes a single "N occurrences, peak severity X" summary is emitted.
+// Not thread-safe; AlertManager calls it under its own lock.
+class AlertSuppressor {
+public:
+    explicit AlertSuppressor(SuppressionConfig config = SuppressionConfig{});
+
+    // Feed one report; appends the reports that should be raised to out
+    void process(const AnomalyReport& report, std::vector<AnomalyReport>& out);
+
+    // Close every open window, appending summaries for suppressed reports
+    void flush(std::vector<AnomalyReport>& out);
+
+    const SuppressionConfig& getConfig() const { return config_; }
+    const SuppressionStats& stats() const { return stats_; }
+    size_t trackedKeys() const { return index_.size(); }
+
+private:
+    struct Key {
+        AnomalyType type;
+        std::string source_ip;
+        bool operator==(const Key& o) const {
+            return type == o.type && source_ip == o.source_ip;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return std::hash<std::string>{}(k.source_ip) ^
+                   (static_cast<size_t>(k.type) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+    struct Entry {
+        Key key;
+        int64_t window{0};
+        uint64_t suppressed{0};
+        double peak_severity{0.0};
+        TimePoint last_seen{};
+    };
+
+    SuppressionConfig config_;
+    SuppressionStats stats_;
+    std::list<Entry> lru_;  // most recently touched at the front
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+    int64_t swept_window_{0};
+
+    int64_t windowOf(TimePoint t) const;
+    void close(const Entry& entry, std::vector<AnomalyReport>& out);
+    void sweep(int64_t current_window, std::vector<AnomalyReport>& out);
+};
+
+} // namespace anomaly
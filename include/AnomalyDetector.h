@@ -1,17 +1,22 @@
 #pragma once
 #include "Packet.h"
+#include "SourceInterner.h"
 #include <vector>
-#include <unordered_map>
+#include <memory_resource>
 #include <mutex>
 #include <optional>
+#include <memory>
+#include <string_view>
 
 namespace anomaly {
 
 struct DetectorConfig {
     double max_latency_ms{100.0};
-    uint32_t flood_threshold{100};      // packets/sec from same IP
+    uint32_t flood_threshold{100};      // packets/window from same IP
     double packet_loss_threshold{0.05}; // 5%
-    uint32_t window_size_sec{10};       // sliding window
+    uint32_t window_size_sec{10};       // event-time window, 0 = unbounded
+    uint32_t source_idle_sec{300};      // reclaim idle source state, 0 = never
+    uint32_t shard_count{1};            // independent locks/state tables, fixed at construction
 };
 
 class AnomalyDetector {
@@ -25,6 +30,26 @@ public:
     // Analyze a batch — returns all detected anomalies
     std::vector<AnomalyReport> analyzeBatch(const std::vector<Packet>& packets);
 
+    // Batch path for hot loops: takes the lock once and appends anomalies
+    // to out (not cleared). Returns how many were appended.
+    size_t analyzeBatch(const std::vector<Packet>& packets,
+                        std::vector<AnomalyReport>& out);
+
+    // Same over a plain array; when rows is set, also appends the index in
+    // packets of each reported packet (the C API maps results back to rows)
+    size_t analyzeBatch(const Packet* packets, size_t count,
+                        std::vector<AnomalyReport>& out,
+                        std::vector<size_t>* rows = nullptr);
+
+    // Same, with each report and its strings allocated from out's memory
+    // resource. With a per-batch arena such as monotonic_buffer_resource
+    // nothing reaches the global heap, and the batch's reports are freed
+    // by one release() once they have been handled. Copy a report to keep
+    // it past that; moving it keeps the arena's memory.
+    size_t analyzeBatch(const Packet* packets, size_t count,
+                        std::pmr::vector<AnomalyReport>& out,
+                        std::vector<size_t>* rows = nullptr);
+
     // Reset internal state (counters, history)
     void reset();
 
@@ -34,17 +59,63 @@ public:
     // Update thresholds at runtime
     void updateConfig(const DetectorConfig& new_config);
 
+    // Latest event time seen (packets without a timestamp inherit it)
+    TimePoint watermark() const;
+
+    // Number of sources currently holding detector state
+    size_t trackedSources() const;
+
+    // Sources are split across shards by sourceHash(); each shard has its
+    // own lock, so threads working on different shards never contend
+    size_t shardCount() const { return shards_.size(); }
+    size_t shardOf(std::string_view src_ip) const;
+
+    // Well-mixed hash of a source address, shared with NetworkMonitor's
+    // dispatch so a worker's sources map onto the same shard
+    static uint64_t sourceHash(std::string_view src_ip);
+
+    // Reallocate a shard (lock, interner, state tables) from the calling
+    // thread, so first touch puts it on that thread's NUMA node. State is
+    // kept. Replaces the shard object, so no other thread may be using
+    // the detector, or hold a reference into it, during the call.
+    void rebuildShard(size_t index);
+
 private:
+    // Per-source state, stored densely and indexed by interned source ID
+    struct SourceState {
+        int64_t window_index{0};   // event-time window number
+        uint32_t window_count{0};  // packets seen in that window
+        uint32_t sent{0};
+        uint32_t lost{0};
+        int64_t last_seen_sec{0};
+        bool active{false};
+    };
+
+    struct alignas(64) Shard {
+        SourceInterner interner;
+        std::vector<SourceState> sources;  // source ID -> state
+        TimePoint watermark{};
+        int64_t next_sweep_sec{0};
+        mutable std::mutex mtx;
+    };
+
     DetectorConfig config_;
-    std::unordered_map<std::string, uint32_t> packet_counts_;  // IP -> count
-    std::unordered_map<std::string, uint32_t> sent_packets_;
-    std::unordered_map<std::string, uint32_t> lost_packets_;
-    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<Shard>> shards_;
 
+    template <typename Reports>
+    size_t analyzeInto(const Packet* packets, size_t count, Reports& out,
+                       std::vector<size_t>* rows, std::pmr::memory_resource* resource);
+    std::optional<AnomalyReport> analyzeLocked(Shard& shard, const Packet& packet,
+                                               std::pmr::memory_resource* resource);
+    TimePoint eventTime(Shard& shard, const Packet& p);
+    int64_t windowIndex(TimePoint t) const;
+    SourceState& sourceState(Shard& shard, const std::string& src_ip, int64_t now_sec);
+    void expireIdleSources(Shard& shard, int64_t now_sec);
     bool isHighLatency(const Packet& p) const;
-    bool isFlood(const std::string& src_ip);
-    bool isPacketLoss(const std::string& src_ip, uint32_t sent, uint32_t lost);
-    double calculateSeverity(AnomalyType type, const Packet& p) const;
+    bool isFlood(SourceState& src, TimePoint event_time);
+    bool isPacketLoss(const SourceState& src) const;
+    double calculateSeverity(AnomalyType type, const Packet& p,
+                             const SourceState& src) const;
 };
 
 } // namespace anomaly
@@ -0,0 +1,74 @@
+#pragma once
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+
+namespace anomaly {
+
+using TimePoint = std::chrono::system_clock::time_point;
+
+// A default-constructed TimePoint (the epoch) means "no timestamp"
+inline bool hasTimestamp(TimePoint t) { return t != TimePoint{}; }
+
+inline int64_t toNanos(TimePoint t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        t.time_since_epoch()).count();
+}
+
+inline TimePoint fromNanos(int64_t ns) {
+    return TimePoint(std::chrono::duration_cast<TimePoint::duration>(
+        std::chrono::nanoseconds(ns)));
+}
+
+// Source of "now" for components that need one. Packets carry their own
+// event time; a Clock is only consulted for packets that arrive without one.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual TimePoint now() const = 0;
+};
+
+// Wall clock (std::chrono::system_clock)
+class SystemClock : public Clock {
+public:
+    TimePoint now() const override;
+};
+
+// Cheap monotonic clock: steady_clock anchored to the wall clock once at
+// construction, so readings never jump backwards on NTP adjustments
+class MonotonicClock : public Clock {
+public:
+    MonotonicClock();
+    TimePoint now() const override;
+
+private:
+    TimePoint wall_origin_;
+    std::chrono::steady_clock::time_point steady_origin_;
+};
+
+// Manually driven clock for tests and deterministic runs
+class VirtualClock : public Clock {
+public:
+    explicit VirtualClock(TimePoint start = TimePoint{});
+
+    TimePoint now() const override;
+    void set(TimePoint t);
+    void advance(std::chrono::nanoseconds delta);
+
+private:
+    std::atomic<int64_t> now_ns_;
+};
+
+// Event-time clock: follows the largest event timestamp observed so far
+class EventClock : public Clock {
+public:
+    TimePoint now() const override;
+
+    // Advance the watermark (never moves backwards)
+    void observe(TimePoint event_time);
+
+private:
+    std::atomic<int64_t> watermark_ns_{0};
+};
+
+} // namespace anomaly
@@ -0,0 +1,98 @@
+#pragma once
+#include "AlertManager.h"
+#include <string>
+#include <vector>
+#include <cstdio>
+
+namespace anomaly {
+
+// Binary columnar alert file, little-endian, every section 8-byte aligned
+// so each column can be mapped straight into a numpy array:
+//
+//   FileHeader   magic "5GAC", uint32 version, uint64 reserved   (16 bytes)
+//   repeated blocks:
+//     BlockHeader  magic "BLK1", uint32 rows, uint32 dict_entries,
+//                  uint32 dict_bytes, uint64 first_seq           (24 bytes)
+//     int64   ts_ns[rows]        event time, ns since epoch
+//     float64 severity[rows]
+//     uint32  source_addr[rows]  IPv4, host order (0 if not IPv4)
+//     uint32  message_id[rows]   index into this block's dictionary
+//     uint8   level[rows]        AlertLevel
+//     uint8   type[rows]         AnomalyType
+//     uint32  dict_offsets[dict_entries + 1], then UTF-8 message bytes
+//
+// Each column and the dictionary are zero-padded to a multiple of 8 bytes;
+// dict_bytes covers the offsets, the text and that padding.
+namespace columnar {
+constexpr char kFileMagic[4]  = {'5', 'G', 'A', 'C'};
+constexpr char kBlockMagic[4] = {'B', 'L', 'K', '1'};
+constexpr uint32_t kVersion   = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct BlockHeader {
+    char magic[4];
+    uint32_t rows;
+    uint32_t dict_entries;
+    uint32_t dict_bytes;
+    uint64_t first_seq;
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+static_assert(sizeof(BlockHeader) == 24, "BlockHeader layout");
+} // namespace columnar
+
+struct ColumnarExportConfig {
+    uint32_t rows_per_block{65536};
+};
+
+// Incremental exporter: each call appends the alerts raised since the
+// previous call as one or more column blocks. A file with a matching
+// header is continued (a trailing partial block from a crash is cut off).
+// Any other non-empty file (foreign, another version, a corrupt block) is
+// left untouched and the exporter stays closed (isOpen() false).
+class ColumnarExporter {
+public:
+    explicit ColumnarExporter(std::string path,
+                              ColumnarExportConfig config = ColumnarExportConfig{});
+    ~ColumnarExporter();
+
+    ColumnarExporter(const ColumnarExporter&) = delete;
+    ColumnarExporter& operator=(const ColumnarExporter&) = delete;
+
+    // Append alerts raised since the last call; returns how many were written
+    size_t exportNew(const AlertManager& manager);
+
+    uint64_t missed() const { return missed_; }
+
+    bool isOpen() const { return file_ != nullptr; }
+
+private:
+    std::string path_;
+    ColumnarExportConfig config_;
+    std::FILE* file_{nullptr};
+    uint64_t cursor_{0};
+    uint64_t missed_{0};
+
+    // Column buffers reused across blocks
+    std::vector<int64_t> ts_ns_;
+    std::vector<double> severity_;
+    std::vector<uint32_t> source_addr_;
+    std::vector<uint32_t> message_id_;
+    std::vector<uint8_t> level_;
+    std::vector<uint8_t> type_;
+    std::vector<uint32_t> dict_offsets_;
+    std::string dict_text_;
+
+    bool openExisting();
+    void create();
+    void writeBlock(const AlertSnapshot& alerts, size_t begin, size_t end);
+    void writePadded(const void* data, size_t bytes);
+    void pad(size_t bytes);
+};
+
+} // namespace anomaly
@@ -0,0 +1,68 @@
+#pragma once
+#include "Packet.h"
+#include "PacketProcessor.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anomaly {
+
+class NetworkMonitor;
+
+struct FileIngestConfig {
+    size_t queue_depth{8};        // block reads in flight (and buffers)
+    size_t block_size{1 << 20};   // bytes per read; rounded up to 4 KiB
+    size_t threads{4};            // pread pool size when io_uring is unavailable
+    bool use_io_uring{true};      // false = always use the pread pool
+    size_t batch_size{1024};      // packets per feedBatch
+    int cpu{-1};                  // pin run()'s caller (the parser); pread threads prefer its node
+};
+
+struct FileIngestStats {
+    uint64_t files{0};
+    uint64_t bytes{0};
+    uint64_t reads{0};          // block reads completed
+    uint64_t packets{0};        // parsed and offered to the monitor
+    uint64_t accepted{0};
+    uint64_t skipped{0};        // unparsable lines, trailing partial records
+    uint64_t failed_files{0};   // could not be opened or read
+    double seconds{0.0};
+    double mb_per_sec{0.0};
+};
+
+// Reads a list of capture/trace files (text or binary, as TraceReader)
+// with up to queue_depth block reads in flight across file boundaries, so
+// the next file is already loading while the current one is parsed.
+// Reads go through io_uring (raw syscalls, READ_FIXED into registered
+// buffers) when the kernel allows it, otherwise through a small pool of
+// pread threads sharing the same buffers. Completed blocks are parsed in
+// file order as soon as they are next in line, on the calling thread,
+// with parseInto/decodeRecord into a reused batch for feedBatch. Files
+// are assumed not to change while they are read.
+class FileIngest {
+public:
+    explicit FileIngest(FileIngestConfig config = FileIngestConfig{});
+    ~FileIngest();
+
+    FileIngest(const FileIngest&) = delete;
+    FileIngest& operator=(const FileIngest&) = delete;
+
+    // Feed every file, in order, into a running monitor
+    FileIngestStats run(const std::vector<std::string>& paths, NetworkMonitor& monitor);
+
+    // "io_uring" or "pread"
+    const char* backend() const;
+
+    // Regular files in dir, sorted by name (rotated captures sort in order)
+    static std::vector<std::string> listDirectory(const std::string& dir);
+
+    class Reader;  // block read backend
+
+private:
+    FileIngestConfig config_;
+    std::unique_ptr<Reader> reader_;
+    PacketProcessor parser_;
+};
+
+} // namespace anomaly
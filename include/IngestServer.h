@@ -0,0 +1,98 @@
+#pragma once
+#include "Packet.h"
+#include "PacketProcessor.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace anomaly {
+
+class NetworkMonitor;
+
+struct IngestConfig {
+    std::string unix_path;            // Unix datagram socket path; empty = UDP
+    std::string udp_address{"127.0.0.1"};
+    uint16_t udp_port{0};             // 0 = pick a free port (see port())
+    size_t batch_size{64};            // datagrams per recvmmsg call
+    size_t max_datagram{2048};        // longer datagrams are truncated and rejected
+    int receive_buffer{8 << 20};      // SO_RCVBUF request in bytes, 0 = system default
+    int cpu{-1};                      // pin the receive thread (and its buffers' node); -1 = unpinned
+};
+
+struct IngestStats {
+    uint64_t datagrams{0};
+    uint64_t records{0};       // parsed and fed to the monitor
+    uint64_t parse_errors{0};  // malformed records (and truncated datagrams)
+    uint64_t rejected{0};      // parsed but dropped by the monitor's overflow policy
+    uint64_t socket_drops{0};  // dropped by the kernel on a full receive buffer
+    uint64_t receive_calls{0}; // recvmmsg calls that returned data
+};
+
+// Receives text records in PacketProcessor's format over UDP or a Unix
+// datagram socket and feeds them to a NetworkMonitor. A datagram holds one
+// or more newline-separated records. One thread waits in epoll and, once
+// the socket is readable, pulls up to batch_size datagrams per recvmmsg
+// call into fixed buffers, parses them in place with parseInto() into a
+// reused batch and hands each batch to feedBatch(). With the monitor's
+// BLOCK policy a slow pipeline backs up into the socket buffer, where the
+// kernel drops and counts the overflow (SO_RXQ_OVFL, UDP only: a Unix
+// datagram sender blocks or gets EAGAIN instead). Linux only.
+class IngestServer {
+public:
+    // Bind the socket; nullptr on failure. An existing file at unix_path
+    // is replaced, and removed again on destruction.
+    static std::unique_ptr<IngestServer> create(NetworkMonitor& monitor,
+                                                IngestConfig config = IngestConfig{});
+    ~IngestServer();
+
+    IngestServer(const IngestServer&) = delete;
+    IngestServer& operator=(const IngestServer&) = delete;
+
+    // Start/stop the receive thread; stop() returns once it has exited
+    void start();
+    void stop();
+
+    // Bound UDP port (0 for a Unix socket)
+    uint16_t port() const { return port_; }
+
+    IngestStats stats() const;
+
+private:
+    IngestServer(NetworkMonitor& monitor, IngestConfig config, int fd,
+                 int epoll_fd, int wake_fd, uint16_t port);
+
+    NetworkMonitor& monitor_;
+    IngestConfig config_;
+    int fd_;
+    int epoll_fd_;
+    int wake_fd_;   // eventfd that ends the epoll wait on stop()
+    uint16_t port_;
+    PacketProcessor parser_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    std::atomic<uint64_t> datagrams_{0};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> parse_errors_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> socket_drops_{0};
+    std::atomic<uint64_t> receive_calls_{0};
+
+    void receiveLoop();
+    // Drain the socket until it would block; false on a fatal error
+    bool drainSocket();
+    // Parse a datagram's records into batch_[used_...], feeding full batches
+    void parseDatagram(const char* data, size_t len);
+    void flushBatch();
+
+    // Receive state, touched only by the receive thread
+    struct ReceiveBuffers;                // recvmmsg headers and datagram memory
+    std::unique_ptr<ReceiveBuffers> rx_;
+    std::vector<Packet> batch_;           // reused; parseInto overwrites in place
+    size_t used_{0};
+};
+
+} // namespace anomaly
@@ -0,0 +1,19 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace anomaly {
+
+// Parse a dotted-quad IPv4 address into host byte order.
+// Returns false (leaving out untouched) for anything else.
+bool parseIPv4(std::string_view text, uint32_t& out);
+
+// Format a host-byte-order IPv4 address as a dotted quad
+std::string formatIPv4(uint32_t addr);
+
+// Allocation-free variant: writes up to 15 chars (no terminator) to out
+// and returns the length
+size_t formatIPv4(uint32_t addr, char* out);
+
+} // namespace anomaly
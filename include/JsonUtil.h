@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+namespace anomaly {
+
+// Append s as a quoted JSON string, escaping quotes, backslashes and
+// control characters
+void appendJsonString(std::string& out, std::string_view s);
+
+// Append a number in shortest round-trip form (std::to_chars);
+// non-finite values become null
+void appendJsonNumber(std::string& out, double value);
+void appendJsonNumber(std::string& out, int64_t value);
+void appendJsonNumber(std::string& out, uint64_t value);
+
+} // namespace anomaly
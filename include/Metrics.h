@@ -0,0 +1,215 @@
+#pragma once
+#include "RingBuffer.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace anomaly {
+namespace metrics {
+
+// Instrumentation compiles to nothing when built with -DENABLE_METRICS=OFF:
+// every update below is an empty inline function and call sites guard
+// their clock reads with `if constexpr (kEnabled)`.
+#ifdef ANOMALY_ENABLE_METRICS
+constexpr bool kEnabled = true;
+#else
+constexpr bool kEnabled = false;
+#endif
+
+// Updates go to one of kShards cache lines picked per thread, so threads
+// on different shards never bounce a line; reads sum the shards
+constexpr size_t kShards = 8;
+
+size_t assignShard();  // round-robin over new threads
+
+inline size_t threadShard() {
+    static thread_local size_t shard = assignShard();
+    return shard;
+}
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Start of a timed section; 0 (and no clock read) when metrics are off
+inline int64_t startTimer() {
+    if constexpr (kEnabled) return nowNs();
+    return 0;
+}
+
+// True for one call in 16 on each thread; per-packet paths time only
+// those to keep the clock pair off most packets
+inline bool sampled() {
+    static thread_local uint32_t tick = 0;
+    return (tick++ & 15) == 0;
+}
+
+// Monotonic count
+class Counter {
+public:
+    void inc(uint64_t n = 1) {
+        if constexpr (kEnabled) {
+            cells_[threadShard()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    uint64_t value() const;
+
+private:
+    struct alignas(kCacheLine) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+    std::array<Cell, kShards> cells_;
+};
+
+// Value that goes up and down. add() is sharded like Counter; set() is
+// meant for a single writer and is not atomic against concurrent add()s.
+class Gauge {
+public:
+    void add(int64_t n) {
+        if constexpr (kEnabled) {
+            cells_[threadShard()].value.fetch_add(n, std::memory_order_relaxed);
+        }
+    }
+    void set(int64_t v);
+    int64_t value() const;
+
+private:
+    struct alignas(kCacheLine) Cell {
+        std::atomic<int64_t> value{0};
+    };
+    std::array<Cell, kShards> cells_;
+};
+
+// HDR-style log-linear histogram of non-negative integers (nanoseconds,
+// packets, ...). Each power of two is split into 16 linear sub-buckets,
+// so any recorded value is known to within 1/16 (6.25%); values 0-15 are
+// exact and anything from 2^41 up lands in the last bucket. observe() is
+// a bit scan plus one relaxed add on the thread's shard.
+class Histogram {
+public:
+    static constexpr int kSubBits     = 4;
+    static constexpr size_t kSub      = size_t{1} << kSubBits;
+    static constexpr int kMaxExponent = 40;
+    static constexpr size_t kBuckets  = (kMaxExponent - kSubBits + 2) * kSub;
+
+    // scale converts recorded units to exported ones (1e-9: ns -> seconds)
+    explicit Histogram(double scale = 1.0);
+
+    void observe(uint64_t value, uint64_t count = 1) {
+        if constexpr (kEnabled) {
+            Shard& s = shards_[threadShard()];
+            s.counts[bucketOf(value)].fetch_add(count, std::memory_order_relaxed);
+            s.sum.fetch_add(value * count, std::memory_order_relaxed);
+        }
+    }
+
+    // Elapsed time since startTimer(), spread evenly over `items`
+    void observeSince(int64_t start_ns, uint64_t items = 1) {
+        if constexpr (kEnabled) {
+            if (items == 0) return;
+            int64_t elapsed = nowNs() - start_ns;
+            observe(elapsed > 0 ? static_cast<uint64_t>(elapsed) / items : 0, items);
+        }
+    }
+
+    struct Snapshot {
+        std::vector<uint64_t> counts;  // per bucket
+        uint64_t count{0};
+        uint64_t sum{0};               // recorded units
+
+        // Upper bound of the bucket holding the q-quantile (0 if empty)
+        uint64_t quantile(double q) const;
+    };
+    Snapshot snapshot() const;
+
+    double scale() const { return scale_; }
+
+    static size_t bucketOf(uint64_t value) {
+        if (value < kSub) return static_cast<size_t>(value);
+        int exp = 63 - __builtin_clzll(value);
+        if (exp > kMaxExponent) return kBuckets - 1;
+        size_t sub = static_cast<size_t>(value >> (exp - kSubBits)) & (kSub - 1);
+        return static_cast<size_t>(exp - kSubBits + 1) * kSub + sub;
+    }
+    // Largest value that maps to bucket i
+    static uint64_t bucketUpper(size_t i);
+
+private:
+    struct alignas(kCacheLine) Shard {
+        std::array<std::atomic<uint64_t>, kBuckets> counts{};
+        std::atomic<uint64_t> sum{0};
+    };
+    double scale_;
+    std::unique_ptr<Shard[]> shards_;
+};
+
+// Named metrics and their Prometheus text exposition. Metrics are created
+// once (normally into function-local statics at the instrumentation site)
+// and live as long as the registry. A name may carry a label set,
+// e.g. `anomaly_reports_total{type="FLOOD"}`; metrics sharing the part
+// before '{' are exported as one family.
+class Registry {
+public:
+    static Registry& global();
+
+    // Return the existing metric when the name is already registered
+    Counter& counter(const std::string& name, const std::string& help);
+    Gauge& gauge(const std::string& name, const std::string& help);
+    Histogram& histogram(const std::string& name, const std::string& help,
+                         double scale = 1.0);
+
+    // Prometheus text format 0.0.4
+    std::string prometheusText() const;
+
+    // Write prometheusText() to path via a temporary file and rename, so a
+    // textfile collector never reads a partial file. False on I/O error.
+    bool writePrometheusFile(const std::string& path) const;
+
+private:
+    enum class Type { COUNTER, GAUGE, HISTOGRAM };
+    struct Entry {
+        std::string name;
+        std::string help;
+        Type type;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    mutable std::mutex mtx_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+
+    Entry& entryLocked(const std::string& name, const std::string& help, Type type);
+};
+
+// Rewrites a Prometheus text file from a registry every interval, and
+// once more on destruction
+class FileExporter {
+public:
+    FileExporter(std::string path, std::chrono::milliseconds interval,
+                 const Registry& registry = Registry::global());
+    ~FileExporter();
+
+    FileExporter(const FileExporter&) = delete;
+    FileExporter& operator=(const FileExporter&) = delete;
+
+private:
+    std::string path_;
+    std::chrono::milliseconds interval_;
+    const Registry& registry_;
+    bool stopping_{false};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::thread thread_;
+};
+
+} // namespace metrics
+} // namespace anomaly
@@ -0,0 +1,55 @@
+#pragma once
+#include "AlertManager.h"
+#include <string>
+#include <cstdio>
+
+namespace anomaly {
+
+struct NdjsonExportConfig {
+    uint64_t max_bytes{0};    // rotate once the file reaches this size, 0 = never
+    uint32_t max_age_sec{0};  // rotate once the file is this old, 0 = never
+    uint32_t max_files{5};    // rotated files kept as path.1 .. path.N
+};
+
+struct NdjsonExportStats {
+    uint64_t exported{0};   // alerts written
+    uint64_t missed{0};     // alerts evicted from the store before export
+    uint64_t rotations{0};
+};
+
+// Incremental exporter: each call appends only the alerts raised since the
+// previous call, one JSON object per line, so cost is proportional to new
+// alerts rather than to the whole history.
+class NdjsonExporter {
+public:
+    explicit NdjsonExporter(std::string path,
+                            NdjsonExportConfig config = NdjsonExportConfig{});
+    ~NdjsonExporter();
+
+    NdjsonExporter(const NdjsonExporter&) = delete;
+    NdjsonExporter& operator=(const NdjsonExporter&) = delete;
+
+    // Append alerts raised since the last call; returns how many were written
+    size_t exportNew(const AlertManager& manager);
+
+    const NdjsonExportStats& stats() const { return stats_; }
+
+    // Serialise one alert as a single NDJSON line (newline included)
+    static void appendLine(std::string& out, const Alert& alert);
+
+private:
+    std::string path_;
+    NdjsonExportConfig config_;
+    std::FILE* file_{nullptr};
+    uint64_t file_bytes_{0};
+    std::chrono::steady_clock::time_point opened_at_;
+    uint64_t cursor_{0};
+    std::string buffer_;
+    NdjsonExportStats stats_;
+
+    void open();
+    void writeBuffer();
+    void rotateIfDue();
+};
+
+} // namespace anomaly
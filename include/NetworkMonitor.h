@@ -2,48 +2,168 @@
 #include "PacketProcessor.h"
 #include "AnomalyDetector.h"
 #include "AlertManager.h"
+#include "Clock.h"
+#include "RingBuffer.h"
 #include <thread>
 #include <atomic>
-#include <queue>
-#include <mutex>
-#include <condition_variable>
 #include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+#include <mutex>
 
 namespace anomaly {
 
-/// @brief 
+// What feedPacket does when the ingest queue is full
+enum class QueueOverflowPolicy {
+    BLOCK,        // wait for the worker to make room
+    DROP_NEWEST,  // reject the incoming packet
+    DROP_OLDEST,  // evict the oldest queued packet
+    SAMPLE        // admit 1 in sample_every (evicting the oldest), drop the rest
+};
+
+struct MonitorConfig {
+    size_t workers{1};             // worker threads, each with its own queue
+    bool work_stealing{false};     // idle workers take batches from backed-up queues
+    size_t queue_capacity{65536};  // packets per worker; rounded up to a power of two
+    QueueOverflowPolicy overflow{QueueOverflowPolicy::BLOCK};
+    uint32_t sample_every{10};     // SAMPLE policy rate while the queue is full
+    int idle_spins{1000};          // spins before an idle thread parks
+    size_t batch_size{256};        // packets drained per detector/alert call
+    uint32_t max_batch_delay_us{0}; // wait this long to fill a partial batch
+    std::vector<int> worker_cpus;  // worker i runs on worker_cpus[i % size]; empty = unpinned
+    bool numa_rebuild_shards{false}; // rebuild detector shards from pinned workers (see constructor)
+};
+
+struct MonitorStats {
+    uint64_t enqueued{0};
+    uint64_t dropped{0};     // lost to the overflow policy
+    uint64_t processed{0};
+    uint64_t batches{0};
+    uint64_t stolen{0};      // packets processed by a worker other than their own
+    size_t queue_depth{0};   // summed over workers
+    size_t queue_capacity{0};
+    size_t workers{0};
+};
+
+// Packets are dispatched to workers by AnomalyDetector::sourceHash of the
+// source address, so each source is always handled by the same worker and
+// in arrival order. With DetectorConfig::shard_count equal to the worker
+// count, each worker also owns one detector shard and never contends on
+// its lock. Work stealing trades that per-source ordering for balance
+// under skewed traffic.
 class NetworkMonitor {
 public:
+    using BatchCallback = std::function<void(const std::vector<Packet>&)>;
+
+    // clock stamps packets that arrive without an event time
+    // (defaults to a MonotonicClock). With worker_cpus and
+    // numa_rebuild_shards set, the constructor rebuilds the detector's
+    // shards from the pinned workers (AnomalyDetector::rebuildShard): no
+    // other thread or monitor may be using the detector until it returns.
     NetworkMonitor(std::shared_ptr<AnomalyDetector> detector,
-                   std::shared_ptr<AlertManager> alert_manager);
+                   std::shared_ptr<AlertManager> alert_manager,
+                   std::shared_ptr<Clock> clock = nullptr,
+                   MonitorConfig config = MonitorConfig{});
     ~NetworkMonitor();
 
-    // Start monitoring in background thread
+    // Observe every analyzed batch (e.g. to record a trace). Runs on the
+    // worker threads, concurrently when there are several; register before
+    // start().
+    void onBatch(BatchCallback callback);
+
+    // Start the worker threads
     void start();
 
-    // Stop monitoring gracefully
+    // Stop gracefully: workers drain their queues before exiting
     void stop();
 
-    // Feed a packet into the processing queue
-    void feedPacket(const Packet& packet);
+    // Feed a packet into the processing queue. Safe from any number of
+    // threads. Returns false if the overflow policy dropped it.
+    bool feedPacket(const Packet& packet);
+    bool feedPacket(Packet&& packet);
+
+    // Move a whole batch in: one slot claim and one wakeup per worker
+    // touched, one clock read for unstamped packets. Packets that do not
+    // fit go through the overflow policy. Returns how many were accepted;
+    // the input is left moved-from.
+    size_t feedBatch(Packet* packets, size_t count);
+    size_t feedBatch(std::vector<Packet>&& packets) {
+        return feedBatch(packets.data(), packets.size());
+    }
+
+    // Never blocks or evicts: accepted packets are removed from the vector,
+    // rejected ones stay (in order) for the caller to retry. Returns how
+    // many were accepted.
+    size_t tryFeedBatch(std::vector<Packet>& packets);
 
     // Feed simulated 5G traffic (for demo/testing)
     void simulateTraffic(int num_packets = 50);
 
     bool isRunning() const { return running_.load(); }
 
+    // Queue depth and enqueue/drop/process counters
+    MonitorStats stats() const;
+
+    // Machine topology and where each worker and noted feeder thread
+    // runs, one line per thread
+    std::string placementReport() const;
+
+    // Record where a feeder thread (an ingest loop) runs so
+    // placementReport() lists it; a later note under the same name
+    // replaces the earlier one
+    void notePlacement(const std::string& thread, int cpu, bool pinned);
+
 private:
     std::shared_ptr<AnomalyDetector> detector_;
     std::shared_ptr<AlertManager> alert_manager_;
+    std::shared_ptr<Clock> clock_;
+    MonitorConfig config_;
+
+    struct alignas(kCacheLine) Worker {
+        Worker(size_t capacity, int cpu) : queue(capacity), cpu(cpu) {}
+
+        RingBuffer<Packet> queue;
+        int cpu;                        // -1 = unpinned
+        std::atomic<int> placed{0};     // 0 pending, 1 pinned, -1 pin failed
+        Parker data_ready;   // worker waits for packets
+        Parker space_ready;  // BLOCK producers wait for room
+        std::thread thread;
+
+        std::atomic<uint64_t> enqueued{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> processed{0};
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> overflowed{0};  // full-queue arrivals, for SAMPLE
+    };
 
-    std::queue<Packet> packet_queue_;
-    std::mutex queue_mtx_;
-    std::condition_variable cv_;
+    std::vector<std::unique_ptr<Worker>> workers_;
 
-    std::thread monitor_thread_;
+    struct FeederPlacement {
+        std::string thread;
+        int cpu;
+        bool pinned;
+    };
+    mutable std::mutex placement_mtx_;
+    std::vector<FeederPlacement> feeders_;
+    std::vector<BatchCallback> batch_callbacks_;
+    Parker any_ready_;  // shared by all workers when stealing is on
     std::atomic<bool> running_{false};
 
-    void processLoop();
+    void workerLoop(size_t index);
+    size_t drainBatch(Worker& worker, std::vector<Packet>& batch);
+    size_t stealBatch(size_t thief, std::vector<Packet>& batch);
+    bool hasWork(size_t index) const;
+    Parker& dataReady(Worker& worker);
+    size_t workerFor(const Packet& pkt) const;
+    void stampBatch(Packet* packets, size_t count);
+    // Bulk-push packets[idx[0..n)] to one worker; returns how many fit
+    size_t pushBulk(Worker& worker, Packet* packets, const uint32_t* idx, size_t n);
+    void groupByWorker(const Packet* packets, size_t count);
+    std::vector<std::vector<uint32_t>>& batchScratch();
+    bool enqueue(Worker& worker, Packet&& pkt);
+    void evictOldest(Worker& worker);
     Packet generateSimulatedPacket(bool inject_anomaly = false) const;
 };
 
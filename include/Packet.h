@@ -1,13 +1,24 @@
 #pragma once
 #include <string>
 #include <cstdint>
-#include <chrono>
+#include <memory_resource>
+#include "Clock.h"
 
 namespace anomaly {
 
 enum class Protocol { TCP, UDP, ICMP, UNKNOWN };
 enum class AnomalyType { NONE, HIGH_LATENCY, PACKET_LOSS, FLOOD, UNKNOWN_PROTOCOL };
 
+inline const char* anomalyTypeName(AnomalyType type) {
+    switch (type) {
+        case AnomalyType::HIGH_LATENCY:     return "HIGH_LATENCY";
+        case AnomalyType::PACKET_LOSS:      return "PACKET_LOSS";
+        case AnomalyType::FLOOD:            return "FLOOD";
+        case AnomalyType::UNKNOWN_PROTOCOL: return "UNKNOWN_PROTOCOL";
+        default:                            return "NONE";
+    }
+}
+
 struct Packet {
     std::string src_ip;
     std::string dst_ip;
@@ -15,27 +26,51 @@ struct Packet {
     uint16_t dst_port{0};
     Protocol protocol{Protocol::UNKNOWN};
     uint32_t size_bytes{0};
+    uint32_t teid{0};       // GTP-U tunnel endpoint id, 0 = not tunnelled
     double latency_ms{0.0};
-    std::chrono::system_clock::time_point timestamp;
+    TimePoint timestamp{};  // event (capture) time; unset = stamped at ingest
+    int64_t ingest_ns{0};   // steady-clock enqueue time for queue-wait metrics, 0 = unsampled
+    uint64_t trace_id{0};   // pipeline tracing id, 0 = not traced
 
-    Packet() : timestamp(std::chrono::system_clock::now()) {}
+    Packet() = default;
 
     Packet(std::string src, std::string dst, uint16_t sport, uint16_t dport,
-           Protocol proto, uint32_t size, double latency)
+           Protocol proto, uint32_t size, double latency,
+           TimePoint ts = TimePoint{})
         : src_ip(std::move(src)), dst_ip(std::move(dst)),
           src_port(sport), dst_port(dport),
           protocol(proto), size_bytes(size), latency_ms(latency),
-          timestamp(std::chrono::system_clock::now()) {}
+          timestamp(ts) {}
 };
 
+// Allocator-aware, so a batch's reports and their strings can come from
+// one arena (see AnomalyDetector::analyzeBatch). Plain copies use the
+// default resource, so anything stored past the batch owns its memory.
 struct AnomalyReport {
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
     AnomalyType type{AnomalyType::NONE};
-    std::string description;
-    std::string source_ip;
+    std::pmr::string description;
+    std::pmr::string source_ip;
     double severity{0.0};  // 0.0 - 1.0
-    std::chrono::system_clock::time_point detected_at;
+    TimePoint detected_at{};  // event time of the triggering packet
+    uint64_t trace_id{0};     // the triggering packet's, when it was traced
 
-    AnomalyReport() : detected_at(std::chrono::system_clock::now()) {}
+    AnomalyReport() = default;
+    explicit AnomalyReport(const allocator_type& alloc)
+        : description(alloc), source_ip(alloc) {}
+    AnomalyReport(const AnomalyReport& other, const allocator_type& alloc)
+        : type(other.type), description(other.description, alloc),
+          source_ip(other.source_ip, alloc), severity(other.severity),
+          detected_at(other.detected_at), trace_id(other.trace_id) {}
+    AnomalyReport(AnomalyReport&& other, const allocator_type& alloc)
+        : type(other.type), description(std::move(other.description), alloc),
+          source_ip(std::move(other.source_ip), alloc), severity(other.severity),
+          detected_at(other.detected_at), trace_id(other.trace_id) {}
+    AnomalyReport(const AnomalyReport&) = default;
+    AnomalyReport(AnomalyReport&&) = default;
+    AnomalyReport& operator=(const AnomalyReport&) = default;
+    AnomalyReport& operator=(AnomalyReport&&) = default;
 };
 
 } // namespace anomaly
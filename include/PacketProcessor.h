@@ -2,6 +2,7 @@
 #include "Packet.h"
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <functional>
 
@@ -23,9 +24,23 @@ public:
     // Parse raw packet data into Packet struct
     Packet parsePacket(const std::string& raw_data) const;
 
+    // Allocation-free parse of one record in parsePacket's format into out,
+    // reusing its string storage (IPv4 addresses fit in the small-string
+    // buffer). Stricter than parsePacket: both addresses must pass
+    // isValidIP, every number must be well formed, nothing may trail the
+    // record, size must be non-zero and latency non-negative. A trailing newline is ignored. False on error, with out
+    // left partly written. Not counted in the parse metrics.
+    bool parseInto(std::string_view raw, Packet& out) const;
+
+    // Inverse of parsePacket; the timestamp field is written only when set
+    std::string formatPacket(const Packet& packet) const;
+
     // Validate packet fields
     bool isValidPacket(const Packet& packet) const;
 
+    // Dotted-quad IPv4 check used by isValidPacket
+    bool isValidIP(std::string_view ip) const;
+
     // Protocol detection from port number
     Protocol detectProtocol(uint16_t port) const;
 
@@ -37,7 +52,7 @@ public:
 
 private:
     std::vector<PacketCallback> callbacks_;
-    bool isValidIP(const std::string& ip) const;
+    Packet parseFields(const std::string& raw_data) const;
 };
 
 } // namespace anomaly
@@ -0,0 +1,76 @@
+#pragma once
+#include "Packet.h"
+#include "IpAddress.h"
+#include <cstdint>
+#include <cstring>
+
+namespace anomaly {
+
+// Fixed-size binary packet record, shared by trace files and other
+// binary packet transports. Native endianness; IPv4 addresses only.
+//
+//   File:   FileHeader (16 bytes) then PacketRecord[...] to end of file
+//   Header: magic "5GPKT1\0\0", uint32 version, uint32 record_size
+//   Record: int64 ts_ns, f64 latency_ms, u32 src_addr, u32 dst_addr,
+//           u32 size_bytes, u16 src_port, u16 dst_port, u8 protocol,
+//           3 reserved bytes (zero), u32 teid (0 = none; zero in traces
+//           written before it was added)
+namespace trace {
+constexpr char kMagic[8]    = {'5', 'G', 'P', 'K', 'T', '1', '\0', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+};
+
+struct PacketRecord {
+    int64_t ts_ns;        // 0 = no timestamp
+    double latency_ms;
+    uint32_t src_addr;    // IPv4, host order
+    uint32_t dst_addr;
+    uint32_t size_bytes;
+    uint16_t src_port;
+    uint16_t dst_port;
+    uint8_t protocol;     // Protocol
+    uint8_t reserved[3];
+    uint32_t teid;        // GTP-U tunnel endpoint id
+};
+
+static_assert(sizeof(FileHeader) == 16, "FileHeader layout");
+static_assert(sizeof(PacketRecord) == 40, "PacketRecord layout");
+
+// False if either address is not dotted-quad IPv4
+inline bool encodeRecord(const Packet& p, PacketRecord& r) {
+    std::memset(&r, 0, sizeof(r));
+    if (!parseIPv4(p.src_ip, r.src_addr) || !parseIPv4(p.dst_ip, r.dst_addr)) {
+        return false;
+    }
+    r.ts_ns      = hasTimestamp(p.timestamp) ? toNanos(p.timestamp) : 0;
+    r.latency_ms = p.latency_ms;
+    r.size_bytes = p.size_bytes;
+    r.src_port   = p.src_port;
+    r.dst_port   = p.dst_port;
+    r.protocol   = static_cast<uint8_t>(p.protocol);
+    r.teid       = p.teid;
+    return true;
+}
+
+inline void decodeRecord(const PacketRecord& r, Packet& p) {
+    char buf[16];
+    p.src_ip.assign(buf, formatIPv4(r.src_addr, buf));
+    p.dst_ip.assign(buf, formatIPv4(r.dst_addr, buf));
+    p.src_port   = r.src_port;
+    p.dst_port   = r.dst_port;
+    p.protocol   = r.protocol <= static_cast<uint8_t>(Protocol::UNKNOWN)
+                       ? static_cast<Protocol>(r.protocol)
+                       : Protocol::UNKNOWN;
+    p.size_bytes = r.size_bytes;
+    p.teid       = r.teid;
+    p.latency_ms = r.latency_ms;
+    p.timestamp  = r.ts_ns ? fromNanos(r.ts_ns) : TimePoint{};
+}
+} // namespace trace
+
+} // namespace anomaly
@@ -0,0 +1,166 @@
+#pragma once
+#include "PacketRecord.h"
+#include "SharedMemory.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace anomaly {
+
+class NetworkMonitor;
+
+// Single-producer single-consumer shared-memory ring of PacketRecords, for
+// an external capture process (AF_PACKET, XDP, ...) handing packets to the
+// engine without sockets or text.
+//
+// Layout (native endianness, all offsets from the start of the region):
+//
+//   0    RingHeader    magic "5GPRNG1\0", uint32 version, uint32 record_size
+//                      (40), uint64 capacity (power of two); then on its own
+//                      cache line the producer's atomic uint64 write_seq and
+//                      atomic uint64 dropped; then on another the consumer's
+//                      atomic uint64 read_seq
+//   256  PacketRecord[capacity]   (see PacketRecord.h)
+//
+// Record s lives in slot s % capacity. The producer writes slots
+// [write_seq, read_seq + capacity) and then publishes them with a release
+// store of write_seq; the consumer reads [read_seq, write_seq) in place and
+// frees them with a release store of read_seq. Each side caches the
+// other's index and rereads it only when the ring looks full (producer) or
+// empty (consumer), so in steady state each batch costs one shared-line
+// read and one write per side, and no syscalls.
+//
+// The engine creates the ring (PacketRingConsumer::create) and the capture
+// process attaches (PacketRingProducer::open). Only one producer may be
+// attached at a time.
+namespace ring {
+constexpr char kMagic[8]    = {'5', 'G', 'P', 'R', 'N', 'G', '1', '\0'};
+constexpr uint32_t kVersion = 1;
+
+struct RingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t capacity;
+    alignas(64) std::atomic<uint64_t> write_seq;
+    std::atomic<uint64_t> dropped;   // records the producer discarded on a full ring
+    alignas(64) std::atomic<uint64_t> read_seq;
+};
+
+constexpr size_t kRecordsOffset = 256;
+
+static_assert(sizeof(RingHeader) <= kRecordsOffset, "RingHeader layout");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "shared-memory atomics must be lock-free");
+} // namespace ring
+
+class PacketRingProducer {
+public:
+    // nullptr if the ring does not exist or has a different layout
+    static std::unique_ptr<PacketRingProducer> open(const std::string& name);
+
+    // Copy records in and publish them together; returns how many fit
+    // (fewer than count when the ring is full). Never blocks.
+    size_t tryPush(const trace::PacketRecord* records, size_t count);
+    bool tryPush(const trace::PacketRecord& record) { return tryPush(&record, 1) == 1; }
+
+    // Report records the producer gave up on, for the consumer's stats
+    void countDropped(uint64_t n);
+
+    // Records published to the ring by any producer since it was created
+    uint64_t published() const { return write_seq_; }
+
+private:
+    explicit PacketRingProducer(std::unique_ptr<SharedMemoryRegion> region);
+
+    std::unique_ptr<SharedMemoryRegion> region_;
+    ring::RingHeader* header_;
+    trace::PacketRecord* records_;
+    uint64_t capacity_;
+    uint64_t write_seq_;
+    uint64_t cached_read_;
+};
+
+class PacketRingConsumer {
+public:
+    // Create (or replace) the ring; nullptr on failure. Capacity rounds up
+    // to a power of two.
+    static std::unique_ptr<PacketRingConsumer> create(const std::string& name,
+                                                      size_t capacity = 65536);
+
+    // Zero-copy read: point first at up to max published records, all
+    // contiguous in the ring (so fewer at the wrap point), and return how
+    // many. They stay valid until release().
+    size_t peek(const trace::PacketRecord*& first, size_t max);
+
+    // Hand the first n peeked slots back to the producer
+    void release(size_t n);
+
+    uint64_t consumed() const { return read_seq_; }
+    uint64_t dropped() const;   // as reported by the producer
+    size_t capacity() const { return static_cast<size_t>(capacity_); }
+    const std::string& name() const { return region_->name(); }
+
+private:
+    explicit PacketRingConsumer(std::unique_ptr<SharedMemoryRegion> region);
+
+    std::unique_ptr<SharedMemoryRegion> region_;
+    ring::RingHeader* header_;
+    const trace::PacketRecord* records_;
+    uint64_t capacity_;
+    uint64_t read_seq_{0};
+    uint64_t cached_write_{0};
+};
+
+struct RingIngestConfig {
+    size_t batch_size{256};   // records per feedBatch
+    int idle_spins{2000};     // empty polls before sleeping
+    uint32_t idle_sleep_us{50};
+    int cpu{-1};              // pin the drain thread; -1 = unpinned
+};
+
+struct RingIngestStats {
+    uint64_t records{0};    // decoded and offered to the monitor
+    uint64_t accepted{0};
+    uint64_t batches{0};
+    uint64_t dropped{0};    // producer-side drops on a full ring
+};
+
+// Drains a PacketRingConsumer into a NetworkMonitor on its own thread:
+// records are decoded straight from the ring into a reused batch and
+// handed to feedBatch. While records keep arriving the thread only spins
+// between polls; it sleeps (idle_sleep_us) only after idle_spins empty
+// polls.
+class PacketRingIngest {
+public:
+    PacketRingIngest(std::unique_ptr<PacketRingConsumer> consumer, NetworkMonitor& monitor,
+                     RingIngestConfig config = RingIngestConfig{});
+    ~PacketRingIngest();
+
+    PacketRingIngest(const PacketRingIngest&) = delete;
+    PacketRingIngest& operator=(const PacketRingIngest&) = delete;
+
+    void start();
+    // Stop after draining what is already published
+    void stop();
+
+    RingIngestStats stats() const;
+
+private:
+    std::unique_ptr<PacketRingConsumer> consumer_;
+    NetworkMonitor& monitor_;
+    RingIngestConfig config_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::atomic<uint64_t> records_{0};
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> batches_{0};
+
+    void run();
+    // Decode and feed one batch; returns how many records it took
+    size_t drainOnce(std::vector<Packet>& batch);
+};
+
+} // namespace anomaly
@@ -0,0 +1,213 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace anomaly {
+
+constexpr size_t kCacheLine = 64;
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Bounded lock-free queue (Vyukov). Each cell carries a sequence number
+// that tells producers and consumers whose turn it is, so neither side
+// takes a lock. Safe for any number of producers and consumers; producers
+// may also pop, which is how DROP_OLDEST makes room.
+// Capacity is rounded up to a power of two.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity)
+        : mask_(roundUp(capacity) - 1)
+        , cells_(new Cell[mask_ + 1]) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // False if the queue is full; value is left untouched in that case
+    bool tryPush(T&& value) {
+        Cell* cell;
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Claim up to n consecutive slots with a single CAS and fill them with
+    // take(0) .. take(k-1). Returns k, which is short when the queue fills.
+    template <typename Take>
+    size_t tryPushBulk(size_t n, Take&& take) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        size_t k;
+        for (;;) {
+            // Slots are free when their sequence equals their ticket
+            k = 0;
+            while (k < n &&
+                   cells_[(pos + k) & mask_].seq.load(std::memory_order_acquire) ==
+                       pos + k) {
+                ++k;
+            }
+            if (k == 0) {
+                size_t seq = cells_[pos & mask_].seq.load(std::memory_order_acquire);
+                if (static_cast<std::ptrdiff_t>(seq - pos) < 0) return 0;  // full
+                pos = tail_.load(std::memory_order_relaxed);  // lost a race
+                continue;
+            }
+            if (tail_.compare_exchange_weak(pos, pos + k,
+                                            std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        for (size_t i = 0; i < k; ++i) {
+            Cell& cell = cells_[(pos + i) & mask_];
+            cell.value = take(i);
+            cell.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        return k;
+    }
+
+    // False if the queue is empty
+    bool tryPop(T& out) {
+        Cell* cell;
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(pos, pos + 1,
+                                                std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate under concurrent use
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    static size_t roundUp(size_t n) {
+        size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    // Producer and consumer indices on separate cache lines
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+};
+
+// Spin-then-park wait. Waiters spin briefly, then yield, then block on a
+// condition variable; notify() is a fence and a load unless someone is
+// actually parked, so producers do not pay a syscall per item.
+class Parker {
+public:
+    template <typename Ready>
+    void wait(Ready ready, int spins = 1000) {
+        for (int i = 0; i < spins; ++i) {
+            if (ready()) return;
+            cpuRelax();
+        }
+        for (int i = 0; i < 16; ++i) {
+            if (ready()) return;
+            std::this_thread::yield();
+        }
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait(lock, ready);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    // Same, but give up at deadline; returns whether ready() became true.
+    // No yield phase: the caller chose to wait, so it blocks after the spins.
+    template <typename Ready, typename Clock, typename Duration>
+    bool waitUntil(Ready ready, std::chrono::time_point<Clock, Duration> deadline,
+                   int spins = 1000) {
+        for (int i = 0; i < spins; ++i) {
+            if (ready()) return true;
+            cpuRelax();
+        }
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool result;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            result = cv_.wait_until(lock, deadline, ready);
+        }
+        waiters_.fetch_sub(1, std::memory_order_relaxed);
+        return result;
+    }
+
+    // Call after making ready() true
+    void notify() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(mtx_);
+            cv_.notify_all();
+        }
+    }
+
+private:
+    std::atomic<int> waiters_{0};
+    std::mutex mtx_;
+    std::condition_variable cv_;
+};
+
+} // namespace anomaly
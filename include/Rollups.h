@@ -0,0 +1,258 @@
+#pragma once
+#include "Packet.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace anomaly {
+
+class NetworkMonitor;
+
+// Per-second traffic rollups, overall and per key, in an append-only
+// time-series file of fixed-width records plus a sparse index, both
+// little-endian and mappable as arrays:
+//
+//   data file    FileHeader (32 bytes), then Record[...] (56 bytes each)
+//   <path>.idx   IndexHeader (16 bytes), then IndexEntry[...] (16 bytes each)
+//
+// Records are sorted by second; within a second the overall row
+// (kind NONE) comes first, then one row per key in ascending key order.
+// An index entry is written for the first second in every index_every_sec
+// span and points at that second's first record, so a range query is a
+// binary search over the index, then over at most one span of records.
+namespace rollup {
+constexpr char kFileMagic[4]  = {'5', 'G', 'R', 'U'};
+constexpr char kIndexMagic[4] = {'5', 'G', 'R', 'I'};
+constexpr uint32_t kVersion   = 1;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t key_kind;         // RollupKey of the keyed rows
+    uint32_t index_every_sec;
+    uint32_t reserved[3];
+};
+
+struct Record {
+    int64_t second;            // event time, s since the Unix epoch
+    uint64_t packets;
+    uint64_t bytes;
+    uint32_t key;              // see RollupKey; 0 on the overall row
+    uint32_t sources;          // distinct source addresses (estimated)
+    float latency_min_ms;
+    float latency_mean_ms;
+    float latency_p99_ms;      // within 1/8 of the true value
+    float latency_max_ms;
+    uint8_t kind;              // RollupKey::NONE on the overall row
+    uint8_t reserved[7];
+};
+
+struct IndexHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t reserved;
+};
+
+struct IndexEntry {
+    int64_t second;
+    uint64_t record;           // index of that second's first record
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout");
+static_assert(sizeof(Record) == 56, "Record layout");
+static_assert(sizeof(IndexHeader) == 16, "IndexHeader layout");
+static_assert(sizeof(IndexEntry) == 16, "IndexEntry layout");
+} // namespace rollup
+
+// What the keyed rows are grouped by
+enum class RollupKey : uint8_t {
+    NONE,         // overall rows only
+    SOURCE,       // IPv4 source address, host order
+    DESTINATION,  // IPv4 destination address, host order
+    DST_PORT,
+    PROTOCOL,     // Protocol value
+    TEID          // GTP-U tunnel id
+};
+
+struct RollupConfig {
+    RollupKey key{RollupKey::DST_PORT};
+    uint32_t max_keys{10000};        // keyed rows per second; the rest count only overall
+    uint32_t flush_lag_sec{2};       // keep a second open this long past the newest event
+    uint32_t index_every_sec{60};
+};
+
+struct RollupStats {
+    uint64_t seconds{0};       // seconds written
+    uint64_t records{0};       // rows written
+    uint64_t packets{0};
+    uint64_t late{0};          // packets for seconds already written, not counted
+    uint64_t key_overflow{0};  // packets past max_keys, in the overall row only
+};
+
+// Appends records and index entries; a file with a matching header is
+// continued (a trailing partial record from a crash is cut off), anything
+// else is replaced.
+class RollupWriter {
+public:
+    RollupWriter(std::string path, RollupKey key, uint32_t index_every_sec);
+    ~RollupWriter();
+
+    RollupWriter(const RollupWriter&) = delete;
+    RollupWriter& operator=(const RollupWriter&) = delete;
+
+    bool isOpen() const { return file_ != nullptr && index_ != nullptr; }
+
+    // Append one second's records (second ascending across calls)
+    void append(const rollup::Record* records, size_t count);
+    void flush();
+
+    // Last second in the file, INT64_MIN if empty
+    int64_t lastSecond() const { return last_second_; }
+    uint64_t records() const { return records_; }
+
+private:
+    std::string path_;
+    uint32_t index_every_sec_;
+    std::FILE* file_{nullptr};
+    std::FILE* index_{nullptr};
+    uint64_t records_{0};
+    int64_t last_second_;
+    int64_t next_index_second_;
+
+    bool openExisting(RollupKey key);
+    void create(RollupKey key);
+};
+
+// Aggregates analyzed packets by event-time second and writes each second
+// once it is flush_lag_sec behind the newest event seen. Attach before the
+// monitor starts; observe() may be called from several workers at once.
+// Each calling thread accumulates into its own lane (kLanes of them, each
+// with its own lock), so workers do not contend; a second's lanes are
+// merged when it closes.
+class TrafficRollups {
+public:
+    TrafficRollups(const std::string& path, RollupConfig config = RollupConfig{});
+    ~TrafficRollups();
+
+    TrafficRollups(const TrafficRollups&) = delete;
+    TrafficRollups& operator=(const TrafficRollups&) = delete;
+
+    bool isOpen() const { return writer_.isOpen(); }
+
+    // Register observe() as a batch callback
+    void attach(NetworkMonitor& monitor);
+
+    void observe(const std::vector<Packet>& batch);
+
+    // Write every open second, e.g. after the monitor has stopped
+    void flush();
+
+    RollupStats stats() const;
+
+private:
+    static constexpr size_t kLatencyBuckets = 208;
+    static constexpr size_t kSourceRegisters = 256;
+    static constexpr size_t kLanes = 16;
+
+    struct Acc {
+        uint64_t packets{0};
+        uint64_t bytes{0};
+        double latency_sum{0.0};
+        double latency_min{0.0};
+        double latency_max{0.0};
+        std::array<uint32_t, kLatencyBuckets> latency{};  // log-linear, microseconds
+        std::array<uint8_t, kSourceRegisters> sources{};  // HyperLogLog registers
+
+        void add(const Packet& p, uint64_t source_hash);
+        void merge(const Acc& other);
+        rollup::Record toRecord(int64_t second, RollupKey kind, uint32_t key) const;
+    };
+
+    struct Second {
+        Acc overall;
+        std::unordered_map<uint32_t, Acc> keys;
+    };
+
+    using OpenSeconds = std::map<int64_t, std::unique_ptr<Second>>;
+
+    // One thread's share of the open seconds
+    struct alignas(64) Lane {
+        mutable std::mutex mtx;
+        OpenSeconds open;
+        uint64_t packets{0};
+        uint64_t late{0};
+        uint64_t key_overflow{0};
+    };
+
+    RollupConfig config_;
+    std::array<Lane, kLanes> lanes_;
+    std::atomic<int64_t> newest_;
+    std::atomic<int64_t> written_through_;  // seconds up to here are on disk
+
+    // Closing seconds: the writer and what only the closer updates
+    mutable std::mutex close_mtx_;
+    RollupWriter writer_;
+    RollupStats written_;  // seconds, records, key_overflow found while merging
+    std::vector<rollup::Record> scratch_;
+
+    uint32_t keyOf(const Packet& p) const;
+    void writeLocked(int64_t second, const Second& s);
+    void mergeInto(Second& into, const Second& from);
+    void closeThroughLocked(int64_t second);
+};
+
+// Read-only view of a rollup file (and its index), mapped at open time;
+// records appended later need a new reader.
+class RollupReader {
+public:
+    // nullptr if the file is missing or not a rollup file
+    static std::unique_ptr<RollupReader> open(const std::string& path);
+    ~RollupReader();
+
+    RollupReader(const RollupReader&) = delete;
+    RollupReader& operator=(const RollupReader&) = delete;
+
+    RollupKey keyKind() const { return key_kind_; }
+    size_t size() const { return count_; }
+    const rollup::Record* records() const { return records_; }
+
+    // Every record with second in [from, to], contiguous: sets first and
+    // returns the count
+    size_t range(int64_t from, int64_t to, const rollup::Record*& first) const;
+
+    // One row per second in [from, to]: the overall row (kind NONE) or
+    // the row for key, where present
+    std::vector<rollup::Record> series(int64_t from, int64_t to,
+                                       RollupKey kind = RollupKey::NONE,
+                                       uint32_t key = 0) const;
+
+private:
+    RollupReader() = default;
+
+    struct Mapping {
+        void* data{nullptr};
+        size_t size{0};
+    };
+    Mapping data_;
+    Mapping index_;
+    RollupKey key_kind_{RollupKey::NONE};
+    const rollup::Record* records_{nullptr};
+    size_t count_{0};
+    const rollup::IndexEntry* entries_{nullptr};
+    size_t entry_count_{0};
+
+    // First record with second >= s
+    size_t lowerBound(int64_t s) const;
+    static Mapping map(const std::string& path);
+    static void unmap(Mapping& m);
+};
+
+} // namespace anomaly
@@ -0,0 +1,38 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <cstddef>
+
+namespace anomaly {
+
+// RAII wrapper around a named POSIX shared-memory object (shm_open + mmap).
+// The creator unlinks the name on destruction; openers only unmap.
+class SharedMemoryRegion {
+public:
+    // Create (or replace) a zero-filled region; nullptr on failure
+    static std::unique_ptr<SharedMemoryRegion> create(const std::string& name,
+                                                      size_t size);
+
+    // Map an existing region; its size is taken from the object
+    static std::unique_ptr<SharedMemoryRegion> open(const std::string& name,
+                                                    bool writable = false);
+
+    ~SharedMemoryRegion();
+
+    SharedMemoryRegion(const SharedMemoryRegion&) = delete;
+    SharedMemoryRegion& operator=(const SharedMemoryRegion&) = delete;
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    const std::string& name() const { return name_; }
+
+private:
+    SharedMemoryRegion(std::string name, void* data, size_t size, bool owner);
+
+    std::string name_;
+    void* data_;
+    size_t size_;
+    bool owner_;
+};
+
+} // namespace anomaly
@@ -0,0 +1,57 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace anomaly {
+
+// Maps source addresses to dense 32-bit IDs so per-source state can live in
+// plain arrays indexed by ID. IPv4 addresses are keyed by their packed value
+// in a flat open-addressing table (no string hashing, no node chasing);
+// anything else falls back to a string-keyed map. Released IDs are recycled
+// before new ones are handed out.
+class SourceInterner {
+public:
+    static constexpr uint32_t kInvalidId = UINT32_MAX;
+
+    // Return the ID for addr, allocating one on first sight
+    uint32_t intern(const std::string& addr);
+
+    // Return the ID for addr, or kInvalidId if it is not interned
+    uint32_t find(const std::string& addr) const;
+
+    // Forget the address behind id so the ID can be reused
+    void release(uint32_t id);
+
+    // Address behind a live ID
+    const std::string& keyOf(uint32_t id) const { return keys_[id]; }
+
+    // Number of live IDs
+    size_t size() const { return keys_.size() - free_ids_.size(); }
+
+    // One past the highest ID ever handed out (size of ID-indexed arrays)
+    size_t capacity() const { return keys_.size(); }
+
+    void clear();
+
+private:
+    struct Slot {
+        uint32_t addr{0};
+        uint32_t id{kEmpty};
+    };
+    static constexpr uint32_t kEmpty     = UINT32_MAX;
+    static constexpr uint32_t kTombstone = UINT32_MAX - 1;
+
+    std::vector<Slot> ipv4_slots_;   // packed addr -> id, linear probing
+    size_t ipv4_used_{0};            // live + tombstone slots
+    std::unordered_map<std::string, uint32_t> other_ids_;  // addr -> id
+    std::vector<std::string> keys_;                        // id -> addr
+    std::vector<uint32_t> free_ids_;
+
+    uint32_t allocate(const std::string& addr);
+    size_t probeStart(uint32_t addr) const;
+    void growIPv4();
+};
+
+} // namespace anomaly
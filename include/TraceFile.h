@@ -0,0 +1,74 @@
+#pragma once
+#include "Packet.h"
+#include "PacketProcessor.h"
+#include "PacketRecord.h"
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace anomaly {
+
+// Appends packets to a binary trace (see PacketRecord.h). Thread-safe, so
+// it can be registered as a NetworkMonitor::onBatch tap with several
+// workers. Packets with non-IPv4 addresses are counted and skipped.
+class TraceWriter {
+public:
+    explicit TraceWriter(const std::string& path);
+    ~TraceWriter();  // flushes and closes
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool isOpen() const { return file_ != nullptr; }
+
+    void write(const Packet& packet);
+    void write(const std::vector<Packet>& packets);
+    void flush();
+
+    uint64_t written() const;
+    uint64_t skipped() const;
+
+private:
+    std::FILE* file_{nullptr};
+    std::vector<trace::PacketRecord> buffer_;
+    uint64_t written_{0};
+    uint64_t skipped_{0};
+    mutable std::mutex mtx_;
+
+    void appendLocked(const Packet& packet);
+    void flushLocked();
+};
+
+// Reads a recorded trace in either format: a binary trace (detected by its
+// magic) or text, one parsePacket line per packet with an optional
+// trailing timestamp. Blank lines and '#' comments are ignored; lines that
+// do not parse are counted and skipped.
+class TraceReader {
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool isOpen() const { return file_ != nullptr; }
+    bool isBinary() const { return binary_; }
+
+    // Next packet; false at end of trace
+    bool next(Packet& out);
+
+    // Append up to max packets; returns how many were read
+    size_t next(std::vector<Packet>& out, size_t max);
+
+    uint64_t skipped() const { return skipped_; }
+
+private:
+    std::FILE* file_{nullptr};
+    bool binary_{false};
+    uint64_t skipped_{0};
+    PacketProcessor processor_;
+    std::string line_;
+};
+
+} // namespace anomaly
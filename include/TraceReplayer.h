@@ -0,0 +1,52 @@
+#pragma once
+#include "Packet.h"
+#include <atomic>
+#include <cstdint>
+
+namespace anomaly {
+
+class NetworkMonitor;
+class TraceReader;
+
+struct ReplayConfig {
+    double speed{1.0};             // trace seconds per wall second; 0 = as fast as possible
+    size_t batch_size{256};        // max packets per feedBatch
+    uint32_t batch_window_us{200}; // packets due this close together go in one batch
+    uint32_t spin_us{100};         // busy-wait the last stretch before a deadline
+};
+
+struct ReplayStats {
+    uint64_t packets{0};       // read from the trace and offered
+    uint64_t accepted{0};      // taken by the monitor
+    uint64_t skipped{0};       // unreadable trace lines
+    double seconds{0.0};       // wall-clock replay time
+    double trace_seconds{0.0}; // first to last timestamp in the trace
+    double target_pps{0.0};    // rate the speed asks for, 0 = unbounded
+    double achieved_pps{0.0};
+    double max_lag_us{0.0};    // how late a batch went out vs its due time
+    double mean_lag_us{0.0};
+};
+
+// Feeds a recorded trace into a running monitor with its original pacing,
+// scaled by speed. Packets keep their recorded timestamps, so detection
+// sees the same event time whatever the speed. Deadlines are met by
+// sleeping until spin_us before each batch is due and spinning the rest,
+// and packets due within batch_window_us of each other share one
+// feedBatch call, so pacing cost stays per batch rather than per packet.
+// Packets without a timestamp are sent with the previous one.
+class TraceReplayer {
+public:
+    explicit TraceReplayer(ReplayConfig config = ReplayConfig{});
+
+    // Replay to the end of the trace (or until stop())
+    ReplayStats run(TraceReader& reader, NetworkMonitor& monitor);
+
+    // End a run early; safe from any thread
+    void stop() { stopping_.store(true); }
+
+private:
+    ReplayConfig config_;
+    std::atomic<bool> stopping_{false};
+};
+
+} // namespace anomaly
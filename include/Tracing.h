@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace anomaly {
+namespace tracing {
+
+// Pipeline stages a sampled packet is stamped at, in order
+enum class Stage : uint8_t {
+    INGEST,           // handed to NetworkMonitor::feedPacket/feedBatch
+    ENQUEUE,          // in a worker queue
+    DEQUEUE,          // drained by a worker
+    ANALYZE_START,    // before the detector shard lock
+    ANALYZE_END,
+    ALERT_RAISED,     // report handed to AlertManager (before its lock)
+    ALERT_PERSISTED   // log line written by the AlertLogWriter thread
+};
+
+const char* stageName(Stage stage);
+
+struct TracerConfig {
+    uint32_t sample_every{0};           // trace 1 in N ingested packets, 0 = off
+    size_t records_per_thread{65536};   // per-thread buffer; later records are dropped
+};
+
+struct TraceStats {
+    uint64_t sampled{0};   // trace ids handed out
+    uint64_t records{0};
+    uint64_t dropped{0};   // records lost to full buffers (or stamped while a thread exits)
+    size_t threads{0};     // threads that have stamped
+    size_t buffers{0};     // allocated; an exited thread's buffer is reused
+};
+
+// Process-wide sampled tracer. Each thread appends fixed-size records to
+// its own buffer with plain stores and one release store of its count, so
+// stamping never takes a lock and never shares a cache line with another
+// thread. A buffer outlives its thread (its records still show up in the
+// trace) and is handed to the next new thread, which appends after them
+// while it has room, so short-lived threads do not each hold a buffer.
+// With tracing off, sample() is one relaxed load and record() one branch
+// on a zero trace id.
+void configure(const TracerConfig& config);
+
+extern std::atomic<uint32_t> g_sample_every;
+uint64_t sampleSlow();
+void recordSlow(uint64_t trace_id, Stage stage);
+
+inline bool active() {
+    return g_sample_every.load(std::memory_order_relaxed) != 0;
+}
+
+// A fresh trace id for one call in sample_every on this thread, else 0
+inline uint64_t sample() {
+    return active() ? sampleSlow() : 0;
+}
+
+// Stamp a stage for a traced packet; no-op for trace id 0
+inline void record(uint64_t trace_id, Stage stage) {
+    if (trace_id != 0) recordSlow(trace_id, stage);
+}
+
+TraceStats stats();
+
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev): an instant
+// event per stage on the thread that stamped it, plus one async track per
+// traced packet with a span for each stage-to-stage interval. Call while
+// the pipeline is idle or stopped to get every packet's complete path;
+// records written during the dump may be missing. False on I/O error.
+bool writeChromeTrace(const std::string& path);
+
+// Discard all records (buffers stay registered). Not safe while stamping.
+void clear();
+
+} // namespace tracing
+} // namespace anomaly
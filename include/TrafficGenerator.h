@@ -0,0 +1,172 @@
+#pragma once
+#include "Packet.h"
+#include "AlertStore.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace anomaly {
+
+class NetworkMonitor;
+
+enum class AttackKind { FLOOD, DISTRIBUTED_FLOOD, SCAN, LATENCY_SPIKE };
+
+const char* attackKindName(AttackKind kind);
+
+// An attack injected on top of the background traffic, in event time
+struct AttackScenario {
+    AttackKind kind{AttackKind::FLOOD};
+    double start_sec{0.0};     // offset from TrafficConfig::start
+    double duration_sec{10.0};
+    double rate_pps{1000.0};   // attack packets per second, all attackers together
+    uint32_t attackers{1};     // distinct sources (DISTRIBUTED_FLOOD)
+    double latency_ms{500.0};  // background latency during a LATENCY_SPIKE
+};
+
+struct PortMix {
+    uint16_t port;
+    Protocol protocol;
+    double weight;
+};
+
+struct TrafficConfig {
+    uint64_t seed{42};
+    uint32_t sources{10000};           // background source cardinality
+    double zipf_skew{1.0};             // source popularity exponent, 0 = uniform
+    uint32_t source_base{0x0A000000};  // background sources are 10.0.0.0 + rank
+    double packets_per_sec{100000.0};  // background rate in event time
+    TimePoint start{std::chrono::seconds(1'700'000'000)};
+    double latency_median_ms{10.0};    // log-normal latency
+    double latency_sigma{0.5};
+    uint32_t min_size{64};
+    uint32_t max_size{1500};
+    std::vector<PortMix> ports{{443, Protocol::TCP, 0.6},
+                               {80, Protocol::TCP, 0.2},
+                               {53, Protocol::UDP, 0.1},
+                               {2152, Protocol::UDP, 0.1}};
+    std::vector<AttackScenario> attacks;
+};
+
+// What the detector should report for one scenario
+struct GroundTruthEvent {
+    AttackKind kind;
+    AnomalyType expected;
+    std::vector<std::string> sources;  // empty = any source (LATENCY_SPIKE)
+    TimePoint start;
+    TimePoint end;
+    uint64_t packets;                  // attack packets (or affected ones)
+};
+
+struct DetectionScore {
+    size_t events{0};
+    size_t detected{0};
+    double recall{0.0};
+    uint64_t alerts{0};
+    uint64_t unmatched_alerts{0};  // alerts explained by no scenario
+};
+
+struct DriveOptions {
+    double duration_sec{10.0};  // event time to generate
+    size_t threads{1};          // feeding threads, one generator stream each
+    double target_pps{0.0};     // wall-clock pacing across threads, 0 = flat out
+    size_t batch_size{1024};
+};
+
+struct DriveResult {
+    uint64_t offered{0};
+    uint64_t accepted{0};
+    double seconds{0.0};
+    double pps{0.0};  // offered packets per wall-clock second
+};
+
+// Deterministic synthetic 5G traffic. Every packet's fields are a pure
+// function of (seed, packet index), so the traffic is identical however
+// many streams generate it. Streams split it by source address, as RSS
+// would across NIC queues, so each source's packets come from exactly one
+// stream and in timestamp order. Sources are hashed into kLanes lanes and
+// a stream owns whole lanes; a fixed schedule maps each background packet
+// index to a lane, so a stream enumerates only its own packets and its cost
+// does not grow with the stream count. Up to kLanes streams get traffic.
+// Zipf and port choices use alias tables (O(1) per packet) shared by all
+// streams.
+class TrafficGenerator {
+public:
+    static constexpr uint32_t kLanes = 256;
+
+    explicit TrafficGenerator(TrafficConfig config);
+    ~TrafficGenerator();
+
+    // One of `count` disjoint, source-partitioned slices of the traffic up
+    // to duration_sec of event time, in timestamp order. Streams are
+    // independent and meant to be driven from separate threads.
+    class Stream {
+    public:
+        // Append up to max packets; returns 0 once the slice is exhausted
+        size_t next(std::vector<Packet>& out, size_t max);
+
+    private:
+        friend class TrafficGenerator;
+        Stream(const TrafficGenerator& gen, size_t index, size_t count,
+               double duration_sec);
+        bool ownsLane(uint32_t lane) const;
+
+        // The indices of one packet sequence this stream owns, ascending:
+        // base + residue for each owned residue, base stepping by period
+        struct Cursor {
+            std::vector<uint32_t> residues;  // sorted, < period
+            uint64_t period{1};
+            uint64_t end{0};                 // first index past the slice
+            uint64_t base{0};
+            size_t pos{0};
+
+            bool done() const { return residues.empty() || index() >= end; }
+            uint64_t index() const { return base + residues[pos]; }
+            void advance();
+        };
+
+        const TrafficGenerator* gen_;
+        uint64_t index_;
+        uint64_t count_;
+        Cursor background_;
+        std::vector<Cursor> attacks_;  // per scenario
+    };
+
+    Stream stream(size_t index, size_t count, double duration_sec) const;
+
+    // Expected detections for the configured scenarios
+    std::vector<GroundTruthEvent> groundTruth() const;
+
+    // Match alerts against ground truth: an event counts as detected when
+    // an alert of its expected type from one of its sources falls inside
+    // [start, end + slack]
+    static DetectionScore score(const std::vector<GroundTruthEvent>& truth,
+                                const AlertSnapshot& alerts,
+                                std::chrono::seconds slack = std::chrono::seconds(10));
+
+    const TrafficConfig& config() const { return config_; }
+
+private:
+    struct AliasTable;
+    struct Lanes;
+
+    TrafficConfig config_;
+    std::unique_ptr<Lanes> lanes_;
+    std::unique_ptr<AliasTable> port_table_;
+
+    static uint32_t laneOf(uint32_t addr);
+    uint32_t attackSource(size_t scenario, uint64_t j) const;
+    Packet background(uint64_t n) const;
+    Packet attack(size_t scenario, uint64_t j) const;
+    double backgroundTime(uint64_t n) const;
+    double attackTime(size_t scenario, uint64_t j) const;
+    uint64_t attackCount(size_t scenario) const;
+    uint32_t attackerAddr(size_t scenario, uint32_t attacker) const;
+};
+
+// Feed options.duration_sec of generated traffic into a running monitor
+// from options.threads threads, paced to target_pps when set
+DriveResult driveMonitor(NetworkMonitor& monitor, const TrafficGenerator& generator,
+                         const DriveOptions& options);
+
+} // namespace anomaly
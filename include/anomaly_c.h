@@ -0,0 +1,101 @@
+#pragma once
+/*
+ * C ABI for batch analysis with AnomalyDetector, built as the shared
+ * library libanomaly_c (see python/anomaly_c.py for a ctypes binding).
+ *
+ * Packets go in as columns: parallel arrays of count entries, read in
+ * place. Anomalies come back the same way, in caller-provided arrays.
+ * Only the functions and structs below are exported; their layout is
+ * fixed for a given ANOMALY_C_ABI_VERSION.
+ *
+ * A detector keeps per-source state across calls, so a history can be
+ * fed in time-ordered chunks. Calls on one handle must not overlap;
+ * separate handles are independent.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define ANOMALY_C_API __declspec(dllexport)
+#else
+#define ANOMALY_C_API __attribute__((visibility("default")))
+#endif
+
+#define ANOMALY_C_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Protocol column values (Packet.h's Protocol) */
+enum { ANOMALY_PROTO_TCP = 0, ANOMALY_PROTO_UDP = 1, ANOMALY_PROTO_ICMP = 2,
+       ANOMALY_PROTO_UNKNOWN = 3 };
+
+/* Result type values (Packet.h's AnomalyType) */
+enum { ANOMALY_NONE = 0, ANOMALY_HIGH_LATENCY = 1, ANOMALY_PACKET_LOSS = 2,
+       ANOMALY_FLOOD = 3, ANOMALY_UNKNOWN_PROTOCOL = 4 };
+
+typedef struct anomaly_config {
+    double max_latency_ms;
+    uint32_t flood_threshold;
+    double packet_loss_threshold;
+    uint32_t window_size_sec;
+    uint32_t source_idle_sec;
+} anomaly_config;
+
+/* Input columns. src_addr, latency_ms and count are required; any other
+ * column may be NULL (dst_addr 0.0.0.0, ports 0, protocol TCP, size 0,
+ * timestamps unset: the detector's event-time watermark is used). */
+typedef struct anomaly_batch {
+    size_t count;
+    const uint32_t* src_addr;      /* IPv4, host byte order */
+    const uint32_t* dst_addr;
+    const uint16_t* src_port;
+    const uint16_t* dst_port;
+    const uint8_t* protocol;       /* ANOMALY_PROTO_* */
+    const uint32_t* size_bytes;
+    const double* latency_ms;
+    const int64_t* timestamp_ns;   /* event time, ns since the Unix epoch */
+} anomaly_batch;
+
+/* Output columns, capacity entries each. A row raises at most one
+ * anomaly, so capacity == batch count always suffices. */
+typedef struct anomaly_results {
+    size_t capacity;
+    uint64_t* row;                 /* index into the batch */
+    uint8_t* type;                 /* ANOMALY_* */
+    double* severity;              /* 0.0 - 1.0 */
+    int64_t* detected_ns;          /* event time of the row */
+    size_t overflow;               /* set by analyze: anomalies that did not fit */
+} anomaly_results;
+
+typedef struct anomaly_detector anomaly_detector;
+
+ANOMALY_C_API int anomaly_abi_version(void);
+
+/* Fill config with DetectorConfig's defaults */
+ANOMALY_C_API void anomaly_config_init(anomaly_config* config);
+
+/* NULL config = defaults. Returns NULL on allocation failure. */
+ANOMALY_C_API anomaly_detector* anomaly_detector_create(const anomaly_config* config);
+ANOMALY_C_API void anomaly_detector_destroy(anomaly_detector* detector);
+
+/* Forget all per-source state */
+ANOMALY_C_API void anomaly_detector_reset(anomaly_detector* detector);
+
+/* Sources currently holding detector state */
+ANOMALY_C_API size_t anomaly_detector_sources(const anomaly_detector* detector);
+
+/* Analyze every row in order and write anomalies to out in row order.
+ * Returns how many were written, or -1 if a required pointer is NULL or
+ * memory ran out (rows analyzed before that have updated the state). */
+ANOMALY_C_API int64_t anomaly_detector_analyze(anomaly_detector* detector,
+                                               const anomaly_batch* batch,
+                                               anomaly_results* out);
+
+/* "HIGH_LATENCY", ...; "NONE" for unknown values */
+ANOMALY_C_API const char* anomaly_type_name(int type);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,12 +1,17 @@
 """
 5G Network Anomaly Detector - Python Analysis Layer
-Reads alerts.json generated by the C++ engine and produces visualizations.
+Reads alerts.json (or the incremental alerts.ndjson / binary alerts.col
+exports) generated by the C++ engine and produces visualizations.
 """
 
+import argparse
 import json
 import os
+import time
 from datetime import datetime
+from typing import Iterator
 from collections import Counter
+import numpy as np
 import matplotlib.pyplot as plt
 import matplotlib.patches as mpatches
 
@@ -17,10 +22,242 @@ def load_alerts(filepath: str = "alerts.json") -> list[dict]:
         print(f"[WARNING] {filepath} not found. Using sample data.")
         return generate_sample_data()
 
+    if filepath.endswith(".ndjson"):
+        return list(read_ndjson(filepath))
+
     with open(filepath, "r") as f:
         return json.load(f)
 
 
+def read_ndjson(filepath: str) -> Iterator[dict]:
+    """Stream alerts from an NDJSON export one line at a time."""
+    with open(filepath, "r") as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                yield json.loads(line)
+
+
+def follow_ndjson(filepath: str, poll_interval: float = 0.5) -> Iterator[dict]:
+    """Tail an NDJSON export like `tail -F`, surviving rotation.
+
+    Yields each alert once its full line has been written; when the engine
+    rotates the file the remainder of the old file is drained before
+    switching to the new one.
+    """
+    f, inode, partial = None, None, ""
+    while True:
+        if f is None:
+            try:
+                f = open(filepath, "r")
+                inode = os.fstat(f.fileno()).st_ino
+            except FileNotFoundError:
+                time.sleep(poll_interval)
+                continue
+
+        chunk = f.readline()
+        if chunk:
+            partial += chunk
+            if partial.endswith("\n"):
+                line, partial = partial.strip(), ""
+                if line:
+                    yield json.loads(line)
+            continue
+
+        try:
+            rotated = os.stat(filepath).st_ino != inode
+        except FileNotFoundError:
+            rotated = False
+        if rotated:
+            f.close()
+            f, partial = None, ""
+        else:
+            time.sleep(poll_interval)
+
+
+# Binary columnar export (see include/ColumnarExporter.h for the layout)
+LEVEL_NAMES = ["LOW", "MEDIUM", "HIGH", "CRITICAL"]
+TYPE_NAMES  = ["NONE", "HIGH_LATENCY", "PACKET_LOSS", "FLOOD", "UNKNOWN_PROTOCOL"]
+_FILE_HEADER  = np.dtype([("magic", "S4"), ("version", "<u4"), ("reserved", "<u8")])
+_BLOCK_HEADER = np.dtype([("magic", "S4"), ("rows", "<u4"), ("dict_entries", "<u4"),
+                          ("dict_bytes", "<u4"), ("first_seq", "<u8")])
+
+
+def _pad8(n: int) -> int:
+    return (n + 7) & ~7
+
+
+def read_columnar_blocks(filepath: str) -> Iterator[dict]:
+    """Yield each block of a columnar export as zero-copy numpy views.
+
+    Columns are views into a read-only memory map, so nothing is read from
+    disk until it is touched.
+    """
+    mm = np.memmap(filepath, dtype=np.uint8, mode="r")
+    header = mm[:_FILE_HEADER.itemsize].view(_FILE_HEADER)[0]
+    if header["magic"] != b"5GAC":
+        raise ValueError(f"{filepath}: not a columnar alert file")
+
+    pos = _FILE_HEADER.itemsize
+    while pos + _BLOCK_HEADER.itemsize <= len(mm):
+        block = mm[pos:pos + _BLOCK_HEADER.itemsize].view(_BLOCK_HEADER)[0]
+        if block["magic"] != b"BLK1":
+            raise ValueError(f"{filepath}: corrupt block at offset {pos}")
+        pos += _BLOCK_HEADER.itemsize
+        rows = int(block["rows"])
+
+        cols = {}
+        for name, dtype in (("ts_ns", "<i8"), ("severity", "<f8"),
+                            ("source_addr", "<u4"), ("message_id", "<u4"),
+                            ("level", "u1"), ("type", "u1")):
+            size = rows * np.dtype(dtype).itemsize
+            cols[name] = mm[pos:pos + size].view(dtype)
+            pos += _pad8(size)
+
+        entries = int(block["dict_entries"])
+        offsets = mm[pos:pos + 4 * (entries + 1)].view("<u4")
+        cols["dict_offsets"] = offsets
+        cols["dict_text"] = mm[pos + 4 * (entries + 1):pos + int(block["dict_bytes"])]
+        cols["first_seq"] = int(block["first_seq"])
+        pos += int(block["dict_bytes"])
+        yield cols
+
+
+def load_columnar(filepath: str) -> dict:
+    """Concatenate every block's numeric columns into flat numpy arrays."""
+    blocks = list(read_columnar_blocks(filepath))
+    names = ("ts_ns", "severity", "source_addr", "level", "type")
+    if not blocks:
+        return {name: np.empty(0) for name in names}
+    return {name: np.concatenate([b[name] for b in blocks]) for name in names}
+
+
+def block_messages(block: dict) -> list[str]:
+    """Decode one block's message dictionary."""
+    offsets, text = block["dict_offsets"], bytes(block["dict_text"])
+    return [text[offsets[i]:offsets[i + 1]].decode("utf-8")
+            for i in range(len(offsets) - 1)]
+
+
+def format_ipv4(addr) -> str:
+    addr = int(addr)
+    return f"{addr >> 24 & 255}.{addr >> 16 & 255}.{addr >> 8 & 255}.{addr & 255}"
+
+
+def analyze_columnar(cols: dict) -> dict:
+    """Same summary as analyze(), computed with vectorised numpy ops."""
+    if len(cols["severity"]) == 0:
+        return {}
+    level_counts = np.bincount(cols["level"], minlength=len(LEVEL_NAMES))
+    addrs, counts = np.unique(cols["source_addr"], return_counts=True)
+    top = np.argsort(counts)[::-1][:5]
+    return {
+        "total":         int(len(cols["severity"])),
+        "level_counts":  {LEVEL_NAMES[i]: int(c) for i, c in enumerate(level_counts) if c},
+        "avg_severity":  float(cols["severity"].mean()),
+        "max_severity":  float(cols["severity"].max()),
+        "top_offenders": [(format_ipv4(addrs[i]), int(counts[i])) for i in top],
+    }
+
+
+def columnar_sample(cols: dict, limit: int = 5000) -> list[dict]:
+    """Evenly spaced rows as alert dicts, for the per-alert plots."""
+    n = len(cols["severity"])
+    idx = np.linspace(0, n - 1, num=min(n, limit), dtype=np.int64) if n else []
+    return [{"level": LEVEL_NAMES[cols["level"][i]],
+             "severity": float(cols["severity"][i]),
+             "source_ip": format_ipv4(cols["source_addr"][i])} for i in idx]
+
+
+# Per-second traffic rollups (see include/Rollups.h for the layout)
+ROLLUP_KEYS = ["NONE", "SOURCE", "DESTINATION", "DST_PORT", "PROTOCOL", "TEID"]
+_ROLLUP_HEADER = np.dtype([("magic", "S4"), ("version", "<u4"), ("record_size", "<u4"),
+                           ("key_kind", "<u4"), ("index_every_sec", "<u4"),
+                           ("reserved", "<u4", 3)])
+_ROLLUP_RECORD = np.dtype([("second", "<i8"), ("packets", "<u8"), ("bytes", "<u8"),
+                           ("key", "<u4"), ("sources", "<u4"),
+                           ("latency_min_ms", "<f4"), ("latency_mean_ms", "<f4"),
+                           ("latency_p99_ms", "<f4"), ("latency_max_ms", "<f4"),
+                           ("kind", "u1"), ("reserved", "u1", 7)])
+
+
+def load_rollups(filepath: str) -> np.ndarray:
+    """Map a rollup file as a structured array of records (zero-copy).
+
+    Records are sorted by second; overall rows have kind 0, keyed rows the
+    file's key kind. A trailing partial record is ignored.
+    """
+    mm = np.memmap(filepath, dtype=np.uint8, mode="r")
+    header = mm[:_ROLLUP_HEADER.itemsize].view(_ROLLUP_HEADER)[0]
+    if header["magic"] != b"5GRU" or header["record_size"] != _ROLLUP_RECORD.itemsize:
+        raise ValueError(f"{filepath}: not a traffic rollup file")
+    body = mm[_ROLLUP_HEADER.itemsize:]
+    count = len(body) // _ROLLUP_RECORD.itemsize
+    return body[:count * _ROLLUP_RECORD.itemsize].view(_ROLLUP_RECORD)
+
+
+def rollup_series(records: np.ndarray, key: int | None = None) -> np.ndarray:
+    """The overall rows, or the rows for one key, in time order."""
+    if key is None:
+        return records[records["kind"] == 0]
+    return records[(records["kind"] != 0) & (records["key"] == key)]
+
+
+def alert_times_ns(alerts: list[dict]) -> np.ndarray:
+    """Event times of alerts from any export (ts_ns, or the local timestamp)."""
+    times = []
+    for a in alerts:
+        if "ts_ns" in a:
+            times.append(int(a["ts_ns"]))
+        elif "timestamp" in a:
+            dt = datetime.strptime(a["timestamp"][:19], "%Y-%m-%d %H:%M:%S")
+            times.append(int(dt.timestamp() * 1e9))
+    return np.array(times, dtype=np.int64)
+
+
+def visualize_traffic(records: np.ndarray, alert_ns: np.ndarray | None = None,
+                      output_dir: str = ".") -> None:
+    """Plot pps, bytes/s and latency per second, with alerts per second."""
+    overall = rollup_series(records)
+    if len(overall) == 0:
+        print("[WARNING] no traffic rollups to plot")
+        return
+    t = overall["second"] - overall["second"][0]
+
+    fig, axes = plt.subplots(3, 1, figsize=(14, 10), sharex=True)
+    fig.suptitle("5G Traffic Trends", fontsize=16, fontweight="bold")
+
+    ax1 = axes[0]
+    ax1.plot(t, overall["packets"], color="#1565c0", label="packets/s")
+    ax1.set_ylabel("Packets/s")
+    if alert_ns is not None and len(alert_ns):
+        seconds = alert_ns // 1_000_000_000 - overall["second"][0]
+        seconds = seconds[(seconds >= 0) & (seconds <= t[-1])]
+        per_second = np.bincount(seconds, minlength=len(t))
+        ax1b = ax1.twinx()
+        ax1b.bar(np.arange(len(per_second)), per_second, color="#d32f2f", alpha=0.3,
+                 label="alerts/s")
+        ax1b.set_ylabel("Alerts/s")
+        ax1b.legend(fontsize=8, loc="upper right")
+    ax1.legend(fontsize=8, loc="upper left")
+
+    ax2 = axes[1]
+    ax2.plot(t, overall["bytes"] / 1e6, color="#388e3c")
+    ax2.set_ylabel("MB/s")
+
+    ax3 = axes[2]
+    ax3.plot(t, overall["latency_mean_ms"], color="#1565c0", label="mean")
+    ax3.plot(t, overall["latency_p99_ms"], color="#f57c00", label="p99")
+    ax3.set_ylabel("Latency (ms)")
+    ax3.set_xlabel("Seconds since start")
+    ax3.legend(fontsize=8)
+
+    plt.tight_layout()
+    out_path = os.path.join(output_dir, "traffic_trends.png")
+    plt.savefig(out_path, dpi=150, bbox_inches="tight")
+    print(f"[✓] Traffic trends saved to {out_path}")
+
+
 def generate_sample_data() -> list[dict]:
     """Generate sample data for demo when C++ output is unavailable."""
     return [
@@ -60,6 +297,25 @@ def analyze(alerts: list[dict]) -> dict:
     }
 
 
+def load_summary(filepath: str, scope: str = "lifetime") -> dict:
+    """Read the engine's running aggregates (alerts.summary.json).
+
+    Returns stats in the same shape as analyze(), without touching the raw
+    alerts. scope is "lifetime" or "window" (the current event-time window).
+    """
+    with open(filepath, "r") as f:
+        summary = json.load(f)[scope]
+    if not summary["total"]:
+        return {}
+    return {
+        "total":         summary["total"],
+        "level_counts":  {k: v for k, v in summary["level_counts"].items() if v},
+        "avg_severity":  summary["avg_severity"],
+        "max_severity":  summary["max_severity"],
+        "top_offenders": [tuple(o) for o in summary["top_offenders"]],
+    }
+
+
 def visualize(alerts: list[dict], stats: dict, output_dir: str = ".") -> None:
     """Generate dashboard with 3 plots."""
     fig, axes = plt.subplots(1, 3, figsize=(18, 6))
@@ -139,7 +395,38 @@ def print_report(stats: dict) -> None:
 
 
 if __name__ == "__main__":
-    alerts = load_alerts("alerts.json")
-    stats  = analyze(alerts)
-    print_report(stats)
-    visualize(alerts, stats)
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("path", nargs="?", default="alerts.json",
+                        help="alerts.json, an .ndjson or a .col export")
+    parser.add_argument("--follow", action="store_true",
+                        help="tail an .ndjson export and print alerts live")
+    parser.add_argument("--summary", nargs="?", const="alerts.summary.json",
+                        help="print the engine's running aggregates instead "
+                             "of rescanning alerts")
+    parser.add_argument("--rollups", nargs="?", const="traffic.rollup",
+                        help="also plot per-second traffic trends from a "
+                             "rollup file, with alerts per second")
+    args = parser.parse_args()
+
+    if args.summary:
+        print_report(load_summary(args.summary))
+        raise SystemExit(0)
+
+    if args.follow:
+        for n, alert in enumerate(follow_ndjson(args.path), start=1):
+            print(f"[{n}] [{alert['timestamp']}] [{alert['level']}] "
+                  f"{alert['source_ip']}: {alert['message']}")
+    elif args.path.endswith(".col"):
+        cols  = load_columnar(args.path)
+        stats = analyze_columnar(cols)
+        print_report(stats)
+        if args.rollups:
+            visualize_traffic(load_rollups(args.rollups), cols["ts_ns"])
+        visualize(columnar_sample(cols), stats)
+    else:
+        alerts = load_alerts(args.path)
+        stats  = analyze(alerts)
+        print_report(stats)
+        if args.rollups:
+            visualize_traffic(load_rollups(args.rollups), alert_times_ns(alerts))
+        visualize(alerts, stats)
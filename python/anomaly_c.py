@@ -0,0 +1,205 @@
+"""
+5G Network Anomaly Detector - ctypes binding for libanomaly_c
+Runs the C++ AnomalyDetector over numpy columns in place (see
+include/anomaly_c.h), so thresholds can be tried on historical data with
+the production rules instead of a pandas re-implementation.
+
+    from anomaly_c import Detector, ipv4_to_int
+    det = Detector(max_latency_ms=80.0, flood_threshold=200)
+    res = det.analyze(src_addr=ipv4_to_int(df.src_ip), latency_ms=df.latency_ms,
+                      timestamp_ns=df.ts_ns)
+    df.iloc[res["row"]]
+
+Columns already of the documented dtype and C-contiguous are passed by
+pointer; anything else is converted once first. The library is looked up
+in $ANOMALY_C_LIB, then in build/ and _build/ next to this directory.
+"""
+
+import ctypes
+import os
+from typing import Optional
+
+import numpy as np
+
+ABI_VERSION = 1
+
+TYPE_NAMES = ["NONE", "HIGH_LATENCY", "PACKET_LOSS", "FLOOD", "UNKNOWN_PROTOCOL"]
+PROTOCOLS = {"TCP": 0, "UDP": 1, "ICMP": 2, "UNKNOWN": 3}
+
+_u8p = ctypes.POINTER(ctypes.c_uint8)
+_u16p = ctypes.POINTER(ctypes.c_uint16)
+_u32p = ctypes.POINTER(ctypes.c_uint32)
+_u64p = ctypes.POINTER(ctypes.c_uint64)
+_i64p = ctypes.POINTER(ctypes.c_int64)
+_f64p = ctypes.POINTER(ctypes.c_double)
+
+
+class _Config(ctypes.Structure):
+    _fields_ = [("max_latency_ms", ctypes.c_double),
+                ("flood_threshold", ctypes.c_uint32),
+                ("packet_loss_threshold", ctypes.c_double),
+                ("window_size_sec", ctypes.c_uint32),
+                ("source_idle_sec", ctypes.c_uint32)]
+
+
+class _Batch(ctypes.Structure):
+    _fields_ = [("count", ctypes.c_size_t),
+                ("src_addr", _u32p),
+                ("dst_addr", _u32p),
+                ("src_port", _u16p),
+                ("dst_port", _u16p),
+                ("protocol", _u8p),
+                ("size_bytes", _u32p),
+                ("latency_ms", _f64p),
+                ("timestamp_ns", _i64p)]
+
+
+class _Results(ctypes.Structure):
+    _fields_ = [("capacity", ctypes.c_size_t),
+                ("row", _u64p),
+                ("type", _u8p),
+                ("severity", _f64p),
+                ("detected_ns", _i64p),
+                ("overflow", ctypes.c_size_t)]
+
+
+# Batch column -> (numpy dtype, ctypes pointer type)
+_COLUMNS = {
+    "src_addr": (np.uint32, _u32p),
+    "dst_addr": (np.uint32, _u32p),
+    "src_port": (np.uint16, _u16p),
+    "dst_port": (np.uint16, _u16p),
+    "protocol": (np.uint8, _u8p),
+    "size_bytes": (np.uint32, _u32p),
+    "latency_ms": (np.float64, _f64p),
+    "timestamp_ns": (np.int64, _i64p),
+}
+
+
+def _find_library() -> str:
+    env = os.environ.get("ANOMALY_C_LIB")
+    if env:
+        return env
+    root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+    names = ["libanomaly_c.so", "libanomaly_c.dylib", "anomaly_c.dll"]
+    for build in ("build", "_build"):
+        for name in names:
+            path = os.path.join(root, build, name)
+            if os.path.exists(path):
+                return path
+    raise OSError("libanomaly_c not found; build it or set ANOMALY_C_LIB")
+
+
+_lib = None
+
+
+def _load() -> ctypes.CDLL:
+    global _lib
+    if _lib is not None:
+        return _lib
+    lib = ctypes.CDLL(_find_library())
+    lib.anomaly_abi_version.restype = ctypes.c_int
+    lib.anomaly_config_init.argtypes = [ctypes.POINTER(_Config)]
+    lib.anomaly_detector_create.argtypes = [ctypes.POINTER(_Config)]
+    lib.anomaly_detector_create.restype = ctypes.c_void_p
+    lib.anomaly_detector_destroy.argtypes = [ctypes.c_void_p]
+    lib.anomaly_detector_reset.argtypes = [ctypes.c_void_p]
+    lib.anomaly_detector_sources.argtypes = [ctypes.c_void_p]
+    lib.anomaly_detector_sources.restype = ctypes.c_size_t
+    lib.anomaly_detector_analyze.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Batch),
+                                             ctypes.POINTER(_Results)]
+    lib.anomaly_detector_analyze.restype = ctypes.c_int64
+    if lib.anomaly_abi_version() != ABI_VERSION:
+        raise OSError(f"libanomaly_c ABI {lib.anomaly_abi_version()}, expected {ABI_VERSION}")
+    _lib = lib
+    return lib
+
+
+def ipv4_to_int(addresses) -> np.ndarray:
+    """Dotted quads (any iterable of str) to uint32 in host byte order."""
+    out = np.empty(len(addresses), dtype=np.uint32)
+    for i, addr in enumerate(addresses):
+        a, b, c, d = (int(x) for x in addr.split("."))
+        out[i] = (a << 24) | (b << 16) | (c << 8) | d
+    return out
+
+
+def int_to_ipv4(addr: int) -> str:
+    return f"{addr >> 24 & 255}.{addr >> 16 & 255}.{addr >> 8 & 255}.{addr & 255}"
+
+
+class Detector:
+    """One C++ AnomalyDetector. State carries over between analyze() calls,
+    so a long history can be fed in time-ordered chunks."""
+
+    def __init__(self, **config):
+        lib = _load()
+        c = _Config()
+        lib.anomaly_config_init(ctypes.byref(c))
+        for key, value in config.items():
+            if not hasattr(c, key):
+                raise TypeError(f"unknown detector option {key!r}")
+            setattr(c, key, value)
+        self._lib = lib
+        self._handle = lib.anomaly_detector_create(ctypes.byref(c))
+        if not self._handle:
+            raise MemoryError("anomaly_detector_create failed")
+
+    def close(self) -> None:
+        if self._handle:
+            self._lib.anomaly_detector_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def reset(self) -> None:
+        self._lib.anomaly_detector_reset(self._handle)
+
+    @property
+    def sources(self) -> int:
+        return self._lib.anomaly_detector_sources(self._handle)
+
+    def analyze(self, src_addr, latency_ms, dst_addr=None, src_port=None,
+                dst_port=None, protocol=None, size_bytes=None,
+                timestamp_ns=None) -> dict[str, np.ndarray]:
+        """Analyze rows in order. Returns columns "row" (index into the
+        inputs), "type" (index into TYPE_NAMES), "severity" and
+        "detected_ns", one entry per anomaly."""
+        given = dict(src_addr=src_addr, latency_ms=latency_ms, dst_addr=dst_addr,
+                     src_port=src_port, dst_port=dst_port, protocol=protocol,
+                     size_bytes=size_bytes, timestamp_ns=timestamp_ns)
+        count = len(src_addr)
+        batch = _Batch(count=count)
+        keep = []  # converted arrays must outlive the call
+        for name, values in given.items():
+            if values is None:
+                continue
+            dtype, ptr = _COLUMNS[name]
+            arr = np.ascontiguousarray(values, dtype=dtype)
+            if arr.shape != (count,):
+                raise ValueError(f"{name} has shape {arr.shape}, expected ({count},)")
+            keep.append(arr)
+            setattr(batch, name, arr.ctypes.data_as(ptr))
+
+        # At most one anomaly per row
+        result = {"row": np.empty(count, dtype=np.uint64),
+                  "type": np.empty(count, dtype=np.uint8),
+                  "severity": np.empty(count, dtype=np.float64),
+                  "detected_ns": np.empty(count, dtype=np.int64)}
+        out = _Results(capacity=count,
+                       row=result["row"].ctypes.data_as(_u64p),
+                       type=result["type"].ctypes.data_as(_u8p),
+                       severity=result["severity"].ctypes.data_as(_f64p),
+                       detected_ns=result["detected_ns"].ctypes.data_as(_i64p))
+        n = self._lib.anomaly_detector_analyze(self._handle, ctypes.byref(batch),
+                                               ctypes.byref(out))
+        if n < 0:
+            raise ValueError("anomaly_detector_analyze rejected the batch")
+        return {key: col[:n] for key, col in result.items()}
@@ -0,0 +1,152 @@
+#include "Affinity.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace anomaly {
+
+namespace {
+
+// Parse a sysfs CPU list such as "0-3,8,10-11"
+std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream ss(text);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        int first = 0, last = 0;
+        char dash = 0;
+        std::stringstream rs(range);
+        rs >> first;
+        if (rs >> dash >> last && dash == '-') {
+            for (int c = first; c <= last; ++c) cpus.push_back(c);
+        } else {
+            cpus.push_back(first);
+        }
+    }
+    return cpus;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    std::string out;
+    for (size_t i = 0; i < cpus.size();) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+        if (!out.empty()) out += ',';
+        out += std::to_string(cpus[i]);
+        if (j > i) out += '-' + std::to_string(cpus[j]);
+        i = j + 1;
+    }
+    return out;
+}
+
+} // namespace
+
+#ifdef __linux__
+
+bool pinCurrentThread(int cpu) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int currentCpu() {
+    return sched_getcpu();
+}
+
+int numaNodeOfCpu(int cpu) {
+    if (cpu < 0) return -1;
+    std::string dir = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* d = opendir(dir.c_str());
+    if (!d) return -1;
+    int node = 0;  // no nodeN link: not a NUMA kernel
+    while (dirent* e = readdir(d)) {
+        if (std::sscanf(e->d_name, "node%d", &node) == 1) break;
+    }
+    closedir(d);
+    return node;
+}
+
+bool preferNumaNode(int node) {
+    // MPOL_PREFERRED from <numaif.h>, spelled out to avoid a libnuma dependency
+    constexpr int kMpolPreferred = 1;
+    constexpr unsigned long kMaxNodes = sizeof(unsigned long) * 8;
+    if (node < 0 || static_cast<unsigned long>(node) >= kMaxNodes) return false;
+    unsigned long mask = 1UL << node;
+    return syscall(SYS_set_mempolicy, kMpolPreferred, &mask, kMaxNodes + 1) == 0;
+}
+
+std::vector<NumaNode> numaTopology() {
+    std::vector<NumaNode> nodes;
+    if (DIR* d = opendir("/sys/devices/system/node")) {
+        while (dirent* e = readdir(d)) {
+            int id;
+            if (std::sscanf(e->d_name, "node%d", &id) != 1) continue;
+            std::ifstream in("/sys/devices/system/node/" + std::string(e->d_name) +
+                             "/cpulist");
+            std::string list;
+            std::getline(in, list);
+            nodes.push_back(NumaNode{id, parseCpuList(list)});
+        }
+        closedir(d);
+    }
+    if (nodes.empty()) {
+        std::ifstream in("/sys/devices/system/cpu/online");
+        std::string list;
+        std::getline(in, list);
+        nodes.push_back(NumaNode{0, parseCpuList(list)});
+    }
+    std::sort(nodes.begin(), nodes.end(),
+              [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+    return nodes;
+}
+
+#else
+
+bool pinCurrentThread(int) { return false; }
+int currentCpu() { return -1; }
+int numaNodeOfCpu(int cpu) { return cpu < 0 ? -1 : 0; }
+bool preferNumaNode(int) { return false; }
+
+std::vector<NumaNode> numaTopology() {
+    NumaNode node;
+    for (unsigned c = 0; c < std::thread::hardware_concurrency(); ++c) {
+        node.cpus.push_back(static_cast<int>(c));
+    }
+    return {node};
+}
+
+#endif
+
+bool placeCurrentThread(int cpu) {
+    if (!pinCurrentThread(cpu)) return false;
+    int node = numaNodeOfCpu(cpu);
+    // A pinned thread still gets local pages by first touch; the policy
+    // only makes that explicit, so its failure is not fatal
+    if (node >= 0) preferNumaNode(node);
+    return true;
+}
+
+std::string describeTopology() {
+    auto nodes = numaTopology();
+    std::string out = std::to_string(nodes.size()) + " NUMA node(s):";
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        out += (i ? ", node" : " node") + std::to_string(nodes[i].id) +
+               " cpus " + formatCpuList(nodes[i].cpus);
+    }
+    return out;
+}
+
+} // namespace anomaly
@@ -0,0 +1,260 @@
+#include "AlertAggregates.h"
+#include "JsonUtil.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace anomaly {
+
+void SeverityMoments::add(double x) {
+    if (count == 0) {
+        min = max = x;
+    } else {
+        min = std::min(min, x);
+        max = std::max(max, x);
+    }
+    ++count;
+    double delta = x - mean;
+    mean += delta / static_cast<double>(count);
+    m2   += delta * (x - mean);
+}
+
+TopOffenders::TopOffenders(size_t capacity)
+    : capacity_(std::max<size_t>(1, capacity)) {
+    counters_.reserve(capacity_);
+    buckets_.reserve(capacity_ + 1);  // one extra while a counter moves up
+}
+
+void TopOffenders::add(const std::string& source_ip) {
+    auto it = index_.find(source_ip);
+    if (it != index_.end()) {
+        increment(it->second);
+        return;
+    }
+
+    if (counters_.size() < capacity_) {
+        uint32_t c = static_cast<uint32_t>(counters_.size());
+        counters_.push_back(Counter{source_ip, 0});
+        index_.emplace(source_ip, c);
+        uint32_t b = min_bucket_ != kNone && buckets_[min_bucket_].count == 1
+                         ? min_bucket_ : newBucket(1, kNone);
+        attach(c, b);
+        return;
+    }
+
+    // Replace a counter of the smallest bucket; its count becomes the new
+    // entry's error
+    uint32_t c = buckets_[min_bucket_].head;
+    Counter& victim = counters_[c];
+    index_.erase(victim.source_ip);
+    victim.error     = buckets_[min_bucket_].count;
+    victim.source_ip = source_ip;
+    index_.emplace(source_ip, c);
+    increment(c);
+}
+
+void TopOffenders::increment(uint32_t c) {
+    uint32_t from = counters_[c].bucket;
+    uint64_t count = buckets_[from].count + 1;
+    uint32_t next = buckets_[from].next;
+    uint32_t to = next != kNone && buckets_[next].count == count ? next
+                                                                 : newBucket(count, from);
+    detach(c);
+    attach(c, to);
+}
+
+uint32_t TopOffenders::newBucket(uint64_t count, uint32_t after) {
+    uint32_t b;
+    if (!free_buckets_.empty()) {
+        b = free_buckets_.back();
+        free_buckets_.pop_back();
+    } else {
+        b = static_cast<uint32_t>(buckets_.size());
+        buckets_.emplace_back();
+    }
+    Bucket& bucket = buckets_[b];
+    bucket.count = count;
+    bucket.head  = kNone;
+    bucket.prev  = after;
+    bucket.next  = after == kNone ? min_bucket_ : buckets_[after].next;
+    if (bucket.prev != kNone) buckets_[bucket.prev].next = b; else min_bucket_ = b;
+    if (bucket.next != kNone) buckets_[bucket.next].prev = b; else max_bucket_ = b;
+    return b;
+}
+
+void TopOffenders::attach(uint32_t c, uint32_t b) {
+    Counter& counter = counters_[c];
+    counter.bucket = b;
+    counter.prev   = kNone;
+    counter.next   = buckets_[b].head;
+    if (counter.next != kNone) counters_[counter.next].prev = c;
+    buckets_[b].head = c;
+}
+
+void TopOffenders::detach(uint32_t c) {
+    Counter& counter = counters_[c];
+    Bucket& bucket = buckets_[counter.bucket];
+    if (counter.prev != kNone) counters_[counter.prev].next = counter.next;
+    else bucket.head = counter.next;
+    if (counter.next != kNone) counters_[counter.next].prev = counter.prev;
+    if (bucket.head == kNone) {
+        if (bucket.prev != kNone) buckets_[bucket.prev].next = bucket.next;
+        else min_bucket_ = bucket.next;
+        if (bucket.next != kNone) buckets_[bucket.next].prev = bucket.prev;
+        else max_bucket_ = bucket.prev;
+        free_buckets_.push_back(counter.bucket);
+    }
+    counter.bucket = kNone;
+}
+
+std::vector<Offender> TopOffenders::top(size_t k) const {
+    std::vector<Offender> out;
+    out.reserve(std::min(k, counters_.size()));
+    for (uint32_t b = max_bucket_; b != kNone && out.size() < k; b = buckets_[b].prev) {
+        for (uint32_t c = buckets_[b].head; c != kNone && out.size() < k;
+             c = counters_[c].next) {
+            out.push_back(Offender{counters_[c].source_ip, buckets_[b].count,
+                                   counters_[c].error});
+        }
+    }
+    return out;
+}
+
+void TopOffenders::clear() {
+    counters_.clear();
+    buckets_.clear();
+    free_buckets_.clear();
+    index_.clear();
+    min_bucket_ = max_bucket_ = kNone;
+}
+
+void AlertAggregates::Totals::add(const Alert& alert) {
+    ++total;
+    ++by_level[static_cast<size_t>(alert.level)];
+    ++by_type[static_cast<size_t>(alert.report.type)];
+    severity.add(alert.report.severity);
+    offenders.add(std::string(alert.report.source_ip));
+}
+
+void AlertAggregates::Totals::clear() {
+    total = 0;
+    by_level.fill(0);
+    by_type.fill(0);
+    severity = SeverityMoments{};
+    offenders.clear();
+}
+
+AggregateSnapshot AlertAggregates::Totals::snapshot(size_t top_k) const {
+    AggregateSnapshot s;
+    s.total         = total;
+    s.by_level      = by_level;
+    s.by_type       = by_type;
+    s.severity      = severity;
+    s.top_offenders = offenders.top(top_k);
+    return s;
+}
+
+AlertAggregates::AlertAggregates(AggregateConfig config)
+    : config_(std::move(config))
+    , lifetime_(config_.top_capacity)
+    , window_(config_.top_capacity) {}
+
+void AlertAggregates::add(const Alert& alert) {
+    int64_t index = windowOf(alert.report.detected_at);
+    if (index > window_index_) {
+        window_.clear();
+        window_index_ = index;
+    }
+    // Late alerts from an already-closed window only count towards lifetime
+    if (index == window_index_) window_.add(alert);
+    lifetime_.add(alert);
+}
+
+AggregateSnapshot AlertAggregates::lifetime() const {
+    return lifetime_.snapshot(config_.top_k);
+}
+
+AggregateSnapshot AlertAggregates::window() const {
+    auto s = window_.snapshot(config_.top_k);
+    if (window_index_ != INT64_MIN) {
+        s.window_start = TimePoint(std::chrono::seconds(
+            window_index_ * std::max<uint32_t>(1, config_.window_sec)));
+    }
+    return s;
+}
+
+void AlertAggregates::clear() {
+    lifetime_.clear();
+    window_.clear();
+    window_index_ = INT64_MIN;
+}
+
+int64_t AlertAggregates::windowOf(TimePoint t) const {
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+        t.time_since_epoch()).count();
+    return secs / std::max<uint32_t>(1, config_.window_sec);
+}
+
+namespace {
+
+void appendSnapshot(std::string& out, const AggregateSnapshot& s) {
+    out += "{\"total\":";
+    appendJsonNumber(out, s.total);
+    out += ",\"level_counts\":{";
+    for (size_t i = 0; i < s.by_level.size(); ++i) {
+        if (i) out += ',';
+        appendJsonString(out, alertLevelName(static_cast<AlertLevel>(i)));
+        out += ':';
+        appendJsonNumber(out, s.by_level[i]);
+    }
+    out += "},\"type_counts\":{";
+    for (size_t i = 0; i < s.by_type.size(); ++i) {
+        if (i) out += ',';
+        appendJsonString(out, anomalyTypeName(static_cast<AnomalyType>(i)));
+        out += ':';
+        appendJsonNumber(out, s.by_type[i]);
+    }
+    out += "},\"avg_severity\":";
+    appendJsonNumber(out, s.severity.mean);
+    out += ",\"severity_stddev\":";
+    appendJsonNumber(out, std::sqrt(s.severity.variance()));
+    out += ",\"min_severity\":";
+    appendJsonNumber(out, s.severity.min);
+    out += ",\"max_severity\":";
+    appendJsonNumber(out, s.severity.max);
+    out += ",\"top_offenders\":[";
+    for (size_t i = 0; i < s.top_offenders.size(); ++i) {
+        if (i) out += ',';
+        out += '[';
+        appendJsonString(out, s.top_offenders[i].source_ip);
+        out += ',';
+        appendJsonNumber(out, s.top_offenders[i].count);
+        out += ']';
+    }
+    out += "],\"window_start_ns\":";
+    appendJsonNumber(out, toNanos(s.window_start));
+    out += '}';
+}
+
+} // namespace
+
+bool AlertAggregates::writeSummary(const std::string& filepath) const {
+    std::string out = "{\"lifetime\":";
+    appendSnapshot(out, lifetime());
+    out += ",\"window\":";
+    appendSnapshot(out, window());
+    out += "}\n";
+
+    // Write then rename so readers never see a half-written summary
+    std::string tmp = filepath + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::trunc);
+        if (!file.is_open()) return false;
+        file << out;
+        if (!file) return false;
+    }
+    return std::rename(tmp.c_str(), filepath.c_str()) == 0;
+}
+
+} // namespace anomaly
@@ -0,0 +1,168 @@
+#include "AlertLogWriter.h"
+#include "Affinity.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <ctime>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace anomaly {
+
+const std::string& TimestampFormatter::format(TimePoint t) {
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+        t.time_since_epoch()).count();
+    if (secs == cached_sec_) return cached_;
+
+    std::time_t time = static_cast<std::time_t>(secs);
+    std::tm tm{};
+#ifdef _WIN32
+    localtime_s(&tm, &time);
+#else
+    localtime_r(&time, &tm);
+#endif
+    char buf[32];
+    size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    cached_.assign(buf, n);
+    cached_sec_ = secs;
+    return cached_;
+}
+
+AlertLogWriter::AlertLogWriter(std::string path, LogWriterConfig config)
+    : path_(std::move(path))
+    , config_(std::move(config)) {
+    file_   = std::fopen(path_.c_str(), "a");
+    thread_ = std::thread(&AlertLogWriter::run, this);
+}
+
+AlertLogWriter::~AlertLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    work_cv_.notify_one();
+    space_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    if (file_) std::fclose(file_);
+}
+
+bool AlertLogWriter::submit(std::string line, uint64_t trace_id) {
+    std::unique_lock<std::mutex> lock(mtx_);
+
+    if (queue_.size() >= config_.queue_capacity) {
+        switch (config_.overflow) {
+            case LogOverflowPolicy::BLOCK:
+                space_cv_.wait(lock, [this] {
+                    return queue_.size() < config_.queue_capacity || stopping_;
+                });
+                break;
+            case LogOverflowPolicy::DROP_OLDEST:
+                queue_.pop_front();
+                ++completed_;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case LogOverflowPolicy::DROP_NEWEST:
+                ++submitted_;
+                ++completed_;
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+        }
+    }
+
+    queue_.push_back(std::move(line));
+    if (trace_id != 0) traced_.push_back(trace_id);
+    ++submitted_;
+    bool wake = queue_.size() == config_.batch_size;
+    lock.unlock();
+
+    // Only the line that completes a batch wakes the writer; the rest wait
+    // for the flush interval
+    if (wake) work_cv_.notify_one();
+    return true;
+}
+
+void AlertLogWriter::flush() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    uint64_t target = submitted_;
+    flush_requested_ = true;
+    work_cv_.notify_one();
+    done_cv_.wait(lock, [&] { return completed_ >= target; });
+}
+
+LogWriterStats AlertLogWriter::stats() const {
+    LogWriterStats s;
+    s.written = written_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.batches = batches_.load(std::memory_order_relaxed);
+    s.fsyncs  = fsyncs_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AlertLogWriter::run() {
+    if (config_.cpu >= 0) placeCurrentThread(config_.cpu);
+
+    std::vector<std::string> batch;
+    std::vector<uint64_t> traced;
+    auto interval  = std::chrono::milliseconds(
+        std::max<uint32_t>(1, config_.flush_interval_ms));
+    auto last_sync = std::chrono::steady_clock::now();
+
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (;;) {
+        work_cv_.wait_for(lock, interval, [this] {
+            return stopping_ || flush_requested_ ||
+                   queue_.size() >= config_.batch_size;
+        });
+
+        bool flushing = flush_requested_;
+        flush_requested_ = false;
+        batch.assign(std::make_move_iterator(queue_.begin()),
+                     std::make_move_iterator(queue_.end()));
+        queue_.clear();
+        traced.swap(traced_);
+        bool stop = stopping_;
+        lock.unlock();
+        space_cv_.notify_all();
+
+        auto now = std::chrono::steady_clock::now();
+        bool sync_due = config_.fsync == FsyncPolicy::INTERVAL &&
+                        now - last_sync >= interval;
+        if (!batch.empty() || flushing) {
+            writeBatch(batch, sync_due || (flushing && config_.fsync != FsyncPolicy::NEVER));
+            if (sync_due) last_sync = now;
+        }
+        for (uint64_t id : traced) tracing::record(id, tracing::Stage::ALERT_PERSISTED);
+        traced.clear();
+
+        lock.lock();
+        completed_ += batch.size();
+        done_cv_.notify_all();
+        if (stop && queue_.empty()) break;
+    }
+}
+
+void AlertLogWriter::writeBatch(std::vector<std::string>& batch, bool force_sync) {
+    if (!batch.empty()) batches_.fetch_add(1, std::memory_order_relaxed);
+
+    for (const auto& line : batch) {
+        if (file_) std::fwrite(line.data(), 1, line.size(), file_);
+        if (config_.console) std::fwrite(line.data(), 1, line.size(), stdout);
+    }
+    written_.fetch_add(batch.size(), std::memory_order_relaxed);
+    if (config_.console && !batch.empty()) std::fflush(stdout);
+    if (!file_) return;
+
+    std::fflush(file_);
+    if (force_sync || (config_.fsync == FsyncPolicy::EVERY_BATCH && !batch.empty())) {
+#ifdef _WIN32
+        _commit(_fileno(file_));
+#else
+        ::fsync(fileno(file_));
+#endif
+        fsyncs_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace anomaly
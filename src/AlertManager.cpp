@@ -1,41 +1,186 @@
 #include "AlertManager.h"
-#include <iostream>
-#include <iomanip>
-#include <sstream>
+#include "JsonUtil.h"
+#include "Metrics.h"
+#include "Tracing.h"
 #include <fstream>
 #include <chrono>
-#include <ctime>
 
 namespace anomaly {
 
-AlertManager::AlertManager(const std::string& log_file)
-    : log_file_(log_file) {}
+namespace {
+struct AlertMetrics {
+    metrics::Counter& reports;
+    metrics::Counter& recorded;
+    metrics::Histogram& dispatch;
+};
+
+const AlertMetrics& alertMetrics() {
+    auto& r = metrics::Registry::global();
+    static const AlertMetrics m{
+        r.counter("anomaly_alert_reports_total", "Reports passed to raise/raiseBatch"),
+        r.counter("anomaly_alerts_recorded_total", "Alerts stored after suppression"),
+        r.histogram("anomaly_alert_dispatch_seconds",
+                    "raise time per report: suppression, log, callbacks, store", 1e-9)};
+    return m;
+}
+} // namespace
+
+AlertManager::AlertManager(const std::string& log_file,
+                           AlertManagerConfig config)
+    : store_(config.store)
+    , aggregates_(config.aggregates)
+    , log_file_(log_file)
+    , config_(std::move(config))
+    , suppressor_(config_.suppression)
+    , log_writer_(std::make_unique<AlertLogWriter>(log_file_, config_.log)) {}
 
 void AlertManager::raise(const AnomalyReport& report) {
+    const auto& m = alertMetrics();
+    int64_t start = metrics::startTimer();
+    tracing::record(report.trace_id, tracing::Stage::ALERT_RAISED);
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        raiseLocked(report);
+    }
+    m.dispatch.observeSince(start);
+    m.reports.inc();
+}
+
+void AlertManager::raiseBatch(const std::vector<AnomalyReport>& reports) {
+    raiseBatch(reports.data(), reports.size());
+}
+
+void AlertManager::raiseBatch(const AnomalyReport* reports, size_t count) {
+    if (count == 0) return;
+    const auto& m = alertMetrics();
+    int64_t start = metrics::startTimer();
+    if (tracing::active()) {
+        for (size_t i = 0; i < count; ++i) {
+            tracing::record(reports[i].trace_id, tracing::Stage::ALERT_RAISED);
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        for (size_t i = 0; i < count; ++i) raiseLocked(reports[i]);
+    }
+    m.dispatch.observeSince(start, count);
+    m.reports.inc(count);
+}
+
+void AlertManager::raiseLocked(const AnomalyReport& report) {
+    if (!config_.suppression.enabled) {
+        record(report);
+        return;
+    }
+
+    pending_.clear();
+    if (hasTimestamp(report.detected_at)) {
+        suppressor_.process(report, pending_);
+    } else {
+        // Suppression windows run on event time; stamp reports raised without one
+        AnomalyReport stamped = report;
+        stamped.detected_at = std::chrono::system_clock::now();
+        suppressor_.process(stamped, pending_);
+    }
+    for (const auto& r : pending_) record(r);
+}
+
+void AlertManager::flushSuppressed() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    pending_.clear();
+    suppressor_.flush(pending_);
+    for (const auto& r : pending_) record(r);
+}
+
+SuppressionStats AlertManager::suppressionStats() const {
     std::lock_guard<std::mutex> lock(mtx_);
+    return suppressor_.stats();
+}
+
+void AlertManager::flushLog() {
+    log_writer_->flush();
+}
 
+LogWriterStats AlertManager::logStats() const {
+    return log_writer_->stats();
+}
+
+void AlertManager::record(const AnomalyReport& report) {
     Alert alert;
     alert.level         = severityToLevel(report.severity);
     alert.message       = report.description;
     alert.report        = report;
-    alert.timestamp_str = getCurrentTimestamp();
+    // Reports carry the event time of their packet; fall back to the wall
+    // clock only for reports raised without one
+    if (!hasTimestamp(alert.report.detected_at)) {
+        alert.report.detected_at = std::chrono::system_clock::now();
+    }
+    alert.timestamp_str = timestamps_.format(alert.report.detected_at);
+
+    alert.sequence      = store_.nextSequence();
 
-    alerts_.push_back(alert);
     writeToLog(alert);
+    aggregates_.add(alert);
+    for (const auto& callback : callbacks_) callback(alert);
+    store_.push(std::move(alert));
+    alertMetrics().recorded.inc();
+}
 
-    // Print to console with level color hint
-    std::cout << "[" << alert.timestamp_str << "] "
-              << "[" << levelToString(alert.level) << "] "
-              << alert.message << "\n";
+void AlertManager::onAlert(AlertCallback callback) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    callbacks_.push_back(std::move(callback));
 }
 
-std::vector<Alert> AlertManager::getAlertsByLevel(AlertLevel level) const {
+AlertSnapshot AlertManager::getAlerts() const {
     std::lock_guard<std::mutex> lock(mtx_);
-    std::vector<Alert> filtered;
-    for (const auto& a : alerts_) {
-        if (a.level == level) filtered.push_back(a);
-    }
-    return filtered;
+    return store_.all();
+}
+
+AlertSnapshot AlertManager::getAlertsByLevel(AlertLevel level) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return store_.byLevel(level);
+}
+
+AlertSnapshot AlertManager::getAlertsBySource(const std::string& source_ip) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return store_.bySource(source_ip);
+}
+
+AlertSnapshot AlertManager::getAlertsInRange(TimePoint from, TimePoint to) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return store_.byTimeRange(from, to);
+}
+
+AlertSnapshot AlertManager::getAlertsSince(uint64_t& seq) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    auto out = store_.since(seq);
+    seq = store_.nextSequence();
+    return out;
+}
+
+AggregateSnapshot AlertManager::lifetimeAggregates() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return aggregates_.lifetime();
+}
+
+AggregateSnapshot AlertManager::windowAggregates() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return aggregates_.window();
+}
+
+bool AlertManager::writeSummary(const std::string& filepath) const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return aggregates_.writeSummary(filepath);
+}
+
+size_t AlertManager::count() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return store_.size();
+}
+
+uint64_t AlertManager::evictedCount() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return store_.evicted();
 }
 
 void AlertManager::exportToJSON(const std::string& filepath) const {
@@ -43,23 +188,30 @@ void AlertManager::exportToJSON(const std::string& filepath) const {
     std::ofstream file(filepath);
     if (!file.is_open()) return;
 
-    file << "[\n";
-    for (size_t i = 0; i < alerts_.size(); ++i) {
-        const auto& a = alerts_[i];
-        file << "  {\n"
-             << "    \"timestamp\": \"" << a.timestamp_str << "\",\n"
-             << "    \"level\": \""     << levelToString(a.level) << "\",\n"
-             << "    \"message\": \""   << a.message << "\",\n"
-             << "    \"source_ip\": \"" << a.report.source_ip << "\",\n"
-             << "    \"severity\": "    << a.report.severity << "\n"
-             << "  }" << (i + 1 < alerts_.size() ? "," : "") << "\n";
+    auto alerts = store_.all();
+    std::string out = "[\n";
+    for (size_t i = 0; i < alerts.size(); ++i) {
+        const Alert& a = *alerts[i];
+        out += "  {\n    \"timestamp\": ";
+        appendJsonString(out, a.timestamp_str);
+        out += ",\n    \"level\": \"";
+        out += levelToString(a.level);
+        out += "\",\n    \"message\": ";
+        appendJsonString(out, a.message);
+        out += ",\n    \"source_ip\": ";
+        appendJsonString(out, a.report.source_ip);
+        out += ",\n    \"severity\": ";
+        appendJsonNumber(out, a.report.severity);
+        out += i + 1 < alerts.size() ? "\n  },\n" : "\n  }\n";
     }
-    file << "]\n";
+    out += "]\n";
+    file << out;
 }
 
 void AlertManager::clearAlerts() {
     std::lock_guard<std::mutex> lock(mtx_);
-    alerts_.clear();
+    store_.clear();
+    aggregates_.clear();
 }
 
 AlertLevel AlertManager::severityToLevel(double severity) const {
@@ -70,29 +222,21 @@ AlertLevel AlertManager::severityToLevel(double severity) const {
 }
 
 std::string AlertManager::levelToString(AlertLevel level) const {
-    switch (level) {
-        case AlertLevel::CRITICAL: return "CRITICAL";
-        case AlertLevel::HIGH:     return "HIGH";
-        case AlertLevel::MEDIUM:   return "MEDIUM";
-        case AlertLevel::LOW:      return "LOW";
-        default:                   return "UNKNOWN";
-    }
-}
-
-std::string AlertManager::getCurrentTimestamp() const {
-    auto now  = std::chrono::system_clock::now();
-    auto time = std::chrono::system_clock::to_time_t(now);
-    std::ostringstream ss;
-    ss << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+    return alertLevelName(level);
 }
 
 void AlertManager::writeToLog(const Alert& alert) {
-    std::ofstream file(log_file_, std::ios::app);
-    if (!file.is_open()) return;
-    file << "[" << alert.timestamp_str << "] "
-         << "[" << levelToString(alert.level) << "] "
-         << alert.message << "\n";
+    // Console and file output happen on the writer thread
+    std::string line;
+    line.reserve(alert.timestamp_str.size() + alert.message.size() + 16);
+    line += '[';
+    line += alert.timestamp_str;
+    line += "] [";
+    line += levelToString(alert.level);
+    line += "] ";
+    line += alert.message;
+    line += '\n';
+    log_writer_->submit(std::move(line), alert.report.trace_id);
 }
 
 } // namespace anomaly
@@ -0,0 +1,105 @@
+#include "AlertStore.h"
+#include <algorithm>
+
+namespace anomaly {
+
+AlertStore::AlertStore(AlertStoreConfig config)
+    : config_(std::move(config)) {
+    ring_.resize(std::max<size_t>(1, config_.capacity));
+}
+
+uint64_t AlertStore::push(Alert alert) {
+    if (size() == ring_.size()) evictOldest();
+
+    uint64_t seq   = next_seq_++;
+    alert.sequence = seq;
+
+    by_level_[static_cast<size_t>(alert.level)].push_back(seq);
+    by_source_[std::string(alert.report.source_ip)].push_back(seq);
+    by_bucket_[bucketOf(alert.report.detected_at)].push_back(seq);
+
+    ring_[seq % ring_.size()] = std::make_shared<const Alert>(std::move(alert));
+    return seq;
+}
+
+AlertSnapshot AlertStore::all() const {
+    return since(head_seq_);
+}
+
+AlertSnapshot AlertStore::byLevel(AlertLevel level) const {
+    return resolve(by_level_[static_cast<size_t>(level)]);
+}
+
+AlertSnapshot AlertStore::bySource(const std::string& source_ip) const {
+    auto it = by_source_.find(source_ip);
+    if (it == by_source_.end()) return {};
+    return resolve(it->second);
+}
+
+AlertSnapshot AlertStore::byTimeRange(TimePoint from, TimePoint to) const {
+    AlertSnapshot out;
+    // An empty or reversed range would start the walk past its end
+    if (!(from < to)) return out;
+    auto last = by_bucket_.upper_bound(bucketOf(to));
+    for (auto it = by_bucket_.lower_bound(bucketOf(from)); it != last; ++it) {
+        for (uint64_t seq : it->second) {
+            const AlertPtr& a = at(seq);
+            // Only the edge buckets can hold alerts outside the range
+            if (a->report.detected_at >= from && a->report.detected_at < to) {
+                out.push_back(a);
+            }
+        }
+    }
+    return out;
+}
+
+AlertSnapshot AlertStore::since(uint64_t seq) const {
+    AlertSnapshot out;
+    uint64_t first = std::max(seq, head_seq_);
+    if (first >= next_seq_) return out;
+    out.reserve(static_cast<size_t>(next_seq_ - first));
+    for (uint64_t s = first; s < next_seq_; ++s) out.push_back(at(s));
+    return out;
+}
+
+void AlertStore::clear() {
+    std::fill(ring_.begin(), ring_.end(), nullptr);
+    for (auto& level : by_level_) level.clear();
+    by_source_.clear();
+    by_bucket_.clear();
+    head_seq_ = next_seq_;
+}
+
+int64_t AlertStore::bucketOf(TimePoint t) const {
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+        t.time_since_epoch()).count();
+    int64_t width = std::max<uint32_t>(1, config_.bucket_sec);
+    return secs >= 0 ? secs / width : (secs - width + 1) / width;
+}
+
+void AlertStore::evictOldest() {
+    uint64_t seq = head_seq_++;
+    AlertPtr& slot = ring_[seq % ring_.size()];
+
+    by_level_[static_cast<size_t>(slot->level)].pop_front();
+
+    auto src = by_source_.find(std::string(slot->report.source_ip));
+    src->second.pop_front();
+    if (src->second.empty()) by_source_.erase(src);
+
+    auto bucket = by_bucket_.find(bucketOf(slot->report.detected_at));
+    bucket->second.pop_front();
+    if (bucket->second.empty()) by_bucket_.erase(bucket);
+
+    slot.reset();
+    ++evicted_;
+}
+
+AlertSnapshot AlertStore::resolve(const std::deque<uint64_t>& seqs) const {
+    AlertSnapshot out;
+    out.reserve(seqs.size());
+    for (uint64_t seq : seqs) out.push_back(at(seq));
+    return out;
+}
+
+} // namespace anomaly
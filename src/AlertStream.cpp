@@ -0,0 +1,122 @@
+#include "AlertStream.h"
+#include "IpAddress.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace anomaly {
+
+std::unique_ptr<AlertStreamPublisher> AlertStreamPublisher::create(
+    const std::string& name, size_t capacity) {
+    uint64_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+
+    auto region = SharedMemoryRegion::create(
+        name, stream::kSlotsOffset + slots * sizeof(stream::Slot));
+    if (!region) return nullptr;
+
+    // The region is zero-filled: every slot version starts at 0 (empty)
+    auto* header = new (region->data()) stream::StreamHeader;
+    std::memcpy(header->magic, stream::kMagic, sizeof(stream::kMagic));
+    header->version   = stream::kVersion;
+    header->slot_size = sizeof(stream::Slot);
+    header->capacity  = slots;
+    header->write_seq.store(0, std::memory_order_release);
+
+    return std::unique_ptr<AlertStreamPublisher>(
+        new AlertStreamPublisher(std::move(region)));
+}
+
+AlertStreamPublisher::AlertStreamPublisher(std::unique_ptr<SharedMemoryRegion> region)
+    : region_(std::move(region))
+    , header_(static_cast<stream::StreamHeader*>(region_->data()))
+    , slots_(reinterpret_cast<stream::Slot*>(
+          static_cast<char*>(region_->data()) + stream::kSlotsOffset))
+    , mask_(header_->capacity - 1) {}
+
+void AlertStreamPublisher::publish(const Alert& alert) {
+    uint64_t seq = header_->write_seq.load(std::memory_order_relaxed);
+    stream::Slot& slot = slots_[seq & mask_];
+
+    slot.version.store(2 * seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    stream::AlertRecord& r = slot.record;
+    r.ts_ns       = toNanos(alert.report.detected_at);
+    r.severity    = alert.report.severity;
+    r.alert_seq   = alert.sequence;
+    r.source_addr = 0;
+    parseIPv4(alert.report.source_ip, r.source_addr);
+    r.level       = static_cast<uint8_t>(alert.level);
+    r.type        = static_cast<uint8_t>(alert.report.type);
+
+    size_t ip_len = std::min(alert.report.source_ip.size(), sizeof(r.source_ip) - 1);
+    std::memcpy(r.source_ip, alert.report.source_ip.data(), ip_len);
+    r.source_ip[ip_len] = '\0';
+    size_t msg_len = std::min(alert.message.size(), sizeof(r.message));
+    std::memcpy(r.message, alert.message.data(), msg_len);
+    r.message_len = static_cast<uint16_t>(msg_len);
+
+    slot.version.store(2 * seq + 2, std::memory_order_release);
+    header_->write_seq.store(seq + 1, std::memory_order_release);
+}
+
+uint64_t AlertStreamPublisher::published() const {
+    return header_->write_seq.load(std::memory_order_relaxed);
+}
+
+std::unique_ptr<AlertStreamReader> AlertStreamReader::open(const std::string& name) {
+    auto region = SharedMemoryRegion::open(name);
+    if (!region || region->size() < stream::kSlotsOffset) return nullptr;
+
+    const auto* header = static_cast<const stream::StreamHeader*>(region->data());
+    if (std::memcmp(header->magic, stream::kMagic, sizeof(stream::kMagic)) != 0 ||
+        header->version != stream::kVersion ||
+        header->slot_size != sizeof(stream::Slot) ||
+        region->size() < stream::kSlotsOffset + header->capacity * sizeof(stream::Slot)) {
+        return nullptr;
+    }
+    return std::unique_ptr<AlertStreamReader>(new AlertStreamReader(std::move(region)));
+}
+
+AlertStreamReader::AlertStreamReader(std::unique_ptr<SharedMemoryRegion> region)
+    : region_(std::move(region))
+    , header_(static_cast<const stream::StreamHeader*>(region_->data()))
+    , slots_(reinterpret_cast<const stream::Slot*>(
+          static_cast<const char*>(region_->data()) + stream::kSlotsOffset))
+    , capacity_(header_->capacity)
+    , cursor_(header_->write_seq.load(std::memory_order_acquire)) {}
+
+size_t AlertStreamReader::poll(std::vector<stream::AlertRecord>& out,
+                               size_t max_records) {
+    uint64_t head = header_->write_seq.load(std::memory_order_acquire);
+    if (head - cursor_ > capacity_) {
+        overruns_ += head - capacity_ - cursor_;
+        cursor_ = head - capacity_;
+    }
+
+    size_t n = 0;
+    stream::AlertRecord record;
+    while (cursor_ < head && n < max_records) {
+        const stream::Slot& slot = slots_[cursor_ & (capacity_ - 1)];
+        uint64_t expected = 2 * cursor_ + 2;
+
+        uint64_t before = slot.version.load(std::memory_order_acquire);
+        std::memcpy(&record, &slot.record, sizeof(record));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.version.load(std::memory_order_relaxed);
+
+        if (before != expected || after != expected) {
+            // Publisher reused this slot while we were copying: we were lapped
+            ++overruns_;
+            ++cursor_;
+            continue;
+        }
+        out.push_back(record);
+        ++cursor_;
+        ++n;
+    }
+    return n;
+}
+
+} // namespace anomaly
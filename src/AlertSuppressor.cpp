@@ -0,0 +1,100 @@
+#include "AlertSuppressor.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace anomaly {
+
+AlertSuppressor::AlertSuppressor(SuppressionConfig config)
+    : config_(std::move(config)) {}
+
+void AlertSuppressor::process(const AnomalyReport& report,
+                              std::vector<AnomalyReport>& out) {
+    int64_t window = windowOf(report.detected_at);
+    if (window > swept_window_) sweep(window, out);
+    // With several workers on event time, reports from a window that has
+    // already been swept still arrive; they count in the current one, so
+    // a key's window never moves backwards
+    window = std::max(window, swept_window_);
+
+    Key key{report.type, std::string(report.source_ip)};
+    auto it = index_.find(key);
+
+    if (it != index_.end()) {
+        Entry& entry = *it->second;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        if (entry.window == window) {
+            ++entry.suppressed;
+            ++stats_.suppressed;
+            entry.peak_severity = std::max(entry.peak_severity, report.severity);
+            entry.last_seen     = std::max(entry.last_seen, report.detected_at);
+            return;
+        }
+        // Same key, new window: summarise the old one and start over
+        close(entry, out);
+        entry.window        = window;
+        entry.suppressed    = 0;
+        entry.peak_severity = report.severity;
+        entry.last_seen     = report.detected_at;
+    } else {
+        if (config_.max_keys > 0 && index_.size() >= config_.max_keys) {
+            close(lru_.back(), out);
+            index_.erase(lru_.back().key);
+            lru_.pop_back();
+            ++stats_.evicted;
+        }
+        lru_.push_front(Entry{key, window, 0, report.severity, report.detected_at});
+        index_.emplace(std::move(key), lru_.begin());
+    }
+
+    ++stats_.emitted;
+    out.push_back(report);
+}
+
+void AlertSuppressor::flush(std::vector<AnomalyReport>& out) {
+    for (const auto& entry : lru_) close(entry, out);
+    lru_.clear();
+    index_.clear();
+}
+
+int64_t AlertSuppressor::windowOf(TimePoint t) const {
+    if (config_.window_sec == 0) return 0;
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+        t.time_since_epoch()).count();
+    return secs / static_cast<int64_t>(config_.window_sec);
+}
+
+void AlertSuppressor::close(const Entry& entry, std::vector<AnomalyReport>& out) {
+    if (entry.suppressed == 0) return;
+
+    char severity[16];
+    std::snprintf(severity, sizeof(severity), "%.2f", entry.peak_severity);
+
+    AnomalyReport summary;
+    summary.type        = entry.key.type;
+    summary.source_ip   = entry.key.source_ip;
+    summary.severity    = entry.peak_severity;
+    summary.detected_at = entry.last_seen;
+    summary.description = std::string(anomalyTypeName(entry.key.type)) +
+                          " from " + entry.key.source_ip + ": " +
+                          std::to_string(entry.suppressed) +
+                          " more occurrences, peak severity " + severity;
+    out.push_back(std::move(summary));
+    ++stats_.summaries;
+}
+
+void AlertSuppressor::sweep(int64_t current_window,
+                            std::vector<AnomalyReport>& out) {
+    // Once per window of event time: close keys whose window has ended
+    for (auto it = lru_.begin(); it != lru_.end();) {
+        if (it->window < current_window) {
+            close(*it, out);
+            index_.erase(it->key);
+            it = lru_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    swept_window_ = current_window;
+}
+
+} // namespace anomaly
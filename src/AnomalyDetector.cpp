@@ -1,42 +1,174 @@
 #include "AnomalyDetector.h"
+#include "Metrics.h"
+#include "Tracing.h"
 #include <algorithm>
+#include <charconv>
+#include <cstdio>
 
 namespace anomaly {
 
+namespace {
+struct DetectorMetrics {
+    metrics::Counter& packets;
+    metrics::Histogram& seconds;
+    metrics::Counter* reports[5];  // by AnomalyType
+};
+
+const DetectorMetrics& detectorMetrics() {
+    static const DetectorMetrics m = [] {
+        auto& r = metrics::Registry::global();
+        DetectorMetrics d{
+            r.counter("anomaly_detector_packets_total", "Packets analyzed"),
+            r.histogram("anomaly_analyze_seconds",
+                        "Detector time per packet (batch average; 1 in 16 single analyze calls)", 1e-9),
+            {}};
+        for (auto type : {AnomalyType::NONE, AnomalyType::HIGH_LATENCY,
+                          AnomalyType::PACKET_LOSS, AnomalyType::FLOOD,
+                          AnomalyType::UNKNOWN_PROTOCOL}) {
+            d.reports[static_cast<size_t>(type)] = &r.counter(
+                std::string("anomaly_reports_total{type=\"") + anomalyTypeName(type) + "\"}",
+                "Anomaly reports produced by the detector");
+        }
+        return d;
+    }();
+    return m;
+}
+
+// Descriptions are built in place in the report's own resource, so a
+// report costs one allocation (none from an arena) instead of a chain of
+// std::to_string temporaries. Long enough for the latency message.
+constexpr size_t kDescriptionReserve = 96;
+
+// std::to_string's "%f" formatting, appended
+void appendFixed(std::pmr::string& out, double value) {
+    char buf[64];
+    int n = std::snprintf(buf, sizeof(buf), "%f", value);
+    if (n < 0) return;
+    if (static_cast<size_t>(n) < sizeof(buf)) {
+        out.append(buf, static_cast<size_t>(n));
+        return;
+    }
+    size_t at = out.size();
+    out.resize(at + static_cast<size_t>(n));
+    std::snprintf(&out[at], static_cast<size_t>(n) + 1, "%f", value);
+}
+
+template <typename T>
+void appendInt(std::pmr::string& out, T value) {
+    char buf[24];
+    auto result = std::to_chars(buf, buf + sizeof(buf), value);
+    out.append(buf, result.ptr);
+}
+
+std::pmr::memory_resource* resourceOf(const std::vector<AnomalyReport>&) {
+    return std::pmr::get_default_resource();
+}
+
+std::pmr::memory_resource* resourceOf(const std::pmr::vector<AnomalyReport>& out) {
+    return out.get_allocator().resource();
+}
+} // namespace
+
 AnomalyDetector::AnomalyDetector(DetectorConfig config)
-    : config_(std::move(config)) {}
+    : config_(std::move(config)) {
+    if (config_.shard_count == 0) config_.shard_count = 1;
+    for (uint32_t i = 0; i < config_.shard_count; ++i) {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+uint64_t AnomalyDetector::sourceHash(std::string_view src_ip) {
+    // std::hash is often the identity-ish on short keys; finalise it so the
+    // low bits are usable for modulo
+    uint64_t h = std::hash<std::string_view>{}(src_ip);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+void AnomalyDetector::rebuildShard(size_t index) {
+    if (index >= shards_.size()) return;
+    const Shard& old = *shards_[index];
+    auto fresh = std::make_unique<Shard>();
+    fresh->interner = old.interner;
+    fresh->sources.reserve(old.sources.capacity());
+    fresh->sources = old.sources;
+    fresh->watermark      = old.watermark;
+    fresh->next_sweep_sec = old.next_sweep_sec;
+    shards_[index] = std::move(fresh);
+}
+
+size_t AnomalyDetector::shardOf(std::string_view src_ip) const {
+    if (shards_.size() == 1) return 0;
+    return sourceHash(src_ip) % shards_.size();
+}
 
 std::optional<AnomalyReport> AnomalyDetector::analyze(const Packet& packet) {
-    std::lock_guard<std::mutex> lock(mtx_);
+    const auto& m = detectorMetrics();
+    int64_t start = metrics::kEnabled && metrics::sampled() ? metrics::startTimer() : 0;
+    tracing::record(packet.trace_id, tracing::Stage::ANALYZE_START);
+    Shard& shard = *shards_[shardOf(packet.src_ip)];
+    std::unique_lock<std::mutex> lock(shard.mtx);
+    auto result = analyzeLocked(shard, packet, std::pmr::get_default_resource());
+    lock.unlock();
+    tracing::record(packet.trace_id, tracing::Stage::ANALYZE_END);
+    if (result) result->trace_id = packet.trace_id;
+    if (start) m.seconds.observeSince(start);
+    m.packets.inc();
+    if (result) m.reports[static_cast<size_t>(result->type)]->inc();
+    return result;
+}
+
+std::optional<AnomalyReport> AnomalyDetector::analyzeLocked(
+    Shard& shard, const Packet& packet, std::pmr::memory_resource* resource) {
+    TimePoint now = eventTime(shard, packet);
+    int64_t now_sec = std::chrono::duration_cast<std::chrono::seconds>(
+        now.time_since_epoch()).count();
+    expireIdleSources(shard, now_sec);
 
     if (isHighLatency(packet)) {
-        AnomalyReport report;
+        AnomalyReport report(resource);
         report.type        = AnomalyType::HIGH_LATENCY;
+        report.detected_at = now;
         report.source_ip   = packet.src_ip;
-        report.description = "High latency detected: " +
-                             std::to_string(packet.latency_ms) + " ms (threshold: " +
-                             std::to_string(config_.max_latency_ms) + " ms)";
-        report.severity    = calculateSeverity(AnomalyType::HIGH_LATENCY, packet);
+        report.description.reserve(kDescriptionReserve);
+        report.description += "High latency detected: ";
+        appendFixed(report.description, packet.latency_ms);
+        report.description += " ms (threshold: ";
+        appendFixed(report.description, config_.max_latency_ms);
+        report.description += " ms)";
+        report.severity    = calculateSeverity(AnomalyType::HIGH_LATENCY, packet,
+                                               SourceState{});
         return report;
     }
 
-    if (isFlood(packet.src_ip)) {
-        AnomalyReport report;
+    // Single hash lookup per packet; everything below indexes by ID
+    SourceState& src = sourceState(shard, packet.src_ip, now_sec);
+
+    if (isFlood(src, now)) {
+        AnomalyReport report(resource);
         report.type        = AnomalyType::FLOOD;
+        report.detected_at = now;
         report.source_ip   = packet.src_ip;
-        report.description = "Possible flood attack from " + packet.src_ip +
-                             " (" + std::to_string(packet_counts_[packet.src_ip]) +
-                             " packets)";
-        report.severity    = calculateSeverity(AnomalyType::FLOOD, packet);
+        report.description.reserve(kDescriptionReserve);
+        report.description += "Possible flood attack from ";
+        report.description += packet.src_ip;
+        report.description += " (";
+        appendInt(report.description, src.window_count);
+        report.description += " packets)";
+        report.severity    = calculateSeverity(AnomalyType::FLOOD, packet, src);
         return report;
     }
 
     if (packet.protocol == Protocol::UNKNOWN) {
-        AnomalyReport report;
+        AnomalyReport report(resource);
         report.type        = AnomalyType::UNKNOWN_PROTOCOL;
+        report.detected_at = now;
         report.source_ip   = packet.src_ip;
-        report.description = "Unknown protocol on port " +
-                             std::to_string(packet.dst_port);
+        report.description.reserve(kDescriptionReserve);
+        report.description += "Unknown protocol on port ";
+        appendInt(report.description, packet.dst_port);
         report.severity    = 0.3;
         return report;
     }
@@ -47,54 +179,175 @@ std::optional<AnomalyReport> AnomalyDetector::analyze(const Packet& packet) {
 std::vector<AnomalyReport> AnomalyDetector::analyzeBatch(
     const std::vector<Packet>& packets) {
     std::vector<AnomalyReport> reports;
-    for (const auto& pkt : packets) {
-        auto result = analyze(pkt);
+    analyzeBatch(packets, reports);
+    return reports;
+}
+
+size_t AnomalyDetector::analyzeBatch(const std::vector<Packet>& packets,
+                                     std::vector<AnomalyReport>& out) {
+    return analyzeBatch(packets.data(), packets.size(), out);
+}
+
+size_t AnomalyDetector::analyzeBatch(const Packet* packets, size_t count,
+                                     std::vector<AnomalyReport>& out,
+                                     std::vector<size_t>* rows) {
+    return analyzeInto(packets, count, out, rows, resourceOf(out));
+}
+
+size_t AnomalyDetector::analyzeBatch(const Packet* packets, size_t count,
+                                     std::pmr::vector<AnomalyReport>& out,
+                                     std::vector<size_t>* rows) {
+    return analyzeInto(packets, count, out, rows, resourceOf(out));
+}
+
+template <typename Reports>
+size_t AnomalyDetector::analyzeInto(const Packet* packets, size_t count, Reports& out,
+                                    std::vector<size_t>* rows,
+                                    std::pmr::memory_resource* resource) {
+    const auto& m = detectorMetrics();
+    int64_t start = metrics::startTimer();
+    size_t before = out.size();
+    // Hold a shard's lock across consecutive packets of that shard; a
+    // monitor worker's batch normally stays on one shard throughout
+    Shard* held = nullptr;
+    std::unique_lock<std::mutex> lock;
+    for (size_t i = 0; i < count; ++i) {
+        const Packet& pkt = packets[i];
+        tracing::record(pkt.trace_id, tracing::Stage::ANALYZE_START);
+        Shard& shard = *shards_[shardOf(pkt.src_ip)];
+        if (&shard != held) {
+            lock = std::unique_lock<std::mutex>(shard.mtx);
+            held = &shard;
+        }
+        auto result = analyzeLocked(shard, pkt, resource);
+        tracing::record(pkt.trace_id, tracing::Stage::ANALYZE_END);
         if (result.has_value()) {
-            reports.push_back(std::move(result.value()));
+            result->trace_id = pkt.trace_id;
+            out.push_back(std::move(result.value()));
+            if (rows) rows->push_back(i);
         }
     }
-    return reports;
+    if (lock.owns_lock()) lock.unlock();
+    m.seconds.observeSince(start, count);
+    m.packets.inc(count);
+    for (size_t i = before; i < out.size(); ++i) {
+        m.reports[static_cast<size_t>(out[i].type)]->inc();
+    }
+    return out.size() - before;
 }
 
 void AnomalyDetector::reset() {
-    std::lock_guard<std::mutex> lock(mtx_);
-    packet_counts_.clear();
-    sent_packets_.clear();
-    lost_packets_.clear();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        shard->interner.clear();
+        shard->sources.clear();
+        shard->watermark      = TimePoint{};
+        shard->next_sweep_sec = 0;
+    }
 }
 
 void AnomalyDetector::updateConfig(const DetectorConfig& new_config) {
-    std::lock_guard<std::mutex> lock(mtx_);
+    // Shards read config_ under their own lock, so take all of them
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(shards_.size());
+    for (auto& shard : shards_) locks.emplace_back(shard->mtx);
+
+    uint32_t shard_count = config_.shard_count;
     config_ = new_config;
+    config_.shard_count = shard_count;
+}
+
+TimePoint AnomalyDetector::watermark() const {
+    TimePoint latest{};
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        latest = std::max(latest, shard->watermark);
+    }
+    return latest;
+}
+
+TimePoint AnomalyDetector::eventTime(Shard& shard, const Packet& p) {
+    // Windows advance on packet timestamps only, never on the wall clock, so
+    // a replayed capture produces the same anomalies at any speed.
+    if (!hasTimestamp(p.timestamp)) return shard.watermark;
+    if (p.timestamp > shard.watermark) shard.watermark = p.timestamp;
+    return p.timestamp;
+}
+
+size_t AnomalyDetector::trackedSources() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mtx);
+        total += shard->interner.size();
+    }
+    return total;
+}
+
+int64_t AnomalyDetector::windowIndex(TimePoint t) const {
+    if (config_.window_size_sec == 0) return 0;
+    auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+        t.time_since_epoch()).count();
+    return secs / static_cast<int64_t>(config_.window_size_sec);
+}
+
+AnomalyDetector::SourceState& AnomalyDetector::sourceState(
+    Shard& shard, const std::string& src_ip, int64_t now_sec) {
+    uint32_t id = shard.interner.intern(src_ip);
+    if (id >= shard.sources.size()) shard.sources.resize(shard.interner.capacity());
+
+    SourceState& src = shard.sources[id];
+    if (!src.active) {
+        src        = SourceState{};  // fresh or recycled ID
+        src.active = true;
+    }
+    src.last_seen_sec = now_sec;
+    return src;
+}
+
+void AnomalyDetector::expireIdleSources(Shard& shard, int64_t now_sec) {
+    if (config_.source_idle_sec == 0 || now_sec < shard.next_sweep_sec) return;
+
+    // Amortised: one linear pass per idle period of event time
+    int64_t idle = config_.source_idle_sec;
+    for (uint32_t id = 0; id < shard.sources.size(); ++id) {
+        auto& src = shard.sources[id];
+        if (src.active && now_sec - src.last_seen_sec >= idle) {
+            src.active = false;
+            shard.interner.release(id);
+        }
+    }
+    shard.next_sweep_sec = now_sec + idle;
 }
 
 bool AnomalyDetector::isHighLatency(const Packet& p) const {
     return p.latency_ms > config_.max_latency_ms;
 }
 
-bool AnomalyDetector::isFlood(const std::string& src_ip) {
-    auto& count = packet_counts_[src_ip];
-    ++count;
-    return count > config_.flood_threshold;
+bool AnomalyDetector::isFlood(SourceState& src, TimePoint event_time) {
+    int64_t index = windowIndex(event_time);
+    if (index != src.window_index) {
+        src.window_index = index;
+        src.window_count = 0;
+    }
+    ++src.window_count;
+    return src.window_count > config_.flood_threshold;
 }
 
-bool AnomalyDetector::isPacketLoss(const std::string& src_ip,
-                                    uint32_t sent, uint32_t lost) {
-    if (sent == 0) return false;
-    double loss_rate = static_cast<double>(lost) / static_cast<double>(sent);
+bool AnomalyDetector::isPacketLoss(const SourceState& src) const {
+    if (src.sent == 0) return false;
+    double loss_rate = static_cast<double>(src.lost) / static_cast<double>(src.sent);
     return loss_rate > config_.packet_loss_threshold;
 }
 
-double AnomalyDetector::calculateSeverity(AnomalyType type,
-                                           const Packet& p) const {
+double AnomalyDetector::calculateSeverity(AnomalyType type, const Packet& p,
+                                           const SourceState& src) const {
     switch (type) {
         case AnomalyType::HIGH_LATENCY: {
             double ratio = p.latency_ms / config_.max_latency_ms;
             return std::min(1.0, ratio / 10.0);
         }
         case AnomalyType::FLOOD: {
-            double ratio = static_cast<double>(
-                packet_counts_.count(p.src_ip) ? packet_counts_.at(p.src_ip) : 0)
+            double ratio = static_cast<double>(src.window_count)
                 / static_cast<double>(config_.flood_threshold);
             return std::min(1.0, ratio / 2.0);
         }
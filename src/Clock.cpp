@@ -0,0 +1,47 @@
+#include "Clock.h"
+
+namespace anomaly {
+
+TimePoint SystemClock::now() const {
+    return std::chrono::system_clock::now();
+}
+
+MonotonicClock::MonotonicClock()
+    : wall_origin_(std::chrono::system_clock::now())
+    , steady_origin_(std::chrono::steady_clock::now()) {}
+
+TimePoint MonotonicClock::now() const {
+    auto elapsed = std::chrono::steady_clock::now() - steady_origin_;
+    return wall_origin_ +
+           std::chrono::duration_cast<TimePoint::duration>(elapsed);
+}
+
+VirtualClock::VirtualClock(TimePoint start)
+    : now_ns_(toNanos(start)) {}
+
+TimePoint VirtualClock::now() const {
+    return fromNanos(now_ns_.load(std::memory_order_acquire));
+}
+
+void VirtualClock::set(TimePoint t) {
+    now_ns_.store(toNanos(t), std::memory_order_release);
+}
+
+void VirtualClock::advance(std::chrono::nanoseconds delta) {
+    now_ns_.fetch_add(delta.count(), std::memory_order_acq_rel);
+}
+
+TimePoint EventClock::now() const {
+    return fromNanos(watermark_ns_.load(std::memory_order_acquire));
+}
+
+void EventClock::observe(TimePoint event_time) {
+    int64_t ns  = toNanos(event_time);
+    int64_t cur = watermark_ns_.load(std::memory_order_relaxed);
+    while (ns > cur &&
+           !watermark_ns_.compare_exchange_weak(cur, ns,
+                                                std::memory_order_acq_rel)) {
+    }
+}
+
+} // namespace anomaly
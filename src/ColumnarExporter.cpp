@@ -0,0 +1,162 @@
+#include "ColumnarExporter.h"
+#include "IpAddress.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <unordered_map>
+
+namespace anomaly {
+
+ColumnarExporter::ColumnarExporter(std::string path, ColumnarExportConfig config)
+    : path_(std::move(path))
+    , config_(std::move(config)) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path_, ec) || std::filesystem::file_size(path_, ec) == 0) {
+        create();
+    } else {
+        openExisting();
+    }
+}
+
+bool ColumnarExporter::openExisting() {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path_, ec);
+    if (ec || size < sizeof(columnar::FileHeader)) return false;
+    std::FILE* in = std::fopen(path_.c_str(), "rb");
+    if (!in) return false;
+    columnar::FileHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, in) == 1 &&
+              std::memcmp(header.magic, columnar::kFileMagic, sizeof(header.magic)) == 0 &&
+              header.version == columnar::kVersion;
+
+    // Walk the blocks. Only the last one may be cut short (a crash while
+    // appending); a bad block header anywhere means the file is not ours
+    // to append to.
+    auto padded = [](uint64_t bytes) { return (bytes + 7) & ~uint64_t{7}; };
+    uint64_t end = sizeof(header);
+    while (ok && end < size) {
+        columnar::BlockHeader block{};
+        size_t got = std::fseek(in, static_cast<long>(end), SEEK_SET) == 0
+                         ? std::fread(&block, 1, sizeof(block), in)
+                         : 0;
+        size_t magic = std::min(got, sizeof(block.magic));
+        if (magic == 0 || std::memcmp(block.magic, columnar::kBlockMagic, magic) != 0) {
+            ok = false;
+            break;
+        }
+        if (got < sizeof(block)) break;  // header itself cut short
+        uint64_t rows  = block.rows;
+        uint64_t bytes = sizeof(block) + 2 * padded(rows * 8) + 2 * padded(rows * 4) +
+                         2 * padded(rows) + block.dict_bytes;
+        if (end + bytes > size) break;
+        end += bytes;
+    }
+    std::fclose(in);
+    if (!ok) return false;
+
+    // Cut off the partial last block
+    if (end < size) {
+        std::filesystem::resize_file(path_, end, ec);
+        if (ec) return false;
+    }
+    file_ = std::fopen(path_.c_str(), "ab");
+    return file_ != nullptr;
+}
+
+void ColumnarExporter::create() {
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) return;
+    columnar::FileHeader header{};
+    std::memcpy(header.magic, columnar::kFileMagic, 4);
+    header.version = columnar::kVersion;
+    std::fwrite(&header, sizeof(header), 1, file_);
+}
+
+ColumnarExporter::~ColumnarExporter() {
+    if (file_) std::fclose(file_);
+}
+
+size_t ColumnarExporter::exportNew(const AlertManager& manager) {
+    uint64_t from  = cursor_;
+    auto alerts    = manager.getAlertsSince(cursor_);
+    uint64_t first = alerts.empty() ? cursor_ : alerts.front()->sequence;
+    missed_ += first - from;
+    if (alerts.empty() || !file_) return 0;
+
+    size_t step = std::max<uint32_t>(1, config_.rows_per_block);
+    for (size_t begin = 0; begin < alerts.size(); begin += step) {
+        writeBlock(alerts, begin, std::min(alerts.size(), begin + step));
+    }
+    std::fflush(file_);
+    return alerts.size();
+}
+
+void ColumnarExporter::writeBlock(const AlertSnapshot& alerts,
+                                  size_t begin, size_t end) {
+    size_t rows = end - begin;
+    ts_ns_.clear();
+    severity_.clear();
+    source_addr_.clear();
+    message_id_.clear();
+    level_.clear();
+    type_.clear();
+    dict_offsets_.assign(1, 0);
+    dict_text_.clear();
+
+    std::unordered_map<std::string_view, uint32_t> dict;
+    for (size_t i = begin; i < end; ++i) {
+        const Alert& a = *alerts[i];
+        uint32_t addr = 0;
+        parseIPv4(a.report.source_ip, addr);
+
+        auto [it, inserted] = dict.emplace(a.message,
+                                           static_cast<uint32_t>(dict.size()));
+        if (inserted) {
+            dict_text_ += a.message;
+            dict_offsets_.push_back(static_cast<uint32_t>(dict_text_.size()));
+        }
+
+        ts_ns_.push_back(toNanos(a.report.detected_at));
+        severity_.push_back(a.report.severity);
+        source_addr_.push_back(addr);
+        message_id_.push_back(it->second);
+        level_.push_back(static_cast<uint8_t>(a.level));
+        type_.push_back(static_cast<uint8_t>(a.report.type));
+    }
+
+    auto padded = [](size_t bytes) { return (bytes + 7) & ~size_t{7}; };
+    size_t offsets_bytes = dict_offsets_.size() * sizeof(uint32_t);
+
+    columnar::BlockHeader header{};
+    std::memcpy(header.magic, columnar::kBlockMagic, 4);
+    header.rows         = static_cast<uint32_t>(rows);
+    header.dict_entries = static_cast<uint32_t>(dict.size());
+    header.dict_bytes   = static_cast<uint32_t>(padded(offsets_bytes + dict_text_.size()));
+    header.first_seq    = alerts[begin]->sequence;
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    writePadded(ts_ns_.data(),       rows * sizeof(int64_t));
+    writePadded(severity_.data(),    rows * sizeof(double));
+    writePadded(source_addr_.data(), rows * sizeof(uint32_t));
+    writePadded(message_id_.data(),  rows * sizeof(uint32_t));
+    writePadded(level_.data(),       rows);
+    writePadded(type_.data(),        rows);
+
+    // Offsets and text are padded together, as one section
+    std::fwrite(dict_offsets_.data(), 1, offsets_bytes, file_);
+    std::fwrite(dict_text_.data(), 1, dict_text_.size(), file_);
+    pad(offsets_bytes + dict_text_.size());
+}
+
+void ColumnarExporter::writePadded(const void* data, size_t bytes) {
+    if (bytes) std::fwrite(data, 1, bytes, file_);
+    pad(bytes);
+}
+
+void ColumnarExporter::pad(size_t bytes) {
+    static const char zeros[8] = {};
+    size_t rem = bytes % 8;
+    if (rem) std::fwrite(zeros, 1, 8 - rem, file_);
+}
+
+} // namespace anomaly
@@ -0,0 +1,587 @@
+#include "FileIngest.h"
+#include "NetworkMonitor.h"
+#include "Affinity.h"
+#include "PacketRecord.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define ANOMALY_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace anomaly {
+
+// Reads blocks into a fixed set of buffers. submit() queues a read,
+// flush() starts everything queued, reap() collects finished reads.
+class FileIngest::Reader {
+public:
+    struct Completion {
+        size_t buffer;
+        int64_t result;  // bytes read, or -errno
+    };
+
+    Reader(size_t buffers, size_t block)
+        : count_(buffers), block_(block),
+          memory_(static_cast<char*>(std::aligned_alloc(4096, buffers * block))) {}
+    virtual ~Reader() { std::free(memory_); }
+
+    virtual const char* name() const = 0;
+    virtual void submit(int fd, uint64_t offset, size_t len, size_t buffer) = 0;
+    virtual void flush() = 0;
+    // Append finished reads to out; with wait, block until there is one
+    virtual void reap(std::vector<Completion>& out, bool wait) = 0;
+
+    char* buffer(size_t i) const { return memory_ + i * block_; }
+    size_t buffers() const { return count_; }
+    size_t blockSize() const { return block_; }
+
+protected:
+    size_t count_;
+    size_t block_;
+    char* memory_;
+};
+
+namespace {
+
+using Completion = FileIngest::Reader::Completion;
+
+// pread on a few threads; the fallback when io_uring is unavailable
+class PreadReader : public FileIngest::Reader {
+public:
+    PreadReader(size_t buffers, size_t block, size_t threads, int cpu)
+        : Reader(buffers, block) {
+        int node = numaNodeOfCpu(cpu);
+        for (size_t i = 0; i < std::max<size_t>(1, threads); ++i) {
+            threads_.emplace_back([this, node] {
+                if (node >= 0) preferNumaNode(node);
+                work();
+            });
+        }
+    }
+
+    ~PreadReader() override {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    const char* name() const override { return "pread"; }
+
+    void submit(int fd, uint64_t offset, size_t len, size_t buffer) override {
+        std::lock_guard<std::mutex> lock(mtx_);
+        queue_.push_back({fd, offset, len, buffer});
+    }
+
+    void flush() override { work_cv_.notify_all(); }
+
+    void reap(std::vector<Completion>& out, bool wait) override {
+        std::unique_lock<std::mutex> lock(mtx_);
+        if (wait) done_cv_.wait(lock, [this] { return !done_.empty(); });
+        out.insert(out.end(), done_.begin(), done_.end());
+        done_.clear();
+    }
+
+private:
+    struct Request {
+        int fd;
+        uint64_t offset;
+        size_t len;
+        size_t buffer;
+    };
+
+    std::mutex mtx_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::deque<Request> queue_;
+    std::vector<Completion> done_;
+    bool stopping_{false};
+    std::vector<std::thread> threads_;
+
+    void work() {
+        for (;;) {
+            Request r;
+            {
+                std::unique_lock<std::mutex> lock(mtx_);
+                work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (stopping_) return;
+                r = queue_.front();
+                queue_.pop_front();
+            }
+            // Loop over short reads so a completion is all of the block
+            size_t got = 0;
+            int64_t result = 0;
+            while (got < r.len) {
+                ssize_t n = ::pread(r.fd, buffer(r.buffer) + got, r.len - got,
+                                    static_cast<off_t>(r.offset + got));
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) {
+                    result = n < 0 ? -errno : static_cast<int64_t>(got);
+                    break;
+                }
+                got += static_cast<size_t>(n);
+                result = static_cast<int64_t>(got);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mtx_);
+                done_.push_back({r.buffer, result});
+            }
+            done_cv_.notify_one();
+        }
+    }
+};
+
+#ifdef ANOMALY_HAVE_IO_URING
+// Minimal io_uring over the raw syscalls: one submission and one
+// completion ring, buffers registered once for READ_FIXED (plain READ if
+// registration is refused, e.g. by RLIMIT_MEMLOCK).
+class UringReader : public FileIngest::Reader {
+public:
+    static std::unique_ptr<FileIngest::Reader> create(size_t buffers, size_t block) {
+        std::unique_ptr<UringReader> r(new UringReader(buffers, block));
+        if (!r->memory_ || !r->setup()) return nullptr;
+        return r;
+    }
+
+    ~UringReader() override {
+        if (sq_ptr_ != MAP_FAILED) ::munmap(sq_ptr_, sq_size_);
+        if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) ::munmap(cq_ptr_, cq_size_);
+        if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+    }
+
+    const char* name() const override { return "io_uring"; }
+
+    void submit(int fd, uint64_t offset, size_t len, size_t buffer) override {
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        io_uring_sqe& sqe = static_cast<io_uring_sqe*>(sqes_)[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode    = registered_ ? IORING_OP_READ_FIXED : IORING_OP_READ;
+        sqe.fd        = fd;
+        sqe.off       = offset;
+        sqe.addr      = reinterpret_cast<uint64_t>(this->buffer(buffer));
+        sqe.len       = static_cast<uint32_t>(len);
+        sqe.buf_index = static_cast<uint16_t>(buffer);
+        sqe.user_data = buffer;
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted_;
+        requested_[buffer] = {fd, offset, len};
+    }
+
+    void flush() override { enter(0); }
+
+    void reap(std::vector<Completion>& out, bool wait) override {
+        for (;;) {
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            bool any = false;
+            for (; head != tail; ++head) {
+                const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+                size_t buffer = static_cast<size_t>(cqe.user_data);
+                Request& req = requested_[buffer];
+                if (cqe.res > 0 && static_cast<size_t>(cqe.res) < req.len) {
+                    // Short read: fetch the rest of the block synchronously
+                    out.push_back({buffer, finishShortRead(buffer, cqe.res)});
+                } else {
+                    out.push_back({buffer, cqe.res});
+                }
+                any = true;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            if (any || !wait) return;
+            enter(1);
+        }
+    }
+
+private:
+    struct Request {
+        int fd;
+        uint64_t offset;
+        size_t len;
+    };
+
+    int ring_fd_{-1};
+    void* sq_ptr_{MAP_FAILED};
+    void* cq_ptr_{MAP_FAILED};
+    void* sqes_{MAP_FAILED};
+    size_t sq_size_{0}, cq_size_{0}, sqes_size_{0};
+    unsigned *sq_tail_{nullptr}, *sq_mask_{nullptr}, *sq_array_{nullptr};
+    unsigned *cq_head_{nullptr}, *cq_tail_{nullptr}, *cq_mask_{nullptr};
+    io_uring_cqe* cqes_{nullptr};
+    bool registered_{false};
+    unsigned unsubmitted_{0};
+    std::vector<Request> requested_;
+
+    UringReader(size_t buffers, size_t block)
+        : Reader(buffers, block), requested_(buffers) {}
+
+    bool setup() {
+        io_uring_params p{};
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup,
+                                              static_cast<unsigned>(count_), &p));
+        if (ring_fd_ < 0) return false;
+
+        sq_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+        sq_ptr_ = ::mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ptr_ == MAP_FAILED) return false;
+        cq_ptr_ = single ? sq_ptr_
+                         : ::mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) return false;
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        sqes_ = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        auto* sq = static_cast<char*>(sq_ptr_);
+        auto* cq = static_cast<char*>(cq_ptr_);
+        sq_tail_  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_  = reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cq_head_  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_  = reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_     = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+        std::vector<iovec> iov(count_);
+        for (size_t i = 0; i < count_; ++i) iov[i] = {buffer(i), block_};
+        registered_ = ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                                iov.data(), static_cast<unsigned>(count_)) == 0;
+        return true;
+    }
+
+    void enter(unsigned min_complete) {
+        unsigned flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+        for (;;) {
+            long n = ::syscall(__NR_io_uring_enter, ring_fd_, unsubmitted_, min_complete,
+                               flags, nullptr, 0);
+            if (n >= 0) {
+                unsubmitted_ -= std::min<unsigned>(unsubmitted_, static_cast<unsigned>(n));
+                return;
+            }
+            if (errno != EINTR) return;
+        }
+    }
+
+    int64_t finishShortRead(size_t buffer, int64_t got) {
+        const Request& req = requested_[buffer];
+        while (static_cast<size_t>(got) < req.len) {
+            ssize_t n = ::pread(req.fd, this->buffer(buffer) + got,
+                                req.len - static_cast<size_t>(got),
+                                static_cast<off_t>(req.offset + static_cast<uint64_t>(got)));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            got += n;
+        }
+        return got;
+    }
+};
+#endif
+
+struct FileState {
+    std::string path;
+    int fd{-1};
+    uint64_t size{0};
+    uint64_t next_offset{0};
+    bool failed{false};
+};
+
+// One block read, issued in file order and parsed in the same order
+struct Block {
+    size_t file;
+    uint64_t offset;
+    size_t len;
+    size_t buffer;
+    bool last;           // final block of its file
+    bool done{false};
+    int64_t result{0};
+};
+
+// Splits blocks into records and feeds them to the monitor in batches
+class BlockParser {
+public:
+    BlockParser(const PacketProcessor& parser, NetworkMonitor& monitor,
+                size_t batch_size, FileIngestStats& stats)
+        : parser_(parser), monitor_(monitor), batch_(std::max<size_t>(1, batch_size)),
+          stats_(stats) {}
+
+    ~BlockParser() { flush(); }
+
+    // First block of a file: detect the format. False for an unusable
+    // binary header.
+    bool beginFile(const char*& data, size_t& len) {
+        carry_.clear();
+        binary_ = false;
+        if (len >= sizeof(trace::FileHeader) &&
+            std::memcmp(data, trace::kMagic, sizeof(trace::kMagic)) == 0) {
+            trace::FileHeader header;
+            std::memcpy(&header, data, sizeof(header));
+            if (header.version != trace::kVersion ||
+                header.record_size != sizeof(trace::PacketRecord)) {
+                return false;
+            }
+            binary_ = true;
+            data += sizeof(header);
+            len  -= sizeof(header);
+        }
+        return true;
+    }
+
+    void parse(const char* data, size_t len, bool last) {
+        if (binary_) parseBinary(data, len, last);
+        else         parseText(data, len, last);
+    }
+
+    void flush() {
+        if (used_ == 0) return;
+        stats_.packets  += used_;
+        stats_.accepted += monitor_.feedBatch(batch_.data(), used_);
+        used_ = 0;
+    }
+
+private:
+    const PacketProcessor& parser_;
+    NetworkMonitor& monitor_;
+    std::vector<Packet> batch_;
+    size_t used_{0};
+    FileIngestStats& stats_;
+    bool binary_{false};
+    std::string carry_;  // record split across blocks
+
+    void commit() {
+        if (++used_ == batch_.size()) flush();
+    }
+
+    void line(std::string_view text) {
+        if (!text.empty() && text.back() == '\r') text.remove_suffix(1);
+        if (text.empty() || text.front() == '#') return;
+        if (parser_.parseInto(text, batch_[used_])) commit();
+        else ++stats_.skipped;
+    }
+
+    void parseText(const char* p, size_t len, bool last) {
+        const char* end = p + len;
+        if (!carry_.empty()) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', len));
+            if (!nl) {
+                carry_.append(p, len);
+                if (last) line(carry_);
+                if (last) carry_.clear();
+                return;
+            }
+            carry_.append(p, nl);
+            line(carry_);
+            carry_.clear();
+            p = nl + 1;
+        }
+        while (p < end) {
+            const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+            if (!nl) {
+                if (last) line(std::string_view(p, end - p));
+                else      carry_.assign(p, end);
+                break;
+            }
+            line(std::string_view(p, nl - p));
+            p = nl + 1;
+        }
+    }
+
+    void record(const char* bytes) {
+        trace::PacketRecord r;
+        std::memcpy(&r, bytes, sizeof(r));
+        Packet& pkt = batch_[used_];
+        trace::decodeRecord(r, pkt);
+        pkt.ingest_ns = 0;
+        pkt.trace_id  = 0;
+        commit();
+    }
+
+    void parseBinary(const char* p, size_t len, bool last) {
+        constexpr size_t kRecord = sizeof(trace::PacketRecord);
+        if (!carry_.empty()) {
+            size_t need = std::min(kRecord - carry_.size(), len);
+            carry_.append(p, need);
+            p += need;
+            len -= need;
+            if (carry_.size() == kRecord) {
+                record(carry_.data());
+                carry_.clear();
+            }
+        }
+        for (; len >= kRecord; p += kRecord, len -= kRecord) record(p);
+        if (len > 0) carry_.append(p, len);
+        if (last && !carry_.empty()) {
+            ++stats_.skipped;  // truncated final record
+            carry_.clear();
+        }
+    }
+};
+
+} // namespace
+
+FileIngest::FileIngest(FileIngestConfig config)
+    : config_(config) {
+    config_.queue_depth = std::max<size_t>(1, config_.queue_depth);
+    config_.block_size  = (std::max<size_t>(1, config_.block_size) + 4095) & ~size_t{4095};
+#ifdef ANOMALY_HAVE_IO_URING
+    if (config_.use_io_uring) {
+        reader_ = UringReader::create(config_.queue_depth, config_.block_size);
+    }
+#endif
+    if (!reader_) {
+        reader_ = std::make_unique<PreadReader>(config_.queue_depth, config_.block_size,
+                                                config_.threads, config_.cpu);
+    }
+}
+
+FileIngest::~FileIngest() = default;
+
+const char* FileIngest::backend() const {
+    return reader_->name();
+}
+
+std::vector<std::string> FileIngest::listDirectory(const std::string& dir) {
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (entry.is_regular_file(ec)) paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+FileIngestStats FileIngest::run(const std::vector<std::string>& paths,
+                                NetworkMonitor& monitor) {
+    FileIngestStats stats;
+    if (config_.cpu >= 0) {
+        monitor.notePlacement("file ingest", config_.cpu, placeCurrentThread(config_.cpu));
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<FileState> files(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) files[i].path = paths[i];
+
+    std::vector<size_t> free_buffers;
+    for (size_t i = reader_->buffers(); i-- > 0;) free_buffers.push_back(i);
+    std::deque<Block> window;               // issued, in parse order
+    std::vector<Block*> by_buffer(reader_->buffers(), nullptr);
+    std::vector<Completion> completions;
+    size_t issue_file = 0;
+    const size_t block = reader_->blockSize();
+
+    auto failFile = [&](FileState& f) {
+        if (!f.failed) ++stats.failed_files;
+        f.failed = true;
+    };
+
+    // Fill every free buffer with the next blocks, crossing into later files
+    auto issue = [&] {
+        bool submitted = false;
+        while (issue_file < files.size()) {
+            FileState& f = files[issue_file];
+            if (f.fd < 0 && !f.failed) {
+                f.fd = ::open(f.path.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat st{};
+                if (f.fd < 0 || ::fstat(f.fd, &st) != 0) {
+                    failFile(f);
+                } else {
+                    f.size = static_cast<uint64_t>(st.st_size);
+#ifdef POSIX_FADV_SEQUENTIAL
+                    ::posix_fadvise(f.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+                    if (f.size == 0) window.push_back({issue_file, 0, 0, 0, true, true, 0});
+                }
+            }
+            if (f.failed || f.next_offset >= f.size) {
+                ++issue_file;
+                continue;
+            }
+            if (free_buffers.empty()) break;
+            size_t buf = free_buffers.back();
+            free_buffers.pop_back();
+            size_t len = static_cast<size_t>(std::min<uint64_t>(block, f.size - f.next_offset));
+            bool last  = f.next_offset + len >= f.size;
+            window.push_back({issue_file, f.next_offset, len, buf, last});
+            by_buffer[buf] = &window.back();
+            reader_->submit(f.fd, f.next_offset, len, buf);
+            f.next_offset += len;
+            submitted = true;
+        }
+        if (submitted) reader_->flush();
+    };
+
+    {
+        BlockParser parser(parser_, monitor, config_.batch_size, stats);
+        issue();
+        while (!window.empty()) {
+            Block& b = window.front();
+            if (!b.done) {
+                completions.clear();
+                reader_->reap(completions, true);
+                for (const auto& c : completions) {
+                    by_buffer[c.buffer]->done   = true;
+                    by_buffer[c.buffer]->result = c.result;
+                    ++stats.reads;
+                }
+                continue;
+            }
+
+            FileState& f = files[b.file];
+            if (b.result < 0 || static_cast<size_t>(b.result) != b.len) {
+                failFile(f);
+            } else if (!f.failed) {
+                const char* data = reader_->buffer(b.buffer);
+                size_t len = b.len;
+                stats.bytes += len;
+                if (b.offset == 0 && !parser.beginFile(data, len)) failFile(f);
+                else parser.parse(data, len, b.last);
+            }
+            if (b.last) {
+                if (f.fd >= 0) ::close(f.fd);
+                f.fd = -1;
+                if (!f.failed) ++stats.files;
+            }
+            if (b.len) {
+                by_buffer[b.buffer] = nullptr;
+                free_buffers.push_back(b.buffer);
+            }
+            window.pop_front();
+            issue();
+        }
+        // Close files a read error left open
+        for (auto& f : files) {
+            if (f.fd >= 0) ::close(f.fd);
+        }
+    }
+
+    stats.seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    if (stats.seconds > 0.0) {
+        stats.mb_per_sec = static_cast<double>(stats.bytes) / 1e6 / stats.seconds;
+    }
+    return stats;
+}
+
+} // namespace anomaly
@@ -0,0 +1,287 @@
+#include "IngestServer.h"
+#include "NetworkMonitor.h"
+#include "Affinity.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace anomaly {
+
+namespace {
+// Parsed packets handed to feedBatch at most this many at a time
+constexpr size_t kFeedBatch = 512;
+
+struct IngestMetrics {
+    metrics::Counter& datagrams;
+    metrics::Counter& records;
+    metrics::Counter& errors;
+    metrics::Counter& drops;
+};
+
+const IngestMetrics& ingestMetrics() {
+    auto& r = metrics::Registry::global();
+    static const IngestMetrics m{
+        r.counter("anomaly_ingest_datagrams_total", "Datagrams received by IngestServer"),
+        r.counter("anomaly_ingest_records_total", "Records parsed and fed to the monitor"),
+        r.counter("anomaly_ingest_parse_errors_total", "Malformed ingest records"),
+        r.counter("anomaly_ingest_socket_drops_total",
+                  "Datagrams dropped by the kernel on a full receive buffer")};
+    return m;
+}
+
+int bindSocket(const IngestConfig& config, uint16_t& port) {
+    port = 0;
+    if (!config.unix_path.empty()) {
+        sockaddr_un addr{};
+        if (config.unix_path.size() >= sizeof(addr.sun_path)) return -1;
+        int fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) return -1;
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, config.unix_path.c_str(), config.unix_path.size() + 1);
+        ::unlink(config.unix_path.c_str());  // stale socket from a previous run
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(config.udp_port);
+    if (::inet_pton(AF_INET, config.udp_address.c_str(), &addr.sin_addr) != 1) return -1;
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &one, sizeof(one));
+    socklen_t len = sizeof(addr);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    port = ntohs(addr.sin_port);
+    return fd;
+}
+} // namespace
+
+struct IngestServer::ReceiveBuffers {
+    static constexpr size_t kControl = CMSG_SPACE(sizeof(uint32_t));
+
+    ReceiveBuffers(size_t count, size_t datagram)
+        : data(count * datagram), control(count * kControl),
+          iovecs(count), headers(count) {
+        for (size_t i = 0; i < count; ++i) {
+            iovecs[i].iov_base = data.data() + i * datagram;
+            iovecs[i].iov_len  = datagram;
+            headers[i].msg_hdr.msg_iov    = &iovecs[i];
+            headers[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    // recvmmsg shrinks msg_controllen to what it wrote; restore it
+    void reset() {
+        for (size_t i = 0; i < headers.size(); ++i) {
+            headers[i].msg_hdr.msg_control    = control.data() + i * kControl;
+            headers[i].msg_hdr.msg_controllen = kControl;
+            headers[i].msg_hdr.msg_flags      = 0;
+        }
+    }
+
+    std::vector<char> data;
+    std::vector<char> control;
+    std::vector<iovec> iovecs;
+    std::vector<mmsghdr> headers;
+};
+
+std::unique_ptr<IngestServer> IngestServer::create(NetworkMonitor& monitor,
+                                                   IngestConfig config) {
+    config.batch_size   = std::max<size_t>(1, config.batch_size);
+    config.max_datagram = std::max<size_t>(64, config.max_datagram);
+
+    uint16_t port = 0;
+    int fd = bindSocket(config, port);
+    if (fd < 0) return nullptr;
+    if (config.receive_buffer > 0) {
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &config.receive_buffer,
+                     sizeof(config.receive_buffer));
+    }
+
+    int epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+    int wake_fd  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    bool ok = epoll_fd >= 0 && wake_fd >= 0 &&
+              ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    ev.data.fd = wake_fd;
+    ok = ok && ::epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &ev) == 0;
+    if (!ok) {
+        if (epoll_fd >= 0) ::close(epoll_fd);
+        if (wake_fd >= 0) ::close(wake_fd);
+        ::close(fd);
+        if (!config.unix_path.empty()) ::unlink(config.unix_path.c_str());
+        return nullptr;
+    }
+    return std::unique_ptr<IngestServer>(
+        new IngestServer(monitor, std::move(config), fd, epoll_fd, wake_fd, port));
+}
+
+IngestServer::IngestServer(NetworkMonitor& monitor, IngestConfig config, int fd,
+                           int epoll_fd, int wake_fd, uint16_t port)
+    : monitor_(monitor), config_(std::move(config)), fd_(fd),
+      epoll_fd_(epoll_fd), wake_fd_(wake_fd), port_(port),
+      rx_(std::make_unique<ReceiveBuffers>(config_.batch_size, config_.max_datagram)),
+      batch_(kFeedBatch) {}
+
+IngestServer::~IngestServer() {
+    stop();
+    ::close(epoll_fd_);
+    ::close(wake_fd_);
+    ::close(fd_);
+    if (!config_.unix_path.empty()) ::unlink(config_.unix_path.c_str());
+}
+
+void IngestServer::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&IngestServer::receiveLoop, this);
+}
+
+void IngestServer::stop() {
+    if (!running_.exchange(false)) return;
+    uint64_t one = 1;
+    if (::write(wake_fd_, &one, sizeof(one)) < 0) {
+        // The counter only fails to grow when already signalled
+    }
+    if (thread_.joinable()) thread_.join();
+}
+
+IngestStats IngestServer::stats() const {
+    IngestStats s;
+    s.datagrams     = datagrams_.load(std::memory_order_relaxed);
+    s.records       = records_.load(std::memory_order_relaxed);
+    s.parse_errors  = parse_errors_.load(std::memory_order_relaxed);
+    s.rejected      = rejected_.load(std::memory_order_relaxed);
+    s.socket_drops  = socket_drops_.load(std::memory_order_relaxed);
+    s.receive_calls = receive_calls_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void IngestServer::receiveLoop() {
+    if (config_.cpu >= 0) {
+        bool pinned = placeCurrentThread(config_.cpu);
+        monitor_.notePlacement(config_.unix_path.empty() ? "udp ingest" : "unix ingest",
+                               config_.cpu, pinned);
+        // Reallocate the receive state from here so it is node-local
+        rx_ = std::make_unique<ReceiveBuffers>(config_.batch_size, config_.max_datagram);
+        batch_ = std::vector<Packet>(kFeedBatch);
+        used_  = 0;
+    }
+    epoll_event events[2];
+    while (running_.load(std::memory_order_relaxed)) {
+        int n = ::epoll_wait(epoll_fd_, events, 2, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.fd == fd_) {
+                if (!drainSocket()) return;
+            } else {
+                // Reset the eventfd so a restart waits again
+                uint64_t value;
+                if (::read(wake_fd_, &value, sizeof(value)) < 0) {
+                    // Already reset
+                }
+            }
+        }
+    }
+    // Take what arrived before stop()
+    drainSocket();
+}
+
+bool IngestServer::drainSocket() {
+    const auto& m = ingestMetrics();
+    auto& headers = rx_->headers;
+    for (;;) {
+        rx_->reset();
+        int got = ::recvmmsg(fd_, headers.data(), static_cast<unsigned>(headers.size()),
+                             MSG_DONTWAIT, nullptr);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        if (got == 0) return true;
+
+        uint64_t errors_before = parse_errors_.load(std::memory_order_relaxed);
+        uint64_t drops = 0;
+        bool have_drops = false;
+        for (int i = 0; i < got; ++i) {
+            msghdr& msg = headers[i].msg_hdr;
+            for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+                if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                    uint32_t count;
+                    std::memcpy(&count, CMSG_DATA(c), sizeof(count));
+                    drops      = count;
+                    have_drops = true;
+                }
+            }
+            if (msg.msg_flags & MSG_TRUNC) {
+                parse_errors_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            parseDatagram(static_cast<const char*>(rx_->iovecs[i].iov_base),
+                          headers[i].msg_len);
+        }
+        flushBatch();
+
+        datagrams_.fetch_add(static_cast<uint64_t>(got), std::memory_order_relaxed);
+        receive_calls_.fetch_add(1, std::memory_order_relaxed);
+        m.datagrams.inc(static_cast<uint64_t>(got));
+        m.errors.inc(parse_errors_.load(std::memory_order_relaxed) - errors_before);
+        // The kernel reports a running total for the socket
+        if (have_drops) {
+            uint64_t prev = socket_drops_.load(std::memory_order_relaxed);
+            if (drops > prev) {
+                m.drops.inc(drops - prev);
+                socket_drops_.store(drops, std::memory_order_relaxed);
+            }
+        }
+        if (static_cast<size_t>(got) < headers.size()) return true;
+    }
+}
+
+void IngestServer::parseDatagram(const char* data, size_t len) {
+    const char* end = data + len;
+    while (data < end) {
+        const char* nl = static_cast<const char*>(std::memchr(data, '\n', end - data));
+        const char* line_end = nl ? nl : end;
+        if (line_end != data) {
+            if (parser_.parseInto(std::string_view(data, line_end - data), batch_[used_])) {
+                if (++used_ == batch_.size()) flushBatch();
+            } else {
+                parse_errors_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        data = line_end + 1;
+    }
+}
+
+void IngestServer::flushBatch() {
+    if (used_ == 0) return;
+    size_t accepted = monitor_.feedBatch(batch_.data(), used_);
+    records_.fetch_add(used_, std::memory_order_relaxed);
+    rejected_.fetch_add(used_ - accepted, std::memory_order_relaxed);
+    ingestMetrics().records.inc(used_);
+    used_ = 0;
+}
+
+} // namespace anomaly
@@ -0,0 +1,47 @@
+#include "IpAddress.h"
+
+namespace anomaly {
+
+bool parseIPv4(std::string_view text, uint32_t& out) {
+    uint32_t addr   = 0;
+    uint32_t octet  = 0;
+    int      digits = 0;
+    int      dots   = 0;
+
+    for (char c : text) {
+        if (c >= '0' && c <= '9') {
+            octet = octet * 10 + static_cast<uint32_t>(c - '0');
+            if (++digits > 3 || octet > 255) return false;
+        } else if (c == '.') {
+            if (digits == 0 || ++dots > 3) return false;
+            addr   = (addr << 8) | octet;
+            octet  = 0;
+            digits = 0;
+        } else {
+            return false;
+        }
+    }
+    if (dots != 3 || digits == 0) return false;
+
+    out = (addr << 8) | octet;
+    return true;
+}
+
+std::string formatIPv4(uint32_t addr) {
+    char buf[16];
+    return std::string(buf, formatIPv4(addr, buf));
+}
+
+size_t formatIPv4(uint32_t addr, char* out) {
+    char* p = out;
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        uint32_t octet = (addr >> shift) & 0xFF;
+        if (octet >= 100) *p++ = static_cast<char>('0' + octet / 100);
+        if (octet >= 10)  *p++ = static_cast<char>('0' + octet / 10 % 10);
+        *p++ = static_cast<char>('0' + octet % 10);
+        if (shift) *p++ = '.';
+    }
+    return static_cast<size_t>(p - out);
+}
+
+} // namespace anomaly
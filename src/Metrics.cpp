@@ -0,0 +1,248 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+
+namespace anomaly {
+namespace metrics {
+
+size_t assignShard() {
+    static std::atomic<size_t> next{0};
+    return next.fetch_add(1, std::memory_order_relaxed) % kShards;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& c : cells_) total += c.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+void Gauge::set(int64_t v) {
+    for (size_t i = 1; i < kShards; ++i) {
+        cells_[i].value.store(0, std::memory_order_relaxed);
+    }
+    cells_[0].value.store(v, std::memory_order_relaxed);
+}
+
+int64_t Gauge::value() const {
+    int64_t total = 0;
+    for (const auto& c : cells_) total += c.value.load(std::memory_order_relaxed);
+    return total;
+}
+
+Histogram::Histogram(double scale)
+    : scale_(scale)
+    , shards_(kEnabled ? new Shard[kShards] : nullptr) {}
+
+uint64_t Histogram::bucketUpper(size_t i) {
+    if (i < kSub) return i;
+    int exp    = static_cast<int>(i / kSub) + kSubBits - 1;
+    uint64_t w = uint64_t{1} << (exp - kSubBits);
+    return ((kSub + i % kSub) << (exp - kSubBits)) + w - 1;
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot snap;
+    snap.counts.assign(kBuckets, 0);
+    if (!shards_) return snap;
+    for (size_t s = 0; s < kShards; ++s) {
+        const Shard& shard = shards_[s];
+        for (size_t i = 0; i < kBuckets; ++i) {
+            uint64_t n = shard.counts[i].load(std::memory_order_relaxed);
+            snap.counts[i] += n;
+            snap.count     += n;
+        }
+        snap.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+}
+
+uint64_t Histogram::Snapshot::quantile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::clamp(q, 0.0, 1.0) *
+                                          static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return bucketUpper(i);
+    }
+    return bucketUpper(counts.size() - 1);
+}
+
+Registry& Registry::global() {
+    static Registry registry;
+    return registry;
+}
+
+Registry::Entry& Registry::entryLocked(const std::string& name,
+                                       const std::string& help, Type type) {
+    for (auto& e : entries_) {
+        if (e->name == name && e->type == type) return *e;
+    }
+    auto e  = std::make_unique<Entry>();
+    e->name = name;
+    e->help = help;
+    e->type = type;
+    entries_.push_back(std::move(e));
+    return *entries_.back();
+}
+
+Counter& Registry::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry& e = entryLocked(name, help, Type::COUNTER);
+    if (!e.counter) e.counter = std::make_unique<Counter>();
+    return *e.counter;
+}
+
+Gauge& Registry::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry& e = entryLocked(name, help, Type::GAUGE);
+    if (!e.gauge) e.gauge = std::make_unique<Gauge>();
+    return *e.gauge;
+}
+
+Histogram& Registry::histogram(const std::string& name, const std::string& help,
+                               double scale) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    Entry& e = entryLocked(name, help, Type::HISTOGRAM);
+    if (!e.histogram) e.histogram = std::make_unique<Histogram>(scale);
+    return *e.histogram;
+}
+
+namespace {
+
+// "name{a=\"b\"}" -> ("name", "a=\"b\"")
+std::pair<std::string, std::string> splitName(const std::string& name) {
+    auto brace = name.find('{');
+    if (brace == std::string::npos) return {name, ""};
+    std::string labels = name.substr(brace + 1);
+    if (!labels.empty() && labels.back() == '}') labels.pop_back();
+    return {name.substr(0, brace), labels};
+}
+
+std::string sampleName(const std::string& family, const std::string& suffix,
+                       const std::string& labels, const std::string& extra = "") {
+    std::string out = family + suffix;
+    if (labels.empty() && extra.empty()) return out;
+    out += '{';
+    out += labels;
+    if (!labels.empty() && !extra.empty()) out += ',';
+    out += extra;
+    out += '}';
+    return out;
+}
+
+std::string formatValue(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+void writeHistogram(std::string& out, const std::string& family,
+                    const std::string& labels, const Histogram& h) {
+    auto snap = h.snapshot();
+    // Cumulative buckets at powers of two, up to the highest one in use
+    size_t last = 0;
+    for (size_t i = 0; i < snap.counts.size(); ++i) {
+        if (snap.counts[i]) last = i;
+    }
+    uint64_t limit = Histogram::bucketUpper(last);
+    uint64_t cumulative = 0;
+    size_t i = 0;
+    for (uint64_t bound = 0;; bound = bound * 2 + 1) {
+        while (i < snap.counts.size() && Histogram::bucketUpper(i) <= bound) {
+            cumulative += snap.counts[i++];
+        }
+        out += sampleName(family, "_bucket", labels,
+                          "le=\"" + formatValue(static_cast<double>(bound) * h.scale()) + "\"");
+        out += ' ' + std::to_string(cumulative) + '\n';
+        if (bound >= limit) break;
+    }
+    out += sampleName(family, "_bucket", labels, "le=\"+Inf\"") + ' ' +
+           std::to_string(snap.count) + '\n';
+    out += sampleName(family, "_sum", labels) + ' ' +
+           formatValue(static_cast<double>(snap.sum) * h.scale()) + '\n';
+    out += sampleName(family, "_count", labels) + ' ' + std::to_string(snap.count) + '\n';
+}
+
+} // namespace
+
+std::string Registry::prometheusText() const {
+    if constexpr (!kEnabled) return "# metrics disabled at build time\n";
+
+    std::lock_guard<std::mutex> lock(mtx_);
+    // Group by family, keeping registration order within each
+    std::map<std::string, std::vector<const Entry*>> families;
+    for (const auto& e : entries_) families[splitName(e->name).first].push_back(e.get());
+
+    std::string out;
+    for (const auto& [family, members] : families) {
+        const Entry& first = *members.front();
+        const char* type = first.type == Type::COUNTER ? "counter"
+                         : first.type == Type::GAUGE   ? "gauge"
+                                                       : "histogram";
+        out += "# HELP " + family + ' ' + first.help + '\n';
+        out += "# TYPE " + family + ' ' + type + '\n';
+        for (const Entry* e : members) {
+            std::string labels = splitName(e->name).second;
+            switch (e->type) {
+                case Type::COUNTER:
+                    if (e->counter) {
+                        out += sampleName(family, "", labels) + ' ' +
+                               std::to_string(e->counter->value()) + '\n';
+                    }
+                    break;
+                case Type::GAUGE:
+                    if (e->gauge) {
+                        out += sampleName(family, "", labels) + ' ' +
+                               std::to_string(e->gauge->value()) + '\n';
+                    }
+                    break;
+                case Type::HISTOGRAM:
+                    if (e->histogram) writeHistogram(out, family, labels, *e->histogram);
+                    break;
+            }
+        }
+    }
+    return out;
+}
+
+bool Registry::writePrometheusFile(const std::string& path) const {
+    std::string text = prometheusText();
+    std::string tmp  = path + ".tmp";
+    std::FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), f) == text.size();
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+FileExporter::FileExporter(std::string path, std::chrono::milliseconds interval,
+                           const Registry& registry)
+    : path_(std::move(path))
+    , interval_(interval)
+    , registry_(registry) {
+    thread_ = std::thread([this] {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (!stopping_) {
+            cv_.wait_for(lock, interval_, [this] { return stopping_; });
+            registry_.writePrometheusFile(path_);
+        }
+    });
+}
+
+FileExporter::~FileExporter() {
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        stopping_ = true;
+    }
+    cv_.notify_one();
+    thread_.join();
+}
+
+} // namespace metrics
+} // namespace anomaly
@@ -0,0 +1,102 @@
+#include "NdjsonExporter.h"
+#include "JsonUtil.h"
+#include <algorithm>
+#include <filesystem>
+
+namespace anomaly {
+
+NdjsonExporter::NdjsonExporter(std::string path, NdjsonExportConfig config)
+    : path_(std::move(path))
+    , config_(std::move(config)) {
+    open();
+}
+
+NdjsonExporter::~NdjsonExporter() {
+    if (file_) std::fclose(file_);
+}
+
+size_t NdjsonExporter::exportNew(const AlertManager& manager) {
+    uint64_t from = cursor_;
+    auto alerts   = manager.getAlertsSince(cursor_);
+    uint64_t first = alerts.empty() ? cursor_ : alerts.front()->sequence;
+    stats_.missed += first - from;
+    if (alerts.empty() || !file_) return 0;
+
+    buffer_.clear();
+    for (const auto& a : alerts) {
+        appendLine(buffer_, *a);
+        // Rotate between lines so no record straddles two files
+        if (config_.max_bytes && file_bytes_ + buffer_.size() >= config_.max_bytes) {
+            writeBuffer();
+            rotateIfDue();
+        }
+    }
+    writeBuffer();
+    rotateIfDue();
+
+    stats_.exported += alerts.size();
+    return alerts.size();
+}
+
+void NdjsonExporter::appendLine(std::string& out, const Alert& a) {
+    out += "{\"seq\":";
+    appendJsonNumber(out, a.sequence);
+    out += ",\"timestamp\":";
+    appendJsonString(out, a.timestamp_str);
+    out += ",\"ts_ns\":";
+    appendJsonNumber(out, toNanos(a.report.detected_at));
+    out += ",\"level\":\"";
+    out += alertLevelName(a.level);
+    out += "\",\"type\":\"";
+    out += anomalyTypeName(a.report.type);
+    out += "\",\"message\":";
+    appendJsonString(out, a.message);
+    out += ",\"source_ip\":";
+    appendJsonString(out, a.report.source_ip);
+    out += ",\"severity\":";
+    appendJsonNumber(out, a.report.severity);
+    out += "}\n";
+}
+
+void NdjsonExporter::writeBuffer() {
+    if (!file_ || buffer_.empty()) return;
+    std::fwrite(buffer_.data(), 1, buffer_.size(), file_);
+    std::fflush(file_);
+    file_bytes_ += buffer_.size();
+    buffer_.clear();
+}
+
+void NdjsonExporter::open() {
+    file_ = std::fopen(path_.c_str(), "ab");
+    std::error_code ec;
+    auto size   = std::filesystem::file_size(path_, ec);
+    file_bytes_ = ec ? 0 : size;
+    opened_at_  = std::chrono::steady_clock::now();
+}
+
+void NdjsonExporter::rotateIfDue() {
+    bool by_size = config_.max_bytes && file_bytes_ >= config_.max_bytes;
+    bool by_age  = config_.max_age_sec &&
+                   std::chrono::steady_clock::now() - opened_at_ >=
+                       std::chrono::seconds(config_.max_age_sec);
+    if (!by_size && !by_age) return;
+    if (file_bytes_ == 0) return;
+
+    if (file_) std::fclose(file_);
+    file_ = nullptr;
+
+    // path.N-1 -> path.N, ..., path -> path.1
+    std::error_code ec;
+    uint32_t keep = std::max<uint32_t>(1, config_.max_files);
+    std::filesystem::remove(path_ + "." + std::to_string(keep), ec);
+    for (uint32_t i = keep; i > 1; --i) {
+        std::filesystem::rename(path_ + "." + std::to_string(i - 1),
+                                path_ + "." + std::to_string(i), ec);
+    }
+    std::filesystem::rename(path_, path_ + ".1", ec);
+
+    ++stats_.rotations;
+    open();
+}
+
+} // namespace anomaly
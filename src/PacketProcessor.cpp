@@ -1,26 +1,97 @@
 #include "PacketProcessor.h"
+#include "Metrics.h"
+#include <charconv>
 #include <sstream>
-#include <regex>
 #include <stdexcept>
+#include <cstdio>
 
 namespace anomaly {
 
+namespace {
+struct ParseMetrics {
+    metrics::Counter& parsed;
+    metrics::Counter& errors;
+    metrics::Histogram& seconds;
+};
+
+const ParseMetrics& parseMetrics() {
+    auto& r = metrics::Registry::global();
+    static const ParseMetrics m{
+        r.counter("anomaly_packets_parsed_total", "Raw packets passed to parsePacket"),
+        r.counter("anomaly_parse_errors_total", "Raw packets that failed to parse"),
+        r.histogram("anomaly_parse_seconds", "parsePacket time (1 in 16 sampled)", 1e-9)};
+    return m;
+}
+
+// The whole of s must be the number
+template <typename T>
+bool parseNumber(std::string_view s, T& value) {
+    const char* end = s.data() + s.size();
+    auto result = std::from_chars(s.data(), end, value);
+    return !s.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+// Four dot-separated groups of 1-3 digits, each at most 255; scanned in
+// place, as a regex match allocates on every call
+bool isDottedQuad(std::string_view rest) {
+    for (int i = 0; i < 4; ++i) {
+        size_t dot = i < 3 ? rest.find('.') : rest.size();
+        if (dot == std::string_view::npos || dot == 0 || dot > 3) return false;
+        unsigned octet = 0;
+        for (char c : rest.substr(0, dot)) {
+            if (c < '0' || c > '9') return false;
+            octet = octet * 10 + static_cast<unsigned>(c - '0');
+        }
+        if (octet > 255) return false;
+        rest.remove_prefix(i < 3 ? dot + 1 : dot);
+    }
+    return true;
+}
+
+// "ip:port"; the last ':' splits them, and ip must be a dotted quad
+bool parseEndpoint(std::string_view s, std::string& ip, uint16_t& port) {
+    size_t colon = s.rfind(':');
+    if (colon == std::string_view::npos || !isDottedQuad(s.substr(0, colon))) return false;
+    ip.assign(s.data(), colon);
+    return parseNumber(s.substr(colon + 1), port);
+}
+
+// Field up to the next '|' (or the rest); advances past the separator
+std::string_view nextField(std::string_view& rest) {
+    size_t bar = rest.find('|');
+    std::string_view field = rest.substr(0, bar);
+    rest = bar == std::string_view::npos ? std::string_view{} : rest.substr(bar + 1);
+    return field;
+}
+} // namespace
+
 PacketProcessor::PacketProcessor() = default;
 
 Packet PacketProcessor::parsePacket(const std::string& raw_data) const {
-    // Format: "src_ip:src_port->dst_ip:dst_port|size|latency"
+    const auto& m = parseMetrics();
+    int64_t start = metrics::kEnabled && metrics::sampled() ? metrics::startTimer() : 0;
+    Packet packet = parseFields(raw_data);
+    if (start) m.seconds.observeSince(start);
+    m.parsed.inc();
+    if (packet.src_ip.empty()) m.errors.inc();
+    return packet;
+}
+
+Packet PacketProcessor::parseFields(const std::string& raw_data) const {
+    // Format: "src_ip:src_port->dst_ip:dst_port|size|latency[|timestamp_ns]"
     // Example: "192.168.1.1:5000->10.0.0.1:80|1024|12.5"
     Packet packet;
     try {
         std::istringstream ss(raw_data);
-        std::string src_part, dst_part, size_str, latency_str;
+        std::string src_part, dst_part, size_str, latency_str, ts_str;
 
         std::getline(ss, src_part, '-');
         std::string arrow;
         std::getline(ss, arrow, '>'); // consume '>'
         std::getline(ss, dst_part, '|');
         std::getline(ss, size_str, '|');
-        std::getline(ss, latency_str);
+        std::getline(ss, latency_str, '|');
+        std::getline(ss, ts_str);
 
         // Parse src
         auto src_colon = src_part.rfind(':');
@@ -35,6 +106,7 @@ Packet PacketProcessor::parsePacket(const std::string& raw_data) const {
         packet.size_bytes = static_cast<uint32_t>(std::stoul(size_str));
         packet.latency_ms = std::stod(latency_str);
         packet.protocol   = detectProtocol(packet.dst_port);
+        if (!ts_str.empty()) packet.timestamp = fromNanos(std::stoll(ts_str));
 
     } catch (const std::exception&) {
         // Return empty packet on parse failure
@@ -43,6 +115,42 @@ Packet PacketProcessor::parsePacket(const std::string& raw_data) const {
     return packet;
 }
 
+bool PacketProcessor::parseInto(std::string_view raw, Packet& out) const {
+    while (!raw.empty() && (raw.back() == '\n' || raw.back() == '\r')) raw.remove_suffix(1);
+    size_t arrow = raw.find("->");
+    if (arrow == std::string_view::npos) return false;
+    if (!parseEndpoint(raw.substr(0, arrow), out.src_ip, out.src_port)) return false;
+
+    std::string_view rest = raw.substr(arrow + 2);
+    if (!parseEndpoint(nextField(rest), out.dst_ip, out.dst_port)) return false;
+    if (!parseNumber(nextField(rest), out.size_bytes)) return false;
+    if (!parseNumber(nextField(rest), out.latency_ms)) return false;
+
+    std::string_view ts = nextField(rest);
+    int64_t ts_ns = 0;
+    if (!rest.empty() || (!ts.empty() && !parseNumber(ts, ts_ns))) return false;
+    out.timestamp = ts.empty() ? TimePoint{} : fromNanos(ts_ns);
+
+    out.protocol  = detectProtocol(out.dst_port);
+    out.teid      = 0;
+    out.ingest_ns = 0;
+    out.trace_id  = 0;
+    return out.size_bytes > 0 && out.latency_ms >= 0.0;
+}
+
+std::string PacketProcessor::formatPacket(const Packet& packet) const {
+    std::string out = packet.src_ip + ":" + std::to_string(packet.src_port) + "->" +
+                      packet.dst_ip + ":" + std::to_string(packet.dst_port) + "|" +
+                      std::to_string(packet.size_bytes) + "|";
+    char latency[32];
+    std::snprintf(latency, sizeof(latency), "%.17g", packet.latency_ms);
+    out += latency;
+    if (hasTimestamp(packet.timestamp)) {
+        out += "|" + std::to_string(toNanos(packet.timestamp));
+    }
+    return out;
+}
+
 bool PacketProcessor::isValidPacket(const Packet& packet) const {
     if (packet.src_ip.empty() || packet.dst_ip.empty()) return false;
     if (!isValidIP(packet.src_ip) || !isValidIP(packet.dst_ip)) return false;
@@ -73,22 +181,14 @@ std::vector<Packet> PacketProcessor::processBatch(
     for (const auto& raw : raw_packets) {
         auto pkt = parsePacket(raw);
         if (isValidPacket(pkt)) {
-            result.push_back(pkt);
+            result.push_back(std::move(pkt));
         }
     }
     return result;
 }
 
-bool PacketProcessor::isValidIP(const std::string& ip) const {
-    static const std::regex ip_regex(
-        R"(^(\d{1,3})\.(\d{1,3})\.(\d{1,3})\.(\d{1,3})$)");
-    std::smatch match;
-    if (!std::regex_match(ip, match, ip_regex)) return false;
-    for (int i = 1; i <= 4; ++i) {
-        int octet = std::stoi(match[i].str());
-        if (octet < 0 || octet > 255) return false;
-    }
-    return true;
+bool PacketProcessor::isValidIP(std::string_view ip) const {
+    return isDottedQuad(ip);
 }
 
 } // namespace anomaly
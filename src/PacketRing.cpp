@@ -0,0 +1,179 @@
+#include "PacketRing.h"
+#include "NetworkMonitor.h"
+#include "Affinity.h"
+#include "RingBuffer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace anomaly {
+
+namespace {
+bool validHeader(const SharedMemoryRegion& region) {
+    if (region.size() < ring::kRecordsOffset) return false;
+    const auto* header = static_cast<const ring::RingHeader*>(region.data());
+    uint64_t capacity = header->capacity;
+    return std::memcmp(header->magic, ring::kMagic, sizeof(ring::kMagic)) == 0 &&
+           header->version == ring::kVersion &&
+           header->record_size == sizeof(trace::PacketRecord) &&
+           capacity != 0 && (capacity & (capacity - 1)) == 0 &&
+           region.size() >= ring::kRecordsOffset + capacity * sizeof(trace::PacketRecord);
+}
+} // namespace
+
+std::unique_ptr<PacketRingProducer> PacketRingProducer::open(const std::string& name) {
+    auto region = SharedMemoryRegion::open(name, true);
+    if (!region || !validHeader(*region)) return nullptr;
+    return std::unique_ptr<PacketRingProducer>(new PacketRingProducer(std::move(region)));
+}
+
+PacketRingProducer::PacketRingProducer(std::unique_ptr<SharedMemoryRegion> region)
+    : region_(std::move(region))
+    , header_(static_cast<ring::RingHeader*>(region_->data()))
+    , records_(reinterpret_cast<trace::PacketRecord*>(
+          static_cast<char*>(region_->data()) + ring::kRecordsOffset))
+    , capacity_(header_->capacity)
+    , write_seq_(header_->write_seq.load(std::memory_order_relaxed))
+    , cached_read_(header_->read_seq.load(std::memory_order_acquire)) {}
+
+size_t PacketRingProducer::tryPush(const trace::PacketRecord* records, size_t count) {
+    if (write_seq_ - cached_read_ + count > capacity_) {
+        cached_read_ = header_->read_seq.load(std::memory_order_acquire);
+    }
+    size_t n = static_cast<size_t>(
+        std::min<uint64_t>(count, capacity_ - (write_seq_ - cached_read_)));
+    // At most two contiguous runs, split at the end of the ring
+    size_t done = 0;
+    while (done < n) {
+        uint64_t slot = (write_seq_ + done) & (capacity_ - 1);
+        size_t run = static_cast<size_t>(std::min<uint64_t>(n - done, capacity_ - slot));
+        std::memcpy(&records_[slot], records + done, run * sizeof(trace::PacketRecord));
+        done += run;
+    }
+    write_seq_ += n;
+    if (n > 0) header_->write_seq.store(write_seq_, std::memory_order_release);
+    return n;
+}
+
+void PacketRingProducer::countDropped(uint64_t n) {
+    header_->dropped.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::unique_ptr<PacketRingConsumer> PacketRingConsumer::create(const std::string& name,
+                                                               size_t capacity) {
+    uint64_t slots = 1;
+    while (slots < capacity) slots <<= 1;
+
+    auto region = SharedMemoryRegion::create(
+        name, ring::kRecordsOffset + slots * sizeof(trace::PacketRecord));
+    if (!region) return nullptr;
+
+    // The region is zero-filled: both sequences start at 0 (empty)
+    auto* header = new (region->data()) ring::RingHeader;
+    std::memcpy(header->magic, ring::kMagic, sizeof(ring::kMagic));
+    header->version     = ring::kVersion;
+    header->record_size = sizeof(trace::PacketRecord);
+    header->capacity    = slots;
+    header->write_seq.store(0, std::memory_order_relaxed);
+    header->dropped.store(0, std::memory_order_relaxed);
+    header->read_seq.store(0, std::memory_order_release);
+
+    return std::unique_ptr<PacketRingConsumer>(new PacketRingConsumer(std::move(region)));
+}
+
+PacketRingConsumer::PacketRingConsumer(std::unique_ptr<SharedMemoryRegion> region)
+    : region_(std::move(region))
+    , header_(static_cast<ring::RingHeader*>(region_->data()))
+    , records_(reinterpret_cast<const trace::PacketRecord*>(
+          static_cast<const char*>(region_->data()) + ring::kRecordsOffset))
+    , capacity_(header_->capacity) {}
+
+size_t PacketRingConsumer::peek(const trace::PacketRecord*& first, size_t max) {
+    if (cached_write_ == read_seq_) {
+        cached_write_ = header_->write_seq.load(std::memory_order_acquire);
+        if (cached_write_ == read_seq_) return 0;
+    }
+    uint64_t slot = read_seq_ & (capacity_ - 1);
+    uint64_t n = std::min<uint64_t>({cached_write_ - read_seq_, capacity_ - slot, max});
+    first = &records_[slot];
+    return static_cast<size_t>(n);
+}
+
+void PacketRingConsumer::release(size_t n) {
+    read_seq_ += n;
+    header_->read_seq.store(read_seq_, std::memory_order_release);
+}
+
+uint64_t PacketRingConsumer::dropped() const {
+    return header_->dropped.load(std::memory_order_relaxed);
+}
+
+PacketRingIngest::PacketRingIngest(std::unique_ptr<PacketRingConsumer> consumer,
+                                   NetworkMonitor& monitor, RingIngestConfig config)
+    : consumer_(std::move(consumer)), monitor_(monitor), config_(config) {
+    config_.batch_size = std::max<size_t>(1, config_.batch_size);
+}
+
+PacketRingIngest::~PacketRingIngest() {
+    stop();
+}
+
+void PacketRingIngest::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&PacketRingIngest::run, this);
+}
+
+void PacketRingIngest::stop() {
+    if (!running_.exchange(false)) return;
+    if (thread_.joinable()) thread_.join();
+}
+
+RingIngestStats PacketRingIngest::stats() const {
+    RingIngestStats s;
+    s.records  = records_.load(std::memory_order_relaxed);
+    s.accepted = accepted_.load(std::memory_order_relaxed);
+    s.batches  = batches_.load(std::memory_order_relaxed);
+    s.dropped  = consumer_->dropped();
+    return s;
+}
+
+size_t PacketRingIngest::drainOnce(std::vector<Packet>& batch) {
+    const trace::PacketRecord* first = nullptr;
+    size_t n = consumer_->peek(first, batch.size());
+    if (n == 0) return 0;
+    for (size_t i = 0; i < n; ++i) {
+        Packet& pkt = batch[i];
+        trace::decodeRecord(first[i], pkt);
+        pkt.ingest_ns = 0;
+        pkt.trace_id  = 0;
+    }
+    // Decoded into our own packets: the slots can go back right away
+    consumer_->release(n);
+
+    size_t accepted = monitor_.feedBatch(batch.data(), n);
+    records_.fetch_add(n, std::memory_order_relaxed);
+    accepted_.fetch_add(accepted, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    return n;
+}
+
+void PacketRingIngest::run() {
+    if (config_.cpu >= 0) {
+        monitor_.notePlacement("ring ingest", config_.cpu, placeCurrentThread(config_.cpu));
+    }
+    std::vector<Packet> batch(config_.batch_size);
+    int idle = 0;
+    while (running_.load(std::memory_order_relaxed)) {
+        if (drainOnce(batch) > 0) {
+            idle = 0;
+        } else if (++idle < config_.idle_spins) {
+            cpuRelax();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(config_.idle_sleep_us));
+        }
+    }
+    while (drainOnce(batch) > 0) {}
+}
+
+} // namespace anomaly
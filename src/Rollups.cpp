@@ -0,0 +1,536 @@
+#include "Rollups.h"
+#include "AnomalyDetector.h"
+#include "IpAddress.h"
+#include "NetworkMonitor.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace anomaly {
+
+namespace {
+// Latency histogram: like metrics::Histogram, but 8 sub-buckets per power
+// of two (so a bucket is known to within 1/8) over 1 us .. 2^28 us
+constexpr int kSubBits     = 3;
+constexpr size_t kSub      = size_t{1} << kSubBits;
+constexpr int kMaxExponent = 27;
+
+size_t latencyBucket(uint64_t us) {
+    if (us < kSub) return static_cast<size_t>(us);
+    int exp = 63 - __builtin_clzll(us);
+    if (exp > kMaxExponent) return (kMaxExponent - kSubBits + 2) * kSub - 1;
+    size_t sub = static_cast<size_t>(us >> (exp - kSubBits)) & (kSub - 1);
+    return static_cast<size_t>(exp - kSubBits + 1) * kSub + sub;
+}
+
+uint64_t latencyBucketUpper(size_t i) {
+    if (i < kSub) return i;
+    int exp    = static_cast<int>(i / kSub) + kSubBits - 1;
+    uint64_t w = uint64_t{1} << (exp - kSubBits);
+    return ((kSub + i % kSub) << (exp - kSubBits)) + w - 1;
+}
+
+int64_t floorDiv(int64_t a, int64_t b) {
+    int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+// Small per-thread number picking a TrafficRollups lane; threads started
+// together (a monitor's workers) get consecutive slots
+size_t threadSlot() {
+    static std::atomic<size_t> next{0};
+    thread_local size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+    return slot;
+}
+
+constexpr size_t kHeaderBytes = sizeof(rollup::FileHeader);
+constexpr size_t kIndexHeaderBytes = sizeof(rollup::IndexHeader);
+} // namespace
+
+// ── RollupWriter ─────────────────────────────────────────────────────
+
+RollupWriter::RollupWriter(std::string path, RollupKey key, uint32_t index_every_sec)
+    : path_(std::move(path))
+    , index_every_sec_(std::max<uint32_t>(1, index_every_sec))
+    , last_second_(INT64_MIN)
+    , next_index_second_(INT64_MIN) {
+    if (!openExisting(key)) create(key);
+}
+
+RollupWriter::~RollupWriter() {
+    if (file_) std::fclose(file_);
+    if (index_) std::fclose(index_);
+}
+
+bool RollupWriter::openExisting(RollupKey key) {
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path_, ec);
+    if (ec || size < kHeaderBytes) return false;
+    std::FILE* in = std::fopen(path_.c_str(), "rb");
+    if (!in) return false;
+    rollup::FileHeader header{};
+    bool ok = std::fread(&header, sizeof(header), 1, in) == 1 &&
+              std::memcmp(header.magic, rollup::kFileMagic, sizeof(header.magic)) == 0 &&
+              header.version == rollup::kVersion &&
+              header.record_size == sizeof(rollup::Record) &&
+              header.key_kind == static_cast<uint32_t>(key) &&
+              header.index_every_sec == index_every_sec_;
+    records_ = (size - kHeaderBytes) / sizeof(rollup::Record);
+    if (ok && records_ > 0) {
+        rollup::Record last{};
+        ok = std::fseek(in, static_cast<long>(kHeaderBytes + (records_ - 1) * sizeof(last)),
+                        SEEK_SET) == 0 &&
+             std::fread(&last, sizeof(last), 1, in) == 1;
+        last_second_ = last.second;
+    }
+    std::fclose(in);
+
+    std::string index_path = path_ + ".idx";
+    uint64_t index_size = std::filesystem::file_size(index_path, ec);
+    if (!ok || ec || index_size < kIndexHeaderBytes) {
+        records_     = 0;
+        last_second_ = INT64_MIN;
+        return false;
+    }
+
+    // Cut off a partial record (and index entry) left by a crash
+    std::filesystem::resize_file(path_, kHeaderBytes + records_ * sizeof(rollup::Record), ec);
+    std::filesystem::resize_file(
+        index_path,
+        kIndexHeaderBytes + (index_size - kIndexHeaderBytes) / sizeof(rollup::IndexEntry) *
+                                sizeof(rollup::IndexEntry),
+        ec);
+
+    file_  = std::fopen(path_.c_str(), "ab");
+    index_ = std::fopen(index_path.c_str(), "ab");
+    if (last_second_ != INT64_MIN) {
+        int64_t span = index_every_sec_;
+        next_index_second_ = floorDiv(last_second_, span) * span + span;
+    }
+    return isOpen();
+}
+
+void RollupWriter::create(RollupKey key) {
+    if (file_) std::fclose(file_);
+    if (index_) std::fclose(index_);
+    file_  = std::fopen(path_.c_str(), "wb");
+    index_ = std::fopen((path_ + ".idx").c_str(), "wb");
+    if (!isOpen()) return;
+
+    rollup::FileHeader header{};
+    std::memcpy(header.magic, rollup::kFileMagic, sizeof(header.magic));
+    header.version         = rollup::kVersion;
+    header.record_size     = sizeof(rollup::Record);
+    header.key_kind        = static_cast<uint32_t>(key);
+    header.index_every_sec = index_every_sec_;
+    std::fwrite(&header, sizeof(header), 1, file_);
+
+    rollup::IndexHeader index_header{};
+    std::memcpy(index_header.magic, rollup::kIndexMagic, sizeof(index_header.magic));
+    index_header.version = rollup::kVersion;
+    std::fwrite(&index_header, sizeof(index_header), 1, index_);
+}
+
+void RollupWriter::append(const rollup::Record* records, size_t count) {
+    if (!isOpen() || count == 0) return;
+    int64_t second = records[0].second;
+    if (second >= next_index_second_) {
+        rollup::IndexEntry entry{second, records_};
+        std::fwrite(&entry, sizeof(entry), 1, index_);
+        int64_t span = index_every_sec_;
+        next_index_second_ = floorDiv(second, span) * span + span;
+    }
+    std::fwrite(records, sizeof(rollup::Record), count, file_);
+    records_ += count;
+    last_second_ = second;
+}
+
+void RollupWriter::flush() {
+    if (file_) std::fflush(file_);
+    if (index_) std::fflush(index_);
+}
+
+// ── TrafficRollups ───────────────────────────────────────────────────
+
+void TrafficRollups::Acc::add(const Packet& p, uint64_t source_hash) {
+    static_assert(kLatencyBuckets == (kMaxExponent - kSubBits + 2) * kSub, "latency buckets");
+    double ms = p.latency_ms;
+    if (packets == 0) {
+        latency_min = latency_max = ms;
+    } else {
+        latency_min = std::min(latency_min, ms);
+        latency_max = std::max(latency_max, ms);
+    }
+    ++packets;
+    bytes += p.size_bytes;
+    latency_sum += ms;
+    uint64_t us = ms > 0 ? static_cast<uint64_t>(ms * 1000.0 + 0.5) : 0;
+    ++latency[latencyBucket(us)];
+
+    // HyperLogLog: the top 8 bits pick a register, which keeps the
+    // longest run of leading zeros seen in the rest
+    size_t reg    = static_cast<size_t>(source_hash >> 56);
+    uint64_t rest = source_hash << 8;
+    uint8_t rank  = rest ? static_cast<uint8_t>(__builtin_clzll(rest) + 1) : 57;
+    sources[reg]  = std::max(sources[reg], rank);
+}
+
+void TrafficRollups::Acc::merge(const Acc& other) {
+    if (other.packets == 0) return;
+    if (packets == 0) {
+        latency_min = other.latency_min;
+        latency_max = other.latency_max;
+    } else {
+        latency_min = std::min(latency_min, other.latency_min);
+        latency_max = std::max(latency_max, other.latency_max);
+    }
+    packets     += other.packets;
+    bytes       += other.bytes;
+    latency_sum += other.latency_sum;
+    for (size_t i = 0; i < latency.size(); ++i) latency[i] += other.latency[i];
+    for (size_t i = 0; i < sources.size(); ++i) sources[i] = std::max(sources[i], other.sources[i]);
+}
+
+rollup::Record TrafficRollups::Acc::toRecord(int64_t second, RollupKey kind,
+                                             uint32_t key) const {
+    rollup::Record r{};
+    r.second  = second;
+    r.packets = packets;
+    r.bytes   = bytes;
+    r.key     = key;
+    r.kind    = static_cast<uint8_t>(kind);
+    if (packets == 0) return r;
+
+    r.latency_min_ms  = static_cast<float>(latency_min);
+    r.latency_max_ms  = static_cast<float>(latency_max);
+    r.latency_mean_ms = static_cast<float>(latency_sum / static_cast<double>(packets));
+    uint64_t rank = (packets * 99 + 99) / 100;  // ceil(0.99 * packets)
+    uint64_t seen = 0;
+    for (size_t i = 0; i < latency.size(); ++i) {
+        seen += latency[i];
+        if (seen >= rank) {
+            double p99 = static_cast<double>(latencyBucketUpper(i)) / 1000.0;
+            r.latency_p99_ms = static_cast<float>(std::clamp(p99, latency_min, latency_max));
+            break;
+        }
+    }
+
+    double m = static_cast<double>(sources.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t reg : sources) {
+        sum += std::ldexp(1.0, -reg);
+        if (reg == 0) ++zeros;
+    }
+    double estimate = 0.7213 / (1.0 + 1.079 / m) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));  // linear counting
+    }
+    r.sources = static_cast<uint32_t>(std::llround(estimate));
+    return r;
+}
+
+TrafficRollups::TrafficRollups(const std::string& path, RollupConfig config)
+    : config_(config)
+    , newest_(INT64_MIN)
+    , written_through_(INT64_MIN)
+    , writer_(path, config.key, config.index_every_sec) {
+    written_through_.store(writer_.lastSecond());
+}
+
+TrafficRollups::~TrafficRollups() {
+    flush();
+}
+
+void TrafficRollups::attach(NetworkMonitor& monitor) {
+    monitor.onBatch([this](const std::vector<Packet>& batch) { observe(batch); });
+}
+
+uint32_t TrafficRollups::keyOf(const Packet& p) const {
+    uint32_t key = 0;
+    switch (config_.key) {
+        case RollupKey::SOURCE:      parseIPv4(p.src_ip, key); break;
+        case RollupKey::DESTINATION: parseIPv4(p.dst_ip, key); break;
+        case RollupKey::DST_PORT:    key = p.dst_port; break;
+        case RollupKey::PROTOCOL:    key = static_cast<uint32_t>(p.protocol); break;
+        case RollupKey::TEID:        key = p.teid; break;
+        case RollupKey::NONE:        break;
+    }
+    return key;
+}
+
+void TrafficRollups::observe(const std::vector<Packet>& batch) {
+    Lane& lane = lanes_[threadSlot() % kLanes];
+    int64_t newest = INT64_MIN;
+    {
+        std::lock_guard<std::mutex> lock(lane.mtx);
+        // Read under the lane lock: a closer publishes written_through_
+        // before it empties the lanes, so a packet either sees the new
+        // value or lands in time to be merged
+        const int64_t written_through = written_through_.load();
+        int64_t cached = INT64_MIN;
+        Second* current = nullptr;
+        for (const auto& p : batch) {
+            int64_t second = floorDiv(toNanos(p.timestamp), 1'000'000'000);
+            if (second <= written_through) {
+                ++lane.late;
+                continue;
+            }
+            if (second != cached) {
+                auto& slot = lane.open[second];
+                if (!slot) slot = std::make_unique<Second>();
+                current = slot.get();
+                cached  = second;
+            }
+            newest = std::max(newest, second);
+            ++lane.packets;
+
+            uint64_t hash = AnomalyDetector::sourceHash(p.src_ip);
+            current->overall.add(p, hash);
+            if (config_.key == RollupKey::NONE) continue;
+            uint32_t key = keyOf(p);
+            auto it = current->keys.find(key);
+            if (it == current->keys.end()) {
+                if (current->keys.size() >= config_.max_keys) {
+                    ++lane.key_overflow;
+                    continue;
+                }
+                it = current->keys.emplace(key, Acc{}).first;
+            }
+            it->second.add(p, hash);
+        }
+    }
+    if (newest == INT64_MIN) return;
+
+    int64_t seen = newest_.load(std::memory_order_relaxed);
+    while (seen < newest && !newest_.compare_exchange_weak(seen, newest)) {}
+    int64_t through = std::max(seen, newest) - config_.flush_lag_sec;
+    if (through <= written_through_.load(std::memory_order_relaxed)) return;
+    // Whoever holds the closer lock writes; the others carry on
+    std::unique_lock<std::mutex> lock(close_mtx_, std::try_to_lock);
+    if (lock) closeThroughLocked(through);
+}
+
+void TrafficRollups::writeLocked(int64_t second, const Second& s) {
+    scratch_.clear();
+    scratch_.push_back(s.overall.toRecord(second, RollupKey::NONE, 0));
+    std::vector<std::pair<uint32_t, const Acc*>> keys;
+    keys.reserve(s.keys.size());
+    for (const auto& [key, acc] : s.keys) keys.emplace_back(key, &acc);
+    std::sort(keys.begin(), keys.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (const auto& [key, acc] : keys) scratch_.push_back(acc->toRecord(second, config_.key, key));
+
+    writer_.append(scratch_.data(), scratch_.size());
+    ++written_.seconds;
+    written_.records += scratch_.size();
+}
+
+void TrafficRollups::mergeInto(Second& into, const Second& from) {
+    into.overall.merge(from.overall);
+    for (const auto& [key, acc] : from.keys) {
+        auto it = into.keys.find(key);
+        if (it != into.keys.end()) {
+            it->second.merge(acc);
+        } else if (into.keys.size() < config_.max_keys) {
+            into.keys.emplace(key, acc);
+        } else {
+            written_.key_overflow += acc.packets;
+        }
+    }
+}
+
+void TrafficRollups::closeThroughLocked(int64_t second) {
+    if (second <= written_through_.load()) return;
+    written_through_.store(second);
+    OpenSeconds closing;
+    for (auto& lane : lanes_) {
+        std::lock_guard<std::mutex> lock(lane.mtx);
+        while (!lane.open.empty() && lane.open.begin()->first <= second) {
+            auto node = lane.open.extract(lane.open.begin());
+            auto& slot = closing[node.key()];
+            if (slot) {
+                mergeInto(*slot, *node.mapped());
+            } else {
+                slot = std::move(node.mapped());
+            }
+        }
+    }
+    for (const auto& [s, sec] : closing) writeLocked(s, *sec);
+}
+
+void TrafficRollups::flush() {
+    std::lock_guard<std::mutex> lock(close_mtx_);
+    int64_t last = INT64_MIN;
+    for (auto& lane : lanes_) {
+        std::lock_guard<std::mutex> lane_lock(lane.mtx);
+        if (!lane.open.empty()) last = std::max(last, lane.open.rbegin()->first);
+    }
+    if (last != INT64_MIN) closeThroughLocked(last);
+    writer_.flush();
+}
+
+RollupStats TrafficRollups::stats() const {
+    std::lock_guard<std::mutex> lock(close_mtx_);
+    RollupStats s = written_;
+    for (auto& lane : lanes_) {
+        std::lock_guard<std::mutex> lane_lock(lane.mtx);
+        s.packets      += lane.packets;
+        s.late         += lane.late;
+        s.key_overflow += lane.key_overflow;
+    }
+    return s;
+}
+
+// ── RollupReader ─────────────────────────────────────────────────────
+
+RollupReader::Mapping RollupReader::map(const std::string& path) {
+    Mapping m;
+#ifdef __unix__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return m;
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            m.data = p;
+            m.size = static_cast<size_t>(st.st_size);
+        }
+    }
+    ::close(fd);
+#else
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(path, ec);
+    std::FILE* f = ec || size == 0 ? nullptr : std::fopen(path.c_str(), "rb");
+    if (!f) return m;
+    m.data = std::malloc(static_cast<size_t>(size));
+    if (m.data && std::fread(m.data, 1, static_cast<size_t>(size), f) == size) {
+        m.size = static_cast<size_t>(size);
+    } else {
+        std::free(m.data);
+        m.data = nullptr;
+    }
+    std::fclose(f);
+#endif
+    return m;
+}
+
+void RollupReader::unmap(Mapping& m) {
+    if (!m.data) return;
+#ifdef __unix__
+    ::munmap(m.data, m.size);
+#else
+    std::free(m.data);
+#endif
+    m = Mapping{};
+}
+
+std::unique_ptr<RollupReader> RollupReader::open(const std::string& path) {
+    std::unique_ptr<RollupReader> reader(new RollupReader());
+    reader->data_ = map(path);
+    if (reader->data_.size < kHeaderBytes) return nullptr;
+    const auto* header = static_cast<const rollup::FileHeader*>(reader->data_.data);
+    if (std::memcmp(header->magic, rollup::kFileMagic, sizeof(header->magic)) != 0 ||
+        header->version != rollup::kVersion ||
+        header->record_size != sizeof(rollup::Record)) {
+        return nullptr;
+    }
+    reader->key_kind_ = static_cast<RollupKey>(header->key_kind);
+    reader->records_  = reinterpret_cast<const rollup::Record*>(
+        static_cast<const char*>(reader->data_.data) + kHeaderBytes);
+    reader->count_ = (reader->data_.size - kHeaderBytes) / sizeof(rollup::Record);
+
+    // The index is optional: without it lookups search all records
+    reader->index_ = map(path + ".idx");
+    const auto* index_header = static_cast<const rollup::IndexHeader*>(reader->index_.data);
+    if (reader->index_.size >= kIndexHeaderBytes &&
+        std::memcmp(index_header->magic, rollup::kIndexMagic, sizeof(index_header->magic)) == 0 &&
+        index_header->version == rollup::kVersion) {
+        reader->entries_ = reinterpret_cast<const rollup::IndexEntry*>(
+            static_cast<const char*>(reader->index_.data) + kIndexHeaderBytes);
+        size_t n = (reader->index_.size - kIndexHeaderBytes) / sizeof(rollup::IndexEntry);
+        while (n > 0 && reader->entries_[n - 1].record >= reader->count_) --n;
+        reader->entry_count_ = n;
+    }
+    return reader;
+}
+
+RollupReader::~RollupReader() {
+    unmap(data_);
+    unmap(index_);
+}
+
+size_t RollupReader::lowerBound(int64_t s) const {
+    size_t lo = 0, hi = count_;
+    if (entry_count_ > 0) {
+        // The last indexed second <= s bounds the search from below, the
+        // next one from above
+        const rollup::IndexEntry* end = entries_ + entry_count_;
+        const rollup::IndexEntry* it = std::upper_bound(
+            entries_, end, s,
+            [](int64_t v, const rollup::IndexEntry& e) { return v < e.second; });
+        if (it != entries_) lo = static_cast<size_t>((it - 1)->record);
+        if (it != end) hi = static_cast<size_t>(it->record);
+    }
+    const rollup::Record* found = std::lower_bound(
+        records_ + lo, records_ + hi, s,
+        [](const rollup::Record& r, int64_t v) { return r.second < v; });
+    return static_cast<size_t>(found - records_);
+}
+
+size_t RollupReader::range(int64_t from, int64_t to, const rollup::Record*& first) const {
+    size_t begin = lowerBound(from);
+    size_t end   = to == INT64_MAX ? count_ : lowerBound(to + 1);
+    first = records_ + begin;
+    return end > begin ? end - begin : 0;
+}
+
+std::vector<rollup::Record> RollupReader::series(int64_t from, int64_t to, RollupKey kind,
+                                                 uint32_t key) const {
+    std::vector<rollup::Record> out;
+    const rollup::Record* first = nullptr;
+    size_t n = range(from, to, first);
+    const rollup::Record* end = first + n;
+    const auto overall = static_cast<uint8_t>(RollupKey::NONE);
+    // Consecutive seconds usually hold the same keys, so the previous
+    // second's run length and key offset are tried before searching
+    size_t run_hint = 0, key_hint = 0;
+    while (first < end) {
+        int64_t second = first->second;
+        const rollup::Record* next = first + std::min(run_hint, static_cast<size_t>(end - first));
+        if (next == first || next[-1].second != second || (next < end && next->second == second)) {
+            next = std::upper_bound(first, end, second,
+                                    [](int64_t v, const rollup::Record& r) { return v < r.second; });
+        }
+        run_hint = static_cast<size_t>(next - first);
+
+        if (kind == RollupKey::NONE) {
+            if (first->kind == overall) out.push_back(*first);
+        } else {
+            const rollup::Record* it = key_hint < run_hint ? first + key_hint : next;
+            if (it == next || it->key != key || it->kind == overall) {
+                const rollup::Record* keyed = first->kind == overall ? first + 1 : first;
+                it = std::lower_bound(keyed, next, key,
+                                      [](const rollup::Record& r, uint32_t v) { return r.key < v; });
+            }
+            if (it != next && it->key == key && it->kind == static_cast<uint8_t>(kind)) {
+                out.push_back(*it);
+                key_hint = static_cast<size_t>(it - first);
+            }
+        }
+        first = next;
+    }
+    return out;
+}
+
+} // namespace anomaly
@@ -0,0 +1,59 @@
+#include "SharedMemory.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace anomaly {
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::create(
+    const std::string& name, size_t size) {
+    ::shm_unlink(name.c_str());  // drop a stale region from a crashed run
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return nullptr;
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return nullptr;
+    }
+    void* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        ::shm_unlink(name.c_str());
+        return nullptr;
+    }
+    return std::unique_ptr<SharedMemoryRegion>(
+        new SharedMemoryRegion(name, data, size, true));
+}
+
+std::unique_ptr<SharedMemoryRegion> SharedMemoryRegion::open(
+    const std::string& name, bool writable) {
+    int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) return nullptr;
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    int prot    = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* data  = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return nullptr;
+
+    return std::unique_ptr<SharedMemoryRegion>(
+        new SharedMemoryRegion(name, data, size, false));
+}
+
+SharedMemoryRegion::SharedMemoryRegion(std::string name, void* data,
+                                       size_t size, bool owner)
+    : name_(std::move(name)), data_(data), size_(size), owner_(owner) {}
+
+SharedMemoryRegion::~SharedMemoryRegion() {
+    ::munmap(data_, size_);
+    if (owner_) ::shm_unlink(name_.c_str());
+}
+
+} // namespace anomaly
@@ -0,0 +1,119 @@
+#include "SourceInterner.h"
+#include "IpAddress.h"
+
+namespace anomaly {
+
+uint32_t SourceInterner::intern(const std::string& addr) {
+    uint32_t packed;
+    if (parseIPv4(addr, packed)) {
+        // Keep load (including tombstones) under 50%
+        if ((ipv4_used_ + 1) * 2 > ipv4_slots_.size()) growIPv4();
+
+        size_t mask  = ipv4_slots_.size() - 1;
+        size_t reuse = ipv4_slots_.size();  // first tombstone on the probe path
+        for (size_t i = probeStart(packed);; i = (i + 1) & mask) {
+            const Slot& slot = ipv4_slots_[i];
+            if (slot.id == kEmpty) {
+                size_t at = reuse < ipv4_slots_.size() ? reuse : i;
+                if (at == i) ++ipv4_used_;
+                ipv4_slots_[at] = Slot{packed, allocate(addr)};
+                return ipv4_slots_[at].id;
+            }
+            if (slot.id == kTombstone) {
+                if (reuse == ipv4_slots_.size()) reuse = i;
+            } else if (slot.addr == packed) {
+                return slot.id;
+            }
+        }
+    }
+
+    auto it = other_ids_.find(addr);
+    if (it != other_ids_.end()) return it->second;
+    uint32_t id = allocate(addr);
+    other_ids_.emplace(addr, id);
+    return id;
+}
+
+uint32_t SourceInterner::find(const std::string& addr) const {
+    uint32_t packed;
+    if (parseIPv4(addr, packed)) {
+        if (ipv4_slots_.empty()) return kInvalidId;
+        size_t mask = ipv4_slots_.size() - 1;
+        for (size_t i = probeStart(packed);; i = (i + 1) & mask) {
+            const Slot& slot = ipv4_slots_[i];
+            if (slot.id == kEmpty) return kInvalidId;
+            if (slot.id != kTombstone && slot.addr == packed) return slot.id;
+        }
+    }
+    auto it = other_ids_.find(addr);
+    return it != other_ids_.end() ? it->second : kInvalidId;
+}
+
+void SourceInterner::release(uint32_t id) {
+    if (id >= keys_.size() || find(keys_[id]) != id) return;
+
+    const std::string& addr = keys_[id];
+    uint32_t packed;
+    if (parseIPv4(addr, packed)) {
+        size_t mask = ipv4_slots_.size() - 1;
+        for (size_t i = probeStart(packed);; i = (i + 1) & mask) {
+            Slot& slot = ipv4_slots_[i];
+            if (slot.id == id) {
+                slot.id = kTombstone;
+                break;
+            }
+        }
+    } else {
+        other_ids_.erase(addr);
+    }
+    keys_[id].clear();
+    free_ids_.push_back(id);
+}
+
+void SourceInterner::clear() {
+    ipv4_slots_.clear();
+    ipv4_used_ = 0;
+    other_ids_.clear();
+    keys_.clear();
+    free_ids_.clear();
+}
+
+uint32_t SourceInterner::allocate(const std::string& addr) {
+    if (!free_ids_.empty()) {
+        uint32_t id = free_ids_.back();
+        free_ids_.pop_back();
+        keys_[id] = addr;
+        return id;
+    }
+    keys_.push_back(addr);
+    return static_cast<uint32_t>(keys_.size() - 1);
+}
+
+size_t SourceInterner::probeStart(uint32_t addr) const {
+    // Fibonacci hashing spreads sequential addresses across the table
+    uint64_t h = static_cast<uint64_t>(addr) * 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h >> 32) & (ipv4_slots_.size() - 1);
+}
+
+void SourceInterner::growIPv4() {
+    std::vector<Slot> old = std::move(ipv4_slots_);
+    size_t live = 0;
+    for (const auto& slot : old) {
+        if (slot.id < kTombstone) ++live;
+    }
+
+    size_t capacity = 64;
+    while (capacity < (live + 1) * 4) capacity *= 2;
+    ipv4_slots_.assign(capacity, Slot{});
+    ipv4_used_ = live;
+
+    size_t mask = capacity - 1;
+    for (const auto& slot : old) {
+        if (slot.id >= kTombstone) continue;
+        size_t i = probeStart(slot.addr);
+        while (ipv4_slots_[i].id != kEmpty) i = (i + 1) & mask;
+        ipv4_slots_[i] = slot;
+    }
+}
+
+} // namespace anomaly
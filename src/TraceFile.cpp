@@ -0,0 +1,132 @@
+#include "TraceFile.h"
+#include <cstring>
+
+namespace anomaly {
+
+namespace {
+constexpr size_t kWriteBuffer = 4096;  // records per fwrite
+}
+
+TraceWriter::TraceWriter(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) return;
+    trace::FileHeader header{};
+    std::memcpy(header.magic, trace::kMagic, sizeof(header.magic));
+    header.version     = trace::kVersion;
+    header.record_size = sizeof(trace::PacketRecord);
+    std::fwrite(&header, sizeof(header), 1, file_);
+    buffer_.reserve(kWriteBuffer);
+}
+
+TraceWriter::~TraceWriter() {
+    if (!file_) return;
+    flushLocked();
+    std::fclose(file_);
+}
+
+void TraceWriter::write(const Packet& packet) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    appendLocked(packet);
+}
+
+void TraceWriter::write(const std::vector<Packet>& packets) {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (const auto& p : packets) appendLocked(p);
+}
+
+void TraceWriter::flush() {
+    std::lock_guard<std::mutex> lock(mtx_);
+    flushLocked();
+    if (file_) std::fflush(file_);
+}
+
+uint64_t TraceWriter::written() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return written_;
+}
+
+uint64_t TraceWriter::skipped() const {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return skipped_;
+}
+
+void TraceWriter::appendLocked(const Packet& packet) {
+    if (!file_) return;
+    trace::PacketRecord record;
+    if (!trace::encodeRecord(packet, record)) {
+        ++skipped_;
+        return;
+    }
+    buffer_.push_back(record);
+    ++written_;
+    if (buffer_.size() >= kWriteBuffer) flushLocked();
+}
+
+void TraceWriter::flushLocked() {
+    if (!file_ || buffer_.empty()) return;
+    std::fwrite(buffer_.data(), sizeof(trace::PacketRecord), buffer_.size(), file_);
+    buffer_.clear();
+}
+
+TraceReader::TraceReader(const std::string& path) {
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) return;
+    trace::FileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file_) == 1 &&
+        std::memcmp(header.magic, trace::kMagic, sizeof(header.magic)) == 0) {
+        if (header.version != trace::kVersion ||
+            header.record_size != sizeof(trace::PacketRecord)) {
+            std::fclose(file_);
+            file_ = nullptr;
+            return;
+        }
+        binary_ = true;
+    } else {
+        std::rewind(file_);
+    }
+}
+
+TraceReader::~TraceReader() {
+    if (file_) std::fclose(file_);
+}
+
+bool TraceReader::next(Packet& out) {
+    if (!file_) return false;
+    if (binary_) {
+        trace::PacketRecord record;
+        if (std::fread(&record, sizeof(record), 1, file_) != 1) return false;
+        trace::decodeRecord(record, out);
+        return true;
+    }
+
+    char chunk[512];
+    for (;;) {
+        line_.clear();
+        bool got = false;
+        while (std::fgets(chunk, sizeof(chunk), file_)) {
+            got = true;
+            line_ += chunk;
+            if (!line_.empty() && line_.back() == '\n') break;
+        }
+        if (!got) return false;
+        while (!line_.empty() && (line_.back() == '\n' || line_.back() == '\r')) {
+            line_.pop_back();
+        }
+        if (line_.empty() || line_[0] == '#') continue;
+        out = processor_.parsePacket(line_);
+        if (processor_.isValidPacket(out)) return true;
+        ++skipped_;
+    }
+}
+
+size_t TraceReader::next(std::vector<Packet>& out, size_t max) {
+    size_t n = 0;
+    Packet p;
+    while (n < max && next(p)) {
+        out.push_back(std::move(p));
+        ++n;
+    }
+    return n;
+}
+
+} // namespace anomaly
@@ -0,0 +1,99 @@
+#include "TraceReplayer.h"
+#include "NetworkMonitor.h"
+#include "TraceFile.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace anomaly {
+
+namespace {
+using Steady = std::chrono::steady_clock;
+
+void waitUntil(Steady::time_point due, std::chrono::microseconds spin) {
+    if (due - Steady::now() > spin) std::this_thread::sleep_until(due - spin);
+    while (Steady::now() < due) cpuRelax();
+}
+} // namespace
+
+TraceReplayer::TraceReplayer(ReplayConfig config)
+    : config_(config) {}
+
+ReplayStats TraceReplayer::run(TraceReader& reader, NetworkMonitor& monitor) {
+    ReplayStats stats;
+    const bool paced = config_.speed > 0.0;
+    const size_t batch_size = std::max<size_t>(1, config_.batch_size);
+    const auto window = std::chrono::microseconds(config_.batch_window_us);
+    const auto spin   = std::chrono::microseconds(config_.spin_us);
+
+    std::vector<Packet> batch;
+    batch.reserve(batch_size);
+    Packet next;
+    bool pending = reader.next(next);
+
+    int64_t first_ts = 0, last_ts = 0;
+    bool have_first = false;
+    // Trace time of a packet; untimestamped ones ride with the previous
+    auto traceTime = [&](const Packet& p) {
+        if (hasTimestamp(p.timestamp)) {
+            last_ts = toNanos(p.timestamp);
+            if (!have_first) {
+                first_ts   = last_ts;
+                have_first = true;
+            }
+        }
+        return last_ts;
+    };
+
+    const auto start = Steady::now();
+    auto dueAt = [&](int64_t ts) {
+        return start + std::chrono::duration_cast<Steady::duration>(
+                           std::chrono::duration<double, std::nano>(
+                               static_cast<double>(ts - first_ts) / config_.speed));
+    };
+
+    double lag_sum = 0.0;
+    uint64_t lag_samples = 0;
+    stopping_.store(false);
+
+    while (pending && !stopping_.load(std::memory_order_relaxed)) {
+        int64_t ts = traceTime(next);
+        Steady::time_point now;
+        if (paced) {
+            auto due = dueAt(ts);
+            waitUntil(due, spin);
+            now = Steady::now();
+            double lag = std::chrono::duration<double, std::micro>(now - due).count();
+            stats.max_lag_us = std::max(stats.max_lag_us, lag);
+            lag_sum += lag;
+            ++lag_samples;
+        }
+
+        batch.clear();
+        batch.push_back(std::move(next));
+        while ((pending = reader.next(next)) && batch.size() < batch_size) {
+            int64_t next_ts = traceTime(next);
+            if (paced && dueAt(next_ts) > now + window) break;
+            batch.push_back(std::move(next));
+        }
+        stats.packets  += batch.size();
+        stats.accepted += monitor.feedBatch(batch.data(), batch.size());
+    }
+    // The packet left in `next` when the loop stops early was never sent
+
+    stats.seconds       = std::chrono::duration<double>(Steady::now() - start).count();
+    stats.skipped       = reader.skipped();
+    stats.trace_seconds = static_cast<double>(last_ts - first_ts) / 1e9;
+    if (paced && stats.trace_seconds > 0.0) {
+        stats.target_pps = static_cast<double>(stats.packets) * config_.speed /
+                           stats.trace_seconds;
+    }
+    if (stats.seconds > 0.0) {
+        stats.achieved_pps = static_cast<double>(stats.packets) / stats.seconds;
+    }
+    if (lag_samples > 0) stats.mean_lag_us = lag_sum / static_cast<double>(lag_samples);
+    return stats;
+}
+
+} // namespace anomaly
@@ -0,0 +1,278 @@
+#include "Tracing.h"
+#include "JsonUtil.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace anomaly {
+namespace tracing {
+
+std::atomic<uint32_t> g_sample_every{0};
+
+namespace {
+
+// The thread id fits in the padding, so a record stays 24 bytes
+struct Record {
+    uint64_t trace_id;
+    int64_t ts_ns;
+    Stage stage;
+    uint32_t tid;
+};
+static_assert(sizeof(Record) == 24, "Record layout");
+
+// Written only by its owning thread: slots below `count` are immutable
+// once published, so a reader needs no lock. When the owner exits the
+// buffer goes on the free list (see Tracing.h).
+struct ThreadBuffer {
+    explicit ThreadBuffer(size_t capacity)
+        : records(new Record[capacity]), capacity(capacity) {}
+
+    std::unique_ptr<Record[]> records;
+    size_t capacity;
+    std::atomic<size_t> count{0};
+    std::atomic<uint64_t> dropped{0};
+};
+
+struct Buffers {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<ThreadBuffer>> all;
+    std::vector<ThreadBuffer*> free;   // owners have exited
+    size_t records_per_thread{65536};
+    uint32_t next_tid{1};
+    std::atomic<uint64_t> orphaned{0}; // stamped during thread exit
+};
+
+// Never destroyed: threads may still stamp during static destruction
+Buffers& buffers() {
+    static Buffers* b = new Buffers;
+    return *b;
+}
+
+std::atomic<uint64_t> next_trace_id{1};
+
+struct Owned {
+    ThreadBuffer* buf{nullptr};
+    uint32_t tid{0};
+};
+
+// Plain (trivially destructible) so it stays readable during thread exit
+thread_local Owned t_owned;
+thread_local bool t_exiting = false;
+
+// Hands the calling thread's buffer back when the thread exits
+struct BufferRelease {
+    ~BufferRelease() {
+        t_exiting = true;
+        if (!t_owned.buf) return;
+        Buffers& b = buffers();
+        std::lock_guard<std::mutex> lock(b.mtx);
+        b.free.push_back(t_owned.buf);
+        t_owned = Owned{};
+    }
+};
+
+// nullptr once the thread has started exiting
+ThreadBuffer* threadBuffer(uint32_t& tid) {
+    if (!t_owned.buf) {
+        if (t_exiting) return nullptr;
+        static thread_local BufferRelease release;
+        (void)release;
+        Buffers& b = buffers();
+        std::lock_guard<std::mutex> lock(b.mtx);
+        // Reuse an exited thread's buffer if it is sized by the current
+        // config and still has room
+        size_t capacity = std::max<size_t>(1, b.records_per_thread);
+        auto reusable = std::find_if(b.free.begin(), b.free.end(), [&](ThreadBuffer* buf) {
+            return buf->capacity == capacity &&
+                   buf->count.load(std::memory_order_relaxed) < capacity;
+        });
+        if (reusable != b.free.end()) {
+            t_owned.buf = *reusable;
+            b.free.erase(reusable);
+        } else {
+            b.all.push_back(std::make_unique<ThreadBuffer>(capacity));
+            t_owned.buf = b.all.back().get();
+        }
+        t_owned.tid = b.next_tid++;
+    }
+    tid = t_owned.tid;
+    return t_owned.buf;
+}
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Stamped {
+    uint64_t trace_id;
+    int64_t ts_ns;
+    Stage stage;
+    uint32_t tid;
+};
+
+void appendCommon(std::string& out, const char* name, const char* ph,
+                  double ts_us, uint32_t tid) {
+    out += "{\"name\":";
+    appendJsonString(out, name);
+    out += ",\"ph\":\"";
+    out += ph;
+    out += "\",\"ts\":";
+    appendJsonNumber(out, ts_us);
+    out += ",\"pid\":1,\"tid\":";
+    appendJsonNumber(out, static_cast<uint64_t>(tid));
+}
+
+} // namespace
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::INGEST:          return "ingest";
+        case Stage::ENQUEUE:         return "enqueue";
+        case Stage::DEQUEUE:         return "dequeue";
+        case Stage::ANALYZE_START:   return "analyze_start";
+        case Stage::ANALYZE_END:     return "analyze_end";
+        case Stage::ALERT_RAISED:    return "alert_raised";
+        case Stage::ALERT_PERSISTED: return "alert_persisted";
+    }
+    return "unknown";
+}
+
+void configure(const TracerConfig& config) {
+    {
+        Buffers& b = buffers();
+        std::lock_guard<std::mutex> lock(b.mtx);
+        b.records_per_thread = config.records_per_thread;
+    }
+    g_sample_every.store(config.sample_every, std::memory_order_relaxed);
+}
+
+uint64_t sampleSlow() {
+    static thread_local uint32_t tick = 0;
+    uint32_t every = g_sample_every.load(std::memory_order_relaxed);
+    if (every == 0 || ++tick < every) return 0;
+    tick = 0;
+    return next_trace_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void recordSlow(uint64_t trace_id, Stage stage) {
+    uint32_t tid = 0;
+    ThreadBuffer* buf = threadBuffer(tid);
+    if (!buf) {
+        buffers().orphaned.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    size_t n = buf->count.load(std::memory_order_relaxed);
+    if (n >= buf->capacity) {
+        buf->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    buf->records[n] = Record{trace_id, nowNs(), stage, tid};
+    buf->count.store(n + 1, std::memory_order_release);
+}
+
+TraceStats stats() {
+    TraceStats s;
+    s.sampled = next_trace_id.load(std::memory_order_relaxed) - 1;
+    Buffers& b = buffers();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    s.dropped = b.orphaned.load(std::memory_order_relaxed);
+    for (const auto& buf : b.all) {
+        s.records += buf->count.load(std::memory_order_acquire);
+        s.dropped += buf->dropped.load(std::memory_order_relaxed);
+    }
+    s.threads = b.next_tid - 1;
+    s.buffers = b.all.size();
+    return s;
+}
+
+void clear() {
+    Buffers& b = buffers();
+    std::lock_guard<std::mutex> lock(b.mtx);
+    for (auto& buf : b.all) {
+        buf->count.store(0, std::memory_order_release);
+        buf->dropped.store(0, std::memory_order_relaxed);
+    }
+    b.orphaned.store(0, std::memory_order_relaxed);
+}
+
+bool writeChromeTrace(const std::string& path) {
+    std::vector<Stamped> records;
+    std::vector<uint32_t> tids;
+    {
+        Buffers& b = buffers();
+        std::lock_guard<std::mutex> lock(b.mtx);
+        for (const auto& buf : b.all) {
+            size_t n = buf->count.load(std::memory_order_acquire);
+            for (size_t i = 0; i < n; ++i) {
+                const Record& r = buf->records[i];
+                records.push_back({r.trace_id, r.ts_ns, r.stage, r.tid});
+                if (tids.empty() || tids.back() != r.tid) tids.push_back(r.tid);
+            }
+        }
+    }
+    std::sort(tids.begin(), tids.end());
+    tids.erase(std::unique(tids.begin(), tids.end()), tids.end());
+    // Per packet in pipeline order. Stages stamped on different threads can
+    // land a few ns out of order (e.g. enqueue is stamped after the push,
+    // the worker may dequeue first); clamp so spans never go negative.
+    std::sort(records.begin(), records.end(), [](const Stamped& a, const Stamped& b) {
+        return a.trace_id != b.trace_id ? a.trace_id < b.trace_id : a.stage < b.stage;
+    });
+    int64_t origin = INT64_MAX;
+    for (const auto& r : records) origin = std::min(origin, r.ts_ns);
+    for (size_t i = 1; i < records.size(); ++i) {
+        if (records[i].trace_id == records[i - 1].trace_id) {
+            records[i].ts_ns = std::max(records[i].ts_ns, records[i - 1].ts_ns);
+        }
+    }
+    auto us = [origin](int64_t ns) { return static_cast<double>(ns - origin) / 1e3; };
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    out += "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"5g-anomaly-detector\"}}";
+    for (uint32_t tid : tids) {
+        out += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":";
+        appendJsonNumber(out, static_cast<uint64_t>(tid));
+        out += ",\"args\":{\"name\":\"thread " + std::to_string(tid) + "\"}}";
+    }
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Stamped& r = records[i];
+        char id[24];
+        std::snprintf(id, sizeof(id), "0x%llx", static_cast<unsigned long long>(r.trace_id));
+
+        // Stage marker on the stamping thread's track
+        out += ",\n";
+        appendCommon(out, stageName(r.stage), "i", us(r.ts_ns), r.tid);
+        out += ",\"s\":\"t\",\"args\":{\"trace_id\":\"";
+        out += id;
+        out += "\"}}";
+
+        // Span to the packet's next stage on its async track
+        if (i + 1 < records.size() && records[i + 1].trace_id == r.trace_id) {
+            const Stamped& next = records[i + 1];
+            std::string name = std::string(stageName(r.stage)) + " -> " + stageName(next.stage);
+            out += ",\n";
+            appendCommon(out, name.c_str(), "b", us(r.ts_ns), r.tid);
+            out += ",\"cat\":\"packet\",\"id\":\"";
+            out += id;
+            out += "\"},\n";
+            appendCommon(out, name.c_str(), "e", us(next.ts_ns), next.tid);
+            out += ",\"cat\":\"packet\",\"id\":\"";
+            out += id;
+            out += "\"}";
+        }
+    }
+    out += "\n]}\n";
+
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+    bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+} // namespace tracing
+} // namespace anomaly
@@ -0,0 +1,468 @@
+#include "TrafficGenerator.h"
+#include "IpAddress.h"
+#include "NetworkMonitor.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <unordered_set>
+
+namespace anomaly {
+
+namespace {
+
+constexpr uint32_t kVictimBase   = 0x0AC80000;  // 10.200.0.0/16
+constexpr uint32_t kAttackerBase = 0xAC100000;  // 172.16.0.0/12
+constexpr uint32_t kMaxAttackers = 4096;        // per scenario
+constexpr size_t kMaxScenarios   = 255;
+constexpr uint32_t kLaneSlots    = 1u << 14;  // period of the lane schedule
+constexpr double kPi             = 3.14159265358979323846;
+
+uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// SplitMix64, seeded per packet so any packet can be generated on its own
+struct PacketRng {
+    uint64_t state;
+
+    PacketRng(uint64_t seed, uint64_t tag, uint64_t n)
+        : state(mix64(seed ^ mix64((n << 8) | tag))) {}
+
+    uint64_t next() {
+        state += 0x9e3779b97f4a7c15ULL;
+        return mix64(state);
+    }
+    double uniform() { return static_cast<double>(next() >> 11) * 0x1.0p-53; }
+};
+
+TimePoint at(TimePoint start, double offset_sec) {
+    return start + std::chrono::duration_cast<TimePoint::duration>(
+                       std::chrono::duration<double>(offset_sec));
+}
+
+void assignIPv4(std::string& out, uint32_t addr) {
+    char buf[16];
+    out.assign(buf, formatIPv4(addr, buf));  // fits SSO: no allocation
+}
+
+AnomalyType expectedType(AttackKind kind) {
+    switch (kind) {
+        case AttackKind::SCAN:          return AnomalyType::UNKNOWN_PROTOCOL;
+        case AttackKind::LATENCY_SPIKE: return AnomalyType::HIGH_LATENCY;
+        default:                        return AnomalyType::FLOOD;
+    }
+}
+
+} // namespace
+
+const char* attackKindName(AttackKind kind) {
+    switch (kind) {
+        case AttackKind::FLOOD:             return "FLOOD";
+        case AttackKind::DISTRIBUTED_FLOOD: return "DISTRIBUTED_FLOOD";
+        case AttackKind::SCAN:              return "SCAN";
+        case AttackKind::LATENCY_SPIKE:     return "LATENCY_SPIKE";
+    }
+    return "UNKNOWN";
+}
+
+// Vose alias method: O(1) sampling from a fixed discrete distribution
+struct TrafficGenerator::AliasTable {
+    std::vector<double> prob;
+    std::vector<uint32_t> alias;
+
+    explicit AliasTable(const std::vector<double>& weights)
+        : prob(weights.size()), alias(weights.size()) {
+        size_t n = weights.size();
+        double total = 0;
+        for (double w : weights) total += w;
+
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back(); small.pop_back();
+            uint32_t l = large.back();
+            prob[s]  = scaled[s];
+            alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        for (uint32_t i : large) prob[i] = 1.0;
+        for (uint32_t i : small) prob[i] = 1.0;  // rounding leftovers
+    }
+
+    uint32_t sample(uint64_t r) const {
+        auto i = static_cast<uint32_t>(((r >> 32) * prob.size()) >> 32);
+        double u = static_cast<double>(r & 0xffffffffu) * 0x1.0p-32;
+        return u < prob[i] ? i : alias[i];
+    }
+};
+
+// Background sources split into lanes by address hash. Background packet
+// n draws its source from lane schedule[n % kLaneSlots], an interleaving in
+// which each lane holds slots in proportion to its share of the Zipf
+// weight, so the overall source distribution is unchanged.
+struct TrafficGenerator::Lanes {
+    std::vector<uint8_t> schedule;             // slot -> lane
+    std::vector<std::vector<uint32_t>> ranks;  // lane -> source ranks
+    std::vector<AliasTable> tables;            // lane -> weights of those ranks
+
+    Lanes(const std::vector<double>& weights, uint32_t base) : ranks(kLanes) {
+        std::vector<double> lane_weight(kLanes, 0.0);
+        double total = 0;
+        for (uint32_t k = 0; k < weights.size(); ++k) {
+            uint32_t lane = laneOf(base + k);
+            ranks[lane].push_back(k);
+            lane_weight[lane] += weights[k];
+            total += weights[k];
+        }
+
+        // Slots per lane: the proportional share rounded, at least one for
+        // every lane with sources
+        std::vector<uint32_t> slots(kLanes, 0);
+        std::vector<double> exact(kLanes, 0.0);
+        uint32_t used = 0;
+        for (uint32_t l = 0; l < kLanes; ++l) {
+            if (ranks[l].empty()) continue;
+            exact[l] = lane_weight[l] / total * kLaneSlots;
+            slots[l] = std::max<uint32_t>(1, static_cast<uint32_t>(exact[l]));
+            used += slots[l];
+        }
+        while (used < kLaneSlots) {
+            uint32_t best = 0;
+            for (uint32_t l = 1; l < kLanes; ++l) {
+                if (exact[l] - slots[l] > exact[best] - slots[best]) best = l;
+            }
+            ++slots[best];
+            ++used;
+        }
+        while (used > kLaneSlots) {
+            auto most = std::max_element(slots.begin(), slots.end());
+            --*most;
+            --used;
+        }
+
+        // Spread each lane's slots evenly over the period
+        std::vector<std::pair<double, uint32_t>> order;
+        order.reserve(kLaneSlots);
+        for (uint32_t l = 0; l < kLanes; ++l) {
+            for (uint32_t j = 0; j < slots[l]; ++j) {
+                order.emplace_back((j + 0.5) / slots[l], l);
+            }
+        }
+        std::sort(order.begin(), order.end());
+        schedule.reserve(kLaneSlots);
+        for (const auto& o : order) schedule.push_back(static_cast<uint8_t>(o.second));
+
+        tables.reserve(kLanes);
+        std::vector<double> w;
+        for (uint32_t l = 0; l < kLanes; ++l) {
+            w.clear();
+            for (uint32_t k : ranks[l]) w.push_back(weights[k]);
+            tables.emplace_back(w);
+        }
+    }
+};
+
+TrafficGenerator::TrafficGenerator(TrafficConfig config)
+    : config_(std::move(config)) {
+    config_.sources = std::max<uint32_t>(1, config_.sources);
+    config_.max_size = std::max(config_.max_size, config_.min_size);
+    if (config_.ports.empty()) config_.ports.push_back({80, Protocol::TCP, 1.0});
+    if (config_.attacks.size() > kMaxScenarios) config_.attacks.resize(kMaxScenarios);
+    for (auto& a : config_.attacks) {
+        a.attackers = std::clamp<uint32_t>(a.attackers, 1, kMaxAttackers);
+    }
+
+    std::vector<double> weights(config_.sources);
+    for (uint32_t k = 0; k < config_.sources; ++k) {
+        weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), config_.zipf_skew);
+    }
+    lanes_ = std::make_unique<Lanes>(weights, config_.source_base);
+
+    weights.clear();
+    for (const auto& p : config_.ports) weights.push_back(p.weight);
+    port_table_ = std::make_unique<AliasTable>(weights);
+}
+
+TrafficGenerator::~TrafficGenerator() = default;
+
+double TrafficGenerator::backgroundTime(uint64_t n) const {
+    return static_cast<double>(n) / config_.packets_per_sec;
+}
+
+double TrafficGenerator::attackTime(size_t scenario, uint64_t j) const {
+    const auto& a = config_.attacks[scenario];
+    return a.start_sec + static_cast<double>(j) / a.rate_pps;
+}
+
+uint64_t TrafficGenerator::attackCount(size_t scenario) const {
+    const auto& a = config_.attacks[scenario];
+    if (a.kind == AttackKind::LATENCY_SPIKE || a.rate_pps <= 0) return 0;
+    return static_cast<uint64_t>(a.duration_sec * a.rate_pps);
+}
+
+uint32_t TrafficGenerator::attackerAddr(size_t scenario, uint32_t attacker) const {
+    return kAttackerBase + (static_cast<uint32_t>(scenario) << 12) + attacker;
+}
+
+uint32_t TrafficGenerator::laneOf(uint32_t addr) {
+    return static_cast<uint32_t>(mix64(addr) % kLanes);
+}
+
+uint32_t TrafficGenerator::attackSource(size_t scenario, uint64_t j) const {
+    const auto& a = config_.attacks[scenario];
+    uint32_t attacker = a.kind == AttackKind::DISTRIBUTED_FLOOD
+                            ? static_cast<uint32_t>(j % a.attackers)
+                            : 0;
+    return attackerAddr(scenario, attacker);
+}
+
+Packet TrafficGenerator::background(uint64_t n) const {
+    PacketRng rng(config_.seed, 0, n);
+    Packet p;
+    uint32_t lane = lanes_->schedule[n % kLaneSlots];
+    uint32_t rank = lanes_->ranks[lane][lanes_->tables[lane].sample(rng.next())];
+    assignIPv4(p.src_ip, config_.source_base + rank);
+    assignIPv4(p.dst_ip, kVictimBase | static_cast<uint32_t>(rng.next() & 0xFFFF));
+
+    const PortMix& port = config_.ports[port_table_->sample(rng.next())];
+    p.dst_port   = port.port;
+    p.protocol   = port.protocol;
+    p.src_port   = static_cast<uint16_t>(1024 + rng.next() % 64512);
+    p.size_bytes = config_.min_size +
+                   static_cast<uint32_t>(rng.next() % (config_.max_size - config_.min_size + 1));
+
+    // Log-normal latency via Box-Muller
+    double u1 = 1.0 - rng.uniform();
+    double z  = std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * kPi * rng.uniform());
+    p.latency_ms = config_.latency_median_ms * std::exp(config_.latency_sigma * z);
+
+    double t = backgroundTime(n);
+    for (const auto& a : config_.attacks) {
+        if (a.kind == AttackKind::LATENCY_SPIKE && t >= a.start_sec &&
+            t < a.start_sec + a.duration_sec) {
+            p.latency_ms = a.latency_ms * (0.9 + 0.2 * rng.uniform());
+        }
+    }
+    p.timestamp = at(config_.start, t);
+    return p;
+}
+
+Packet TrafficGenerator::attack(size_t scenario, uint64_t j) const {
+    const auto& a = config_.attacks[scenario];
+    PacketRng rng(config_.seed, 1 + scenario, j);
+    Packet p;
+    assignIPv4(p.src_ip, attackSource(scenario, j));
+    assignIPv4(p.dst_ip, kVictimBase | 1);
+    p.src_port   = static_cast<uint16_t>(1024 + rng.next() % 64512);
+    p.latency_ms = config_.latency_median_ms * (0.8 + 0.4 * rng.uniform());
+    p.timestamp  = at(config_.start, attackTime(scenario, j));
+
+    if (a.kind == AttackKind::SCAN) {
+        p.dst_port   = static_cast<uint16_t>(1 + j % 65535);
+        p.protocol   = Protocol::UNKNOWN;
+        p.size_bytes = 60;
+    } else {
+        p.dst_port   = 80;
+        p.protocol   = Protocol::TCP;
+        p.size_bytes = 64;
+    }
+    return p;
+}
+
+TrafficGenerator::Stream::Stream(const TrafficGenerator& gen, size_t index,
+                                 size_t count, double duration_sec)
+    : gen_(&gen)
+    , index_(index)
+    , count_(std::max<size_t>(1, count)) {
+    background_.period = kLaneSlots;
+    background_.end = static_cast<uint64_t>(
+        std::ceil(duration_sec * gen.config_.packets_per_sec));
+    for (uint32_t slot = 0; slot < kLaneSlots; ++slot) {
+        if (ownsLane(gen.lanes_->schedule[slot])) background_.residues.push_back(slot);
+    }
+
+    for (size_t a = 0; a < gen.config_.attacks.size(); ++a) {
+        // Attack packets inside both the scenario and the generated span
+        uint64_t end = gen.attackCount(a);
+        const auto& sc = gen.config_.attacks[a];
+        if (sc.start_sec >= duration_sec) {
+            end = 0;
+        } else if (sc.start_sec + sc.duration_sec > duration_sec) {
+            end = std::min<uint64_t>(end, static_cast<uint64_t>(
+                std::ceil((duration_sec - sc.start_sec) * sc.rate_pps)));
+        }
+        // Packet j comes from attacker j % attackers (always 0 unless distributed)
+        Cursor cursor;
+        cursor.period = sc.kind == AttackKind::DISTRIBUTED_FLOOD ? sc.attackers : 1;
+        cursor.end    = end;
+        for (uint32_t k = 0; k < cursor.period; ++k) {
+            if (ownsLane(laneOf(gen.attackerAddr(a, k)))) cursor.residues.push_back(k);
+        }
+        attacks_.push_back(std::move(cursor));
+    }
+}
+
+void TrafficGenerator::Stream::Cursor::advance() {
+    if (++pos == residues.size()) {
+        pos = 0;
+        base += period;
+    }
+}
+
+bool TrafficGenerator::Stream::ownsLane(uint32_t lane) const {
+    return count_ == 1 || lane % count_ == index_;
+}
+
+size_t TrafficGenerator::Stream::next(std::vector<Packet>& out, size_t max) {
+    size_t produced = 0;
+    while (produced < max) {
+        // Merge background and attack sequences by event time
+        double best = std::numeric_limits<double>::infinity();
+        int which   = -2;  // -1 background, >= 0 scenario
+        if (!background_.done()) {
+            best  = gen_->backgroundTime(background_.index());
+            which = -1;
+        }
+        for (size_t a = 0; a < attacks_.size(); ++a) {
+            if (attacks_[a].done()) continue;
+            double t = gen_->attackTime(a, attacks_[a].index());
+            if (t < best) {
+                best  = t;
+                which = static_cast<int>(a);
+            }
+        }
+        if (which == -2) break;
+
+        if (which == -1) {
+            out.push_back(gen_->background(background_.index()));
+            background_.advance();
+        } else {
+            Cursor& cursor = attacks_[static_cast<size_t>(which)];
+            out.push_back(gen_->attack(static_cast<size_t>(which), cursor.index()));
+            cursor.advance();
+        }
+        ++produced;
+    }
+    return produced;
+}
+
+TrafficGenerator::Stream TrafficGenerator::stream(size_t index, size_t count,
+                                                  double duration_sec) const {
+    return Stream(*this, index, count, duration_sec);
+}
+
+std::vector<GroundTruthEvent> TrafficGenerator::groundTruth() const {
+    std::vector<GroundTruthEvent> events;
+    for (size_t i = 0; i < config_.attacks.size(); ++i) {
+        const auto& a = config_.attacks[i];
+        GroundTruthEvent e;
+        e.kind     = a.kind;
+        e.expected = expectedType(a.kind);
+        e.start    = at(config_.start, a.start_sec);
+        e.end      = at(config_.start, a.start_sec + a.duration_sec);
+        if (a.kind == AttackKind::LATENCY_SPIKE) {
+            e.packets = static_cast<uint64_t>(a.duration_sec * config_.packets_per_sec);
+        } else {
+            e.packets = attackCount(i);
+            uint32_t attackers = a.kind == AttackKind::DISTRIBUTED_FLOOD ? a.attackers : 1;
+            for (uint32_t k = 0; k < attackers; ++k) {
+                e.sources.push_back(formatIPv4(attackerAddr(i, k)));
+            }
+        }
+        events.push_back(std::move(e));
+    }
+    return events;
+}
+
+DetectionScore TrafficGenerator::score(const std::vector<GroundTruthEvent>& truth,
+                                       const AlertSnapshot& alerts,
+                                       std::chrono::seconds slack) {
+    std::vector<std::unordered_set<std::string>> sources;
+    for (const auto& e : truth) {
+        sources.emplace_back(e.sources.begin(), e.sources.end());
+    }
+
+    DetectionScore s;
+    s.events = truth.size();
+    s.alerts = alerts.size();
+    std::vector<bool> detected(truth.size(), false);
+    for (const auto& alert : alerts) {
+        const auto& r = alert->report;
+        const std::string source(r.source_ip);
+        bool matched = false;
+        for (size_t i = 0; i < truth.size(); ++i) {
+            const auto& e = truth[i];
+            if (r.type != e.expected || r.detected_at < e.start ||
+                r.detected_at > e.end + slack) {
+                continue;
+            }
+            if (!sources[i].empty() && !sources[i].count(source)) continue;
+            detected[i] = true;
+            matched     = true;
+        }
+        if (!matched) ++s.unmatched_alerts;
+    }
+    s.detected = static_cast<size_t>(std::count(detected.begin(), detected.end(), true));
+    s.recall   = s.events ? static_cast<double>(s.detected) / static_cast<double>(s.events)
+                          : 1.0;
+    return s;
+}
+
+DriveResult driveMonitor(NetworkMonitor& monitor, const TrafficGenerator& generator,
+                         const DriveOptions& options) {
+    size_t threads = std::max<size_t>(1, options.threads);
+    size_t batch_size = std::max<size_t>(1, options.batch_size);
+    std::atomic<uint64_t> offered{0};
+    std::atomic<uint64_t> accepted{0};
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> feeders;
+    for (size_t t = 0; t < threads; ++t) {
+        feeders.emplace_back([&, t] {
+            auto stream = generator.stream(t, threads, options.duration_sec);
+            double rate = options.target_pps / static_cast<double>(threads);
+            std::vector<Packet> batch;
+            batch.reserve(batch_size);
+            uint64_t sent = 0;
+            for (;;) {
+                batch.clear();
+                size_t n = stream.next(batch, batch_size);
+                if (n == 0) break;
+                accepted.fetch_add(monitor.feedBatch(batch.data(), n),
+                                   std::memory_order_relaxed);
+                sent += n;
+                if (rate > 0) {
+                    std::this_thread::sleep_until(
+                        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(
+                                        static_cast<double>(sent) / rate)));
+                }
+            }
+            offered.fetch_add(sent, std::memory_order_relaxed);
+        });
+    }
+    for (auto& f : feeders) f.join();
+
+    DriveResult result;
+    result.offered  = offered.load();
+    result.accepted = accepted.load();
+    result.seconds  = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    result.pps = result.seconds > 0 ? static_cast<double>(result.offered) / result.seconds
+                                    : 0.0;
+    return result;
+}
+
+} // namespace anomaly
@@ -0,0 +1,160 @@
+#include "anomaly_c.h"
+#include "AnomalyDetector.h"
+#include "IpAddress.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+using namespace anomaly;
+
+// No C++ exception may cross the C boundary: every entry point that can
+// throw (allocation, mutex errors) catches and reports failure instead.
+//
+// Rows are converted into a reused Packet chunk (addresses fit the string
+// small-buffer, so steady state does not allocate) and analyzed a chunk
+// at a time. Only the report columns are returned, so each chunk's
+// reports live in an arena that is reset before the next.
+struct anomaly_detector {
+    explicit anomaly_detector(const DetectorConfig& config)
+        : detector(config), arena_buffer(64 * 1024),
+          arena(arena_buffer.data(), arena_buffer.size()) {}
+
+    AnomalyDetector detector;
+    std::vector<Packet> chunk;
+    std::vector<std::byte> arena_buffer;
+    std::pmr::monotonic_buffer_resource arena;  // chunks with many reports spill to the heap
+    std::vector<size_t> rows;
+};
+
+namespace {
+constexpr size_t kChunkRows = 4096;
+
+DetectorConfig toDetectorConfig(const anomaly_config& c) {
+    DetectorConfig config;
+    config.max_latency_ms        = c.max_latency_ms;
+    config.flood_threshold       = c.flood_threshold;
+    config.packet_loss_threshold = c.packet_loss_threshold;
+    config.window_size_sec       = c.window_size_sec;
+    config.source_idle_sec       = c.source_idle_sec;
+    return config;
+}
+
+void setAddress(std::string& out, uint32_t addr) {
+    char buf[16];
+    out.assign(buf, formatIPv4(addr, buf));
+}
+
+void fillPacket(Packet& p, const anomaly_batch& b, size_t i) {
+    setAddress(p.src_ip, b.src_addr[i]);
+    setAddress(p.dst_ip, b.dst_addr ? b.dst_addr[i] : 0);
+    p.src_port   = b.src_port ? b.src_port[i] : 0;
+    p.dst_port   = b.dst_port ? b.dst_port[i] : 0;
+    if (!b.protocol) {
+        p.protocol = Protocol::TCP;
+    } else {
+        p.protocol = b.protocol[i] <= ANOMALY_PROTO_UNKNOWN ? static_cast<Protocol>(b.protocol[i])
+                                                            : Protocol::UNKNOWN;
+    }
+    p.size_bytes = b.size_bytes ? b.size_bytes[i] : 0;
+    p.latency_ms = b.latency_ms[i];
+    p.timestamp  = b.timestamp_ns ? fromNanos(b.timestamp_ns[i]) : TimePoint{};
+}
+} // namespace
+
+extern "C" {
+
+int anomaly_abi_version(void) {
+    return ANOMALY_C_ABI_VERSION;
+}
+
+void anomaly_config_init(anomaly_config* config) {
+    if (!config) return;
+    DetectorConfig d;
+    config->max_latency_ms        = d.max_latency_ms;
+    config->flood_threshold       = d.flood_threshold;
+    config->packet_loss_threshold = d.packet_loss_threshold;
+    config->window_size_sec       = d.window_size_sec;
+    config->source_idle_sec       = d.source_idle_sec;
+}
+
+anomaly_detector* anomaly_detector_create(const anomaly_config* config) {
+    try {
+        DetectorConfig d = config ? toDetectorConfig(*config) : DetectorConfig{};
+        return new anomaly_detector(d);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void anomaly_detector_destroy(anomaly_detector* detector) {
+    delete detector;
+}
+
+void anomaly_detector_reset(anomaly_detector* detector) {
+    if (!detector) return;
+    try {
+        detector->detector.reset();
+    } catch (...) {
+        // Only lock failures can land here; the state is left as it was
+    }
+}
+
+size_t anomaly_detector_sources(const anomaly_detector* detector) {
+    if (!detector) return 0;
+    try {
+        return detector->detector.trackedSources();
+    } catch (...) {
+        return 0;
+    }
+}
+
+int64_t anomaly_detector_analyze(anomaly_detector* detector, const anomaly_batch* batch,
+                                 anomaly_results* out) {
+    if (!detector || !batch || !out) return -1;
+    if (batch->count > 0 && (!batch->src_addr || !batch->latency_ms)) return -1;
+    if (out->capacity > 0 && (!out->row || !out->type || !out->severity || !out->detected_ns)) {
+        return -1;
+    }
+
+    size_t written = 0;
+    out->overflow = 0;
+    try {
+        for (size_t base = 0; base < batch->count; base += kChunkRows) {
+            size_t n = std::min(kChunkRows, batch->count - base);
+            if (detector->chunk.size() < n) detector->chunk.resize(n);
+            for (size_t i = 0; i < n; ++i) fillPacket(detector->chunk[i], *batch, base + i);
+
+            detector->rows.clear();
+            {
+                std::pmr::vector<AnomalyReport> reports(&detector->arena);
+                detector->detector.analyzeBatch(detector->chunk.data(), n, reports,
+                                                &detector->rows);
+                for (size_t k = 0; k < reports.size(); ++k) {
+                    if (written == out->capacity) {
+                        out->overflow += reports.size() - k;
+                        break;
+                    }
+                    const AnomalyReport& r = reports[k];
+                    out->row[written]         = base + detector->rows[k];
+                    out->type[written]        = static_cast<uint8_t>(r.type);
+                    out->severity[written]    = r.severity;
+                    out->detected_ns[written] = toNanos(r.detected_at);
+                    ++written;
+                }
+            }
+            detector->arena.release();
+        }
+    } catch (...) {
+        detector->arena.release();
+        return -1;
+    }
+    return static_cast<int64_t>(written);
+}
+
+const char* anomaly_type_name(int type) {
+    if (type < ANOMALY_NONE || type > ANOMALY_UNKNOWN_PROTOCOL) return "NONE";
+    return anomalyTypeName(static_cast<AnomalyType>(type));
+}
+
+} // extern "C"
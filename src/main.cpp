@@ -1,42 +1,187 @@
 #include "NetworkMonitor.h"
 #include "AnomalyDetector.h"
 #include "AlertManager.h"
+#include "NdjsonExporter.h"
+#include "ColumnarExporter.h"
+#include "Metrics.h"
+#include "Rollups.h"
+#ifdef __unix__
+#include "AlertStream.h"
+#endif
+#ifdef __linux__
+#include "IngestServer.h"
+#include "PacketRing.h"
+#include <csignal>
+#endif
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <thread>
 #include <chrono>
 
-int main() {
+#ifdef __linux__
+namespace {
+volatile std::sig_atomic_t g_interrupted = 0;
+void onSignal(int) { g_interrupted = 1; }
+} // namespace
+#endif
+
+// Runs the traffic simulator, or with --listen-udp PORT / --listen-unix PATH
+// takes live records from collectors (--ring NAME: from a capture process
+// through a shared-memory packet ring) until interrupted. UDP binds to
+// 127.0.0.1 unless --listen-address ADDR is given.
+int main(int argc, char** argv) {
     std::cout << "=== 5G Network Anomaly Detector ===\n\n";
 
+#ifdef __linux__
+    anomaly::IngestConfig ingest_config;
+    std::string ring_name;
+    bool listen = false, sockets = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!std::strcmp(argv[i], "--listen-udp")) {
+            ingest_config.udp_port = static_cast<uint16_t>(std::atoi(argv[i + 1]));
+            listen = sockets = true;
+        } else if (!std::strcmp(argv[i], "--listen-address")) {
+            // Records are unauthenticated: bind beyond loopback only on request
+            ingest_config.udp_address = argv[i + 1];
+        } else if (!std::strcmp(argv[i], "--listen-unix")) {
+            ingest_config.unix_path = argv[i + 1];
+            listen = sockets = true;
+        } else if (!std::strcmp(argv[i], "--ring")) {
+            ring_name = argv[i + 1];
+            listen = true;
+        }
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
     // Configure detector thresholds
     anomaly::DetectorConfig config;
     config.max_latency_ms      = 100.0;
     config.flood_threshold     = 50;
     config.packet_loss_threshold = 0.05;
 
+    // Collapse repeated alerts per (type, source) into one summary per minute
+    anomaly::AlertManagerConfig alert_config;
+    alert_config.suppression.enabled    = true;
+    alert_config.suppression.window_sec = 60;
+
     auto detector      = std::make_shared<anomaly::AnomalyDetector>(config);
-    auto alert_manager = std::make_shared<anomaly::AlertManager>("alerts.log");
+    auto alert_manager = std::make_shared<anomaly::AlertManager>("alerts.log",
+                                                                 alert_config);
     auto monitor       = std::make_unique<anomaly::NetworkMonitor>(
                              detector, alert_manager);
 
+#ifdef __unix__
+    // Live feed for local consumers (see tools/alert_tail.cpp)
+    std::shared_ptr<anomaly::AlertStreamPublisher> stream =
+        anomaly::AlertStreamPublisher::create("/5g-alerts");
+    if (stream) {
+        alert_manager->onAlert([stream](const anomaly::Alert& alert) {
+            stream->publish(alert);
+        });
+    }
+#endif
+
+    // Prometheus textfile-collector output, rewritten every second
+    anomaly::metrics::FileExporter metrics_file("metrics.prom",
+                                                std::chrono::seconds(1));
+
+    // Per-second traffic rollups by destination port (python/analyze.py --rollups)
+    anomaly::TrafficRollups rollups("traffic.rollup");
+    rollups.attach(*monitor);
+
     // Start background monitoring thread
     monitor->start();
 
-    // Simulate 5G network traffic
-    monitor->simulateTraffic(50);
+#ifdef __linux__
+    if (listen) {
+        std::unique_ptr<anomaly::IngestServer> ingest;
+        std::unique_ptr<anomaly::PacketRingIngest> ring;
+        if (!ring_name.empty()) {
+            auto consumer = anomaly::PacketRingConsumer::create(ring_name);
+            if (!consumer) {
+                std::cerr << "Cannot create packet ring " << ring_name << "\n";
+                monitor->stop();
+                return 1;
+            }
+            ring = std::make_unique<anomaly::PacketRingIngest>(std::move(consumer), *monitor);
+        }
+        if (sockets) {
+            ingest = anomaly::IngestServer::create(*monitor, ingest_config);
+            if (!ingest) {
+                std::cerr << "Cannot bind the ingest socket\n";
+                monitor->stop();
+                return 1;
+            }
+        }
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        if (ingest) {
+            ingest->start();
+            std::cout << "Listening on "
+                      << (ingest_config.unix_path.empty()
+                              ? "udp " + ingest_config.udp_address + ":" +
+                                    std::to_string(ingest->port())
+                              : ingest_config.unix_path)
+                      << ", Ctrl-C to stop\n";
+        }
+        if (ring) {
+            ring->start();
+            std::cout << "Reading packet ring " << ring_name << ", Ctrl-C to stop\n";
+        }
+        while (!g_interrupted) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        if (ingest) {
+            ingest->stop();
+            auto s = ingest->stats();
+            std::cout << "Ingested " << s.records << " records in " << s.datagrams
+                      << " datagrams (" << s.parse_errors << " parse errors, "
+                      << s.socket_drops << " socket drops)\n";
+        }
+        if (ring) {
+            ring->stop();
+            auto s = ring->stats();
+            std::cout << "Ingested " << s.records << " records from the packet ring ("
+                      << s.dropped << " dropped by the producer)\n";
+        }
+    } else
+#endif
+    {
+        // Simulate 5G network traffic
+        monitor->simulateTraffic(50);
 
-    // Wait for processing to complete
-    std::this_thread::sleep_for(std::chrono::seconds(2));
+        // Wait for processing to complete
+        std::this_thread::sleep_for(std::chrono::seconds(2));
+    }
 
     monitor->stop();
+    rollups.flush();
+    alert_manager->flushSuppressed();
+    alert_manager->flushLog();
 
     // Export results for Python analysis layer
     alert_manager->exportToJSON("alerts.json");
+    anomaly::NdjsonExporter ndjson("alerts.ndjson");
+    ndjson.exportNew(*alert_manager);
+    anomaly::ColumnarExporter columnar("alerts.col");
+    if (!columnar.isOpen()) {
+        std::cerr << "alerts.col exists and is not a columnar alert file; left it alone\n";
+    }
+    columnar.exportNew(*alert_manager);
+    alert_manager->writeSummary("alerts.summary.json");
 
     std::cout << "\n=== Summary ===\n";
+    auto suppression = alert_manager->suppressionStats();
     std::cout << "Total alerts raised: " << alert_manager->count() << "\n";
-    std::cout << "Results exported to alerts.json\n";
+    std::cout << "Alerts suppressed  : " << suppression.suppressed
+              << " (" << suppression.summaries << " summaries)\n";
+    std::cout << "Results exported to alerts.json, alerts.ndjson and alerts.col\n";
+    std::cout << "Runtime metrics in metrics.prom, traffic rollups in traffic.rollup\n";
     std::cout << "Run python/analyze.py for visualization.\n";
 
     return 0;
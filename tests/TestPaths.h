@@ -0,0 +1,18 @@
+#pragma once
+#include <gtest/gtest.h>
+#include <string>
+
+// A file or directory name unique to the running test, so ctest -j can run
+// the tests of one suite as concurrent processes without sharing files:
+// "stem.ext" becomes "stem-Suite-Test.ext" ('/' in parameterised names
+// becomes '_'). Call from a fixture or test body.
+inline std::string testPath(const std::string& name) {
+    const auto* info = ::testing::UnitTest::GetInstance()->current_test_info();
+    std::string tag = std::string(info->test_suite_name()) + "-" + info->name();
+    for (char& c : tag) {
+        if (c == '/') c = '_';
+    }
+    auto dot = name.find('.');
+    if (dot == std::string::npos) return name + "-" + tag;
+    return name.substr(0, dot) + "-" + tag + name.substr(dot);
+}
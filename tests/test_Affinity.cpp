@@ -0,0 +1,35 @@
+#include <gtest/gtest.h>
+#include "Affinity.h"
+#include <thread>
+
+using namespace anomaly;
+
+TEST(AffinityTest, TopologyCoversOnlineCpus) {
+    auto nodes = numaTopology();
+    ASSERT_FALSE(nodes.empty());
+    size_t cpus = 0;
+    for (const auto& n : nodes) cpus += n.cpus.size();
+    EXPECT_GE(cpus, 1u);
+    EXPECT_NE(describeTopology().find("NUMA node"), std::string::npos);
+}
+
+TEST(AffinityTest, RejectsInvalidCpu) {
+    EXPECT_FALSE(pinCurrentThread(-1));
+    EXPECT_EQ(numaNodeOfCpu(-1), -1);
+}
+
+#ifdef __linux__
+TEST(AffinityTest, PinnedThreadRunsOnItsCpu) {
+    int cpu = numaTopology().front().cpus.front();
+    int seen = -2;
+    bool placed = false;
+    std::thread t([&] {
+        placed = placeCurrentThread(cpu);
+        seen   = currentCpu();
+    });
+    t.join();
+    ASSERT_TRUE(placed);
+    EXPECT_EQ(seen, cpu);
+    EXPECT_GE(numaNodeOfCpu(cpu), 0);
+}
+#endif
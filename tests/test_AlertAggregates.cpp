@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include "AlertAggregates.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+
+using namespace anomaly;
+
+class AlertAggregatesTest : public ::testing::Test {
+protected:
+    const TimePoint t0 = fromNanos(1'700'000'000'000'000'000LL);
+
+    Alert makeAlert(AlertLevel level, const std::string& ip, double severity,
+                    int offset_sec = 0) {
+        Alert a;
+        a.level              = level;
+        a.report.type        = AnomalyType::FLOOD;
+        a.report.source_ip   = ip;
+        a.report.severity    = severity;
+        a.report.detected_at = t0 + std::chrono::seconds(offset_sec);
+        return a;
+    }
+};
+
+TEST_F(AlertAggregatesTest, CountsAndMoments) {
+    AlertAggregates agg;
+    agg.add(makeAlert(AlertLevel::LOW, "10.0.0.1", 0.2));
+    agg.add(makeAlert(AlertLevel::CRITICAL, "10.0.0.2", 0.9));
+    agg.add(makeAlert(AlertLevel::MEDIUM, "10.0.0.1", 0.4));
+
+    auto s = agg.lifetime();
+    EXPECT_EQ(s.total, 3u);
+    EXPECT_EQ(s.by_level[static_cast<size_t>(AlertLevel::LOW)], 1u);
+    EXPECT_EQ(s.by_type[static_cast<size_t>(AnomalyType::FLOOD)], 3u);
+    EXPECT_DOUBLE_EQ(s.severity.mean, 0.5);
+    EXPECT_DOUBLE_EQ(s.severity.min, 0.2);
+    EXPECT_DOUBLE_EQ(s.severity.max, 0.9);
+    ASSERT_FALSE(s.top_offenders.empty());
+    EXPECT_EQ(s.top_offenders[0].source_ip, "10.0.0.1");
+    EXPECT_EQ(s.top_offenders[0].count, 2u);
+}
+
+TEST_F(AlertAggregatesTest, WindowResetsLifetimeDoesNot) {
+    AggregateConfig config;
+    config.window_sec = 60;
+    AlertAggregates agg(config);
+
+    agg.add(makeAlert(AlertLevel::LOW, "10.0.0.1", 0.2, 0));
+    agg.add(makeAlert(AlertLevel::LOW, "10.0.0.1", 0.2, 120));
+
+    EXPECT_EQ(agg.lifetime().total, 2u);
+    EXPECT_EQ(agg.window().total, 1u);
+}
+
+TEST_F(AlertAggregatesTest, TopOffendersStayBounded) {
+    // A source above 1/capacity of the traffic is always retained
+    TopOffenders top(4);
+    for (int i = 0; i < 1000; ++i) {
+        top.add("10.0.0.99");
+        top.add("10.1.0." + std::to_string(i % 250));
+    }
+
+    auto best = top.top(1);
+    ASSERT_EQ(best.size(), 1u);
+    EXPECT_EQ(best[0].source_ip, "10.0.0.99");
+    EXPECT_GE(best[0].count, 1000u);
+    EXPECT_EQ(top.top(10).size(), 4u);
+}
+
+TEST_F(AlertAggregatesTest, TopOffendersKeepSpaceSavingBounds) {
+    TopOffenders top(8);
+    std::map<std::string, uint64_t> exact;
+    std::mt19937 rng(7);
+    std::geometric_distribution<int> skewed(0.15);
+    const int n = 20000;
+    for (int i = 0; i < n; ++i) {
+        std::string ip = "10.0.0." + std::to_string(skewed(rng) % 200);
+        top.add(ip);
+        ++exact[ip];
+    }
+
+    auto all = top.top(100);
+    ASSERT_EQ(all.size(), 8u);
+    uint64_t total = 0;
+    for (size_t i = 0; i < all.size(); ++i) {
+        if (i > 0) {
+            EXPECT_GE(all[i - 1].count, all[i].count);
+        }
+        // Over-counts by at most error, never under-counts
+        EXPECT_GE(all[i].count, exact[all[i].source_ip]);
+        EXPECT_LE(all[i].count - all[i].error, exact[all[i].source_ip]);
+        total += all[i].count;
+    }
+    EXPECT_EQ(total, static_cast<uint64_t>(n));
+    EXPECT_EQ(all[0].source_ip, "10.0.0.0");
+
+    top.clear();
+    EXPECT_TRUE(top.top(3).empty());
+    top.add("10.0.0.1");
+    top.add("10.0.0.1");
+    top.add("10.0.0.2");
+    auto two = top.top(3);
+    ASSERT_EQ(two.size(), 2u);
+    EXPECT_EQ(two[0].source_ip, "10.0.0.1");
+    EXPECT_EQ(two[0].count, 2u);
+    EXPECT_EQ(two[1].count, 1u);
+}
+
+TEST_F(AlertAggregatesTest, WritesSummaryFile) {
+    AlertAggregates agg;
+    agg.add(makeAlert(AlertLevel::HIGH, "10.0.0.1", 0.7));
+    ASSERT_TRUE(agg.writeSummary("test_summary.json"));
+
+    std::ifstream in("test_summary.json");
+    std::string body((std::istreambuf_iterator<char>(in)), {});
+    EXPECT_NE(body.find("\"lifetime\":{\"total\":1"), std::string::npos);
+    EXPECT_NE(body.find("\"HIGH\":1"), std::string::npos);
+    std::filesystem::remove("test_summary.json");
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "AlertLogWriter.h"
+#include "TestPaths.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace anomaly;
+
+class AlertLogWriterTest : public ::testing::Test {
+protected:
+    const std::string path = testPath("test_writer.log");
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    size_t lineCount() const {
+        std::ifstream in(path);
+        size_t n = 0;
+        for (std::string line; std::getline(in, line);) ++n;
+        return n;
+    }
+};
+
+TEST_F(AlertLogWriterTest, FlushWritesAllLines) {
+    LogWriterConfig config;
+    config.console = false;
+    AlertLogWriter writer(path, config);
+
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_TRUE(writer.submit("line " + std::to_string(i) + "\n"));
+    }
+    writer.flush();
+
+    EXPECT_EQ(lineCount(), 1000u);
+    EXPECT_EQ(writer.stats().written, 1000u);
+    EXPECT_LT(writer.stats().batches, 1000u);
+}
+
+TEST_F(AlertLogWriterTest, DropNewestWhenQueueFull) {
+    LogWriterConfig config;
+    config.console           = false;
+    config.queue_capacity    = 2;
+    config.batch_size        = 100;
+    config.flush_interval_ms = 10'000;
+    config.overflow          = LogOverflowPolicy::DROP_NEWEST;
+    AlertLogWriter writer(path, config);
+
+    int accepted = 0;
+    for (int i = 0; i < 5; ++i) accepted += writer.submit("x\n");
+    writer.flush();
+
+    EXPECT_EQ(accepted, 2);
+    EXPECT_EQ(writer.stats().dropped, 3u);
+    EXPECT_EQ(lineCount(), 2u);
+}
+
+TEST_F(AlertLogWriterTest, DestructorDrainsQueue) {
+    {
+        LogWriterConfig config;
+        config.console           = false;
+        config.flush_interval_ms = 10'000;
+        config.fsync             = FsyncPolicy::EVERY_BATCH;
+        AlertLogWriter writer(path, config);
+        writer.submit("a\n");
+        writer.submit("b\n");
+    }
+    EXPECT_EQ(lineCount(), 2u);
+}
+
+TEST(TimestampFormatterTest, ReusesSecondPrefix) {
+    TimestampFormatter fmt;
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    std::string a = fmt.format(t0);
+    const std::string& b = fmt.format(t0 + std::chrono::milliseconds(500));
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.size(), 19u);
+    EXPECT_NE(fmt.format(t0 + std::chrono::seconds(1)), a);
+}
@@ -1,21 +1,27 @@
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "AlertManager.h"
+#include "TestPaths.h"
 #include <filesystem>
+#include <fstream>
 
 using namespace anomaly;
 
 class AlertManagerTest : public ::testing::Test {
 protected:
     std::unique_ptr<AlertManager> manager;
+    std::string log_path;
+    std::string export_path;
 
     void SetUp() override {
-        manager = std::make_unique<AlertManager>("test_alerts.log");
+        log_path    = testPath("test_alerts.log");
+        export_path = testPath("test_export.json");
+        manager = std::make_unique<AlertManager>(log_path);
     }
 
     void TearDown() override {
-        std::filesystem::remove("test_alerts.log");
-        std::filesystem::remove("test_export.json");
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(export_path);
     }
 
     AnomalyReport makeReport(AnomalyType type, double severity,
@@ -68,8 +74,8 @@ TEST_F(AlertManagerTest, FilterByLevelReturnsOnlyMatching) {
 
 TEST_F(AlertManagerTest, ExportToJSONCreatesFile) {
     manager->raise(makeReport(AnomalyType::HIGH_LATENCY, 0.7));
-    manager->exportToJSON("test_export.json");
-    EXPECT_TRUE(std::filesystem::exists("test_export.json"));
+    manager->exportToJSON(export_path);
+    EXPECT_TRUE(std::filesystem::exists(export_path));
 }
 
 TEST_F(AlertManagerTest, MultipleAlertsCountCorrectly) {
@@ -79,3 +85,118 @@ TEST_F(AlertManagerTest, MultipleAlertsCountCorrectly) {
     }
     EXPECT_EQ(manager->count(), 5u);
 }
+
+TEST_F(AlertManagerTest, SuppressionCollapsesRepeatedAlerts) {
+    AlertManagerConfig config;
+    config.suppression.enabled    = true;
+    config.suppression.window_sec = 60;
+    AlertManager suppressed(log_path, config);
+
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    for (int i = 0; i < 100; ++i) {
+        auto r = makeReport(AnomalyType::FLOOD, 0.5 + i * 0.001);
+        r.detected_at = t0 + std::chrono::milliseconds(i);
+        suppressed.raise(r);
+    }
+    EXPECT_EQ(suppressed.count(), 1u);
+
+    suppressed.flushSuppressed();
+    ASSERT_EQ(suppressed.count(), 2u);
+    EXPECT_DOUBLE_EQ(suppressed.getAlerts()[1]->report.severity, 0.599);
+
+    auto stats = suppressed.suppressionStats();
+    EXPECT_EQ(stats.emitted, 1u);
+    EXPECT_EQ(stats.suppressed, 99u);
+    EXPECT_EQ(stats.summaries, 1u);
+}
+
+TEST_F(AlertManagerTest, SuppressionSummarisesWhenWindowEnds) {
+    AlertManagerConfig config;
+    config.suppression.enabled    = true;
+    config.suppression.window_sec = 10;
+    AlertManager suppressed(log_path, config);
+
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    for (int i = 0; i < 3; ++i) {
+        auto r = makeReport(AnomalyType::FLOOD, 0.9);
+        r.detected_at = t0;
+        suppressed.raise(r);
+    }
+
+    // A later window: old key is summarised, new one passes through
+    auto r = makeReport(AnomalyType::FLOOD, 0.9);
+    r.detected_at = t0 + std::chrono::seconds(30);
+    suppressed.raise(r);
+
+    EXPECT_EQ(suppressed.count(), 3u);  // first, summary, new first
+    EXPECT_EQ(suppressed.suppressionStats().summaries, 1u);
+}
+
+TEST_F(AlertManagerTest, SuppressionFoldsLateReportsIntoCurrentWindow) {
+    SuppressionConfig config;
+    config.enabled    = true;
+    config.window_sec = 10;
+    AlertSuppressor suppressor(config);
+
+    // Two workers interleave reports across the 10 s boundary
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);  // a window start
+    std::vector<AnomalyReport> out;
+    for (int ms : {9'900, 10'100, 9'950, 10'200, 9'990}) {
+        auto r = makeReport(AnomalyType::FLOOD, 0.5 + ms / 100'000.0);
+        r.detected_at = t0 + std::chrono::milliseconds(ms);
+        suppressor.process(r, out);
+    }
+    // One first alert per window, no repeats after the late ones
+    ASSERT_EQ(out.size(), 2u);
+    EXPECT_EQ(out[1].detected_at, t0 + std::chrono::milliseconds(10'100));
+    EXPECT_EQ(suppressor.stats().emitted, 2u);
+    EXPECT_EQ(suppressor.stats().suppressed, 3u);
+
+    out.clear();
+    suppressor.flush(out);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_EQ(out[0].detected_at, t0 + std::chrono::milliseconds(10'200));
+    EXPECT_NE(out[0].description.find("3 more occurrences"), std::string::npos);
+}
+
+TEST_F(AlertManagerTest, SuppressionKeysAreBounded) {
+    SuppressionConfig config;
+    config.enabled  = true;
+    config.max_keys = 4;
+    AlertSuppressor suppressor(config);
+
+    std::vector<AnomalyReport> out;
+    for (int i = 0; i < 10; ++i) {
+        suppressor.process(makeReport(AnomalyType::FLOOD, 0.9,
+                                      "10.0.0." + std::to_string(i)), out);
+    }
+    EXPECT_EQ(suppressor.trackedKeys(), 4u);
+    EXPECT_EQ(suppressor.stats().evicted, 6u);
+    EXPECT_EQ(out.size(), 10u);
+}
+
+TEST_F(AlertManagerTest, FlushLogPersistsAlerts) {
+    manager->raise(makeReport(AnomalyType::HIGH_LATENCY, 0.5));
+    manager->raise(makeReport(AnomalyType::FLOOD, 0.9));
+    manager->flushLog();
+
+    std::ifstream in(log_path);
+    std::string first;
+    std::getline(in, first);
+    EXPECT_NE(first.find("[MEDIUM] Test anomaly"), std::string::npos);
+    EXPECT_EQ(manager->logStats().written, 2u);
+}
+
+TEST_F(AlertManagerTest, RaiseBatchRecordsInOrder) {
+    std::vector<AnomalyReport> reports = {
+        makeReport(AnomalyType::HIGH_LATENCY, 0.5, "10.0.0.1"),
+        makeReport(AnomalyType::FLOOD, 0.9, "10.0.0.2"),
+    };
+    manager->raiseBatch(reports);
+    manager->raiseBatch({});
+
+    auto alerts = manager->getAlerts();
+    ASSERT_EQ(alerts.size(), 2u);
+    EXPECT_EQ(alerts[0]->report.source_ip, "10.0.0.1");
+    EXPECT_EQ(alerts[1]->report.source_ip, "10.0.0.2");
+}
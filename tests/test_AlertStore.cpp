@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "AlertStore.h"
+
+using namespace anomaly;
+
+class AlertStoreTest : public ::testing::Test {
+protected:
+    const TimePoint t0 = fromNanos(1'700'000'000'000'000'000LL);
+
+    Alert makeAlert(AlertLevel level, const std::string& ip, int offset_sec) {
+        Alert a;
+        a.level              = level;
+        a.message            = "Test anomaly";
+        a.report.source_ip   = ip;
+        a.report.detected_at = t0 + std::chrono::seconds(offset_sec);
+        return a;
+    }
+};
+
+TEST_F(AlertStoreTest, CapacityIsFixed) {
+    AlertStoreConfig config;
+    config.capacity = 8;
+    AlertStore store(config);
+
+    for (int i = 0; i < 100; ++i) {
+        store.push(makeAlert(AlertLevel::LOW, "10.0.0." + std::to_string(i % 3), i));
+    }
+    EXPECT_EQ(store.size(), 8u);
+    EXPECT_EQ(store.evicted(), 92u);
+    EXPECT_EQ(store.firstSequence(), 92u);
+    EXPECT_EQ(store.all().front()->sequence, 92u);
+}
+
+TEST_F(AlertStoreTest, IndexesFollowEviction) {
+    AlertStoreConfig config;
+    config.capacity = 4;
+    AlertStore store(config);
+
+    store.push(makeAlert(AlertLevel::CRITICAL, "10.0.0.1", 0));
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.2", 1));
+    store.push(makeAlert(AlertLevel::CRITICAL, "10.0.0.1", 2));
+    EXPECT_EQ(store.byLevel(AlertLevel::CRITICAL).size(), 2u);
+    EXPECT_EQ(store.bySource("10.0.0.1").size(), 2u);
+
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.3", 3));
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.3", 4));  // evicts seq 0
+
+    EXPECT_EQ(store.byLevel(AlertLevel::CRITICAL).size(), 1u);
+    EXPECT_EQ(store.bySource("10.0.0.1").size(), 1u);
+    EXPECT_EQ(store.bySource("10.0.0.3").size(), 2u);
+}
+
+TEST_F(AlertStoreTest, TimeRangeIsHalfOpen) {
+    AlertStoreConfig config;
+    config.bucket_sec = 60;
+    AlertStore store(config);
+    for (int i = 0; i < 300; i += 10) {
+        store.push(makeAlert(AlertLevel::LOW, "10.0.0.1", i));
+    }
+
+    auto range = store.byTimeRange(t0 + std::chrono::seconds(55),
+                                   t0 + std::chrono::seconds(125));
+    ASSERT_EQ(range.size(), 7u);  // 60..120
+    EXPECT_EQ(range.front()->report.detected_at, t0 + std::chrono::seconds(60));
+}
+
+TEST_F(AlertStoreTest, ReversedTimeRangeIsEmpty) {
+    AlertStoreConfig config;
+    config.bucket_sec = 60;
+    AlertStore store(config);
+    for (int i = 0; i < 300; i += 10) {
+        store.push(makeAlert(AlertLevel::LOW, "10.0.0.1", i));
+    }
+
+    // from lies in a later bucket than to
+    EXPECT_TRUE(store.byTimeRange(t0 + std::chrono::seconds(250),
+                                  t0 + std::chrono::seconds(10)).empty());
+    EXPECT_TRUE(store.byTimeRange(t0 + std::chrono::seconds(60),
+                                  t0 + std::chrono::seconds(60)).empty());
+}
+
+TEST_F(AlertStoreTest, SnapshotOutlivesEviction) {
+    AlertStoreConfig config;
+    config.capacity = 1;
+    AlertStore store(config);
+
+    store.push(makeAlert(AlertLevel::HIGH, "10.0.0.1", 0));
+    auto snapshot = store.all();
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.2", 1));
+
+    ASSERT_EQ(snapshot.size(), 1u);
+    EXPECT_EQ(snapshot[0]->report.source_ip, "10.0.0.1");
+}
+
+TEST_F(AlertStoreTest, SinceReturnsNewAlertsOnly) {
+    AlertStore store;
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.1", 0));
+    uint64_t cursor = store.nextSequence();
+    store.push(makeAlert(AlertLevel::LOW, "10.0.0.2", 1));
+
+    auto fresh = store.since(cursor);
+    ASSERT_EQ(fresh.size(), 1u);
+    EXPECT_EQ(fresh[0]->report.source_ip, "10.0.0.2");
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include "AlertStream.h"
+#include "AlertManager.h"
+#include <unistd.h>
+#include <cstdio>
+#include <thread>
+
+using namespace anomaly;
+
+class AlertStreamTest : public ::testing::Test {
+protected:
+    std::string name = "/5g-alerts-test-" + std::to_string(::getpid());
+
+    Alert makeAlert(uint64_t seq, const std::string& ip = "10.0.0.1") {
+        Alert a;
+        a.level              = AlertLevel::HIGH;
+        a.message            = "alert " + std::to_string(seq);
+        a.sequence           = seq;
+        a.report.type        = AnomalyType::FLOOD;
+        a.report.source_ip   = ip;
+        a.report.severity    = 0.8;
+        a.report.detected_at = fromNanos(1'700'000'000'000'000'000LL);
+        return a;
+    }
+};
+
+TEST_F(AlertStreamTest, OpenFailsWithoutPublisher) {
+    EXPECT_EQ(AlertStreamReader::open(name), nullptr);
+}
+
+TEST_F(AlertStreamTest, ReaderSeesAlertsPublishedAfterOpen) {
+    auto publisher = AlertStreamPublisher::create(name, 16);
+    ASSERT_NE(publisher, nullptr);
+    publisher->publish(makeAlert(0));  // before the reader: not seen
+
+    auto reader = AlertStreamReader::open(name);
+    ASSERT_NE(reader, nullptr);
+    publisher->publish(makeAlert(1, "192.168.1.7"));
+    publisher->publish(makeAlert(2));
+
+    std::vector<stream::AlertRecord> out;
+    ASSERT_EQ(reader->poll(out), 2u);
+    EXPECT_EQ(out[0].alert_seq, 1u);
+    EXPECT_STREQ(out[0].source_ip, "192.168.1.7");
+    EXPECT_EQ(out[0].source_addr, 0xC0A80107u);
+    EXPECT_EQ(std::string(out[0].message, out[0].message_len), "alert 1");
+    EXPECT_EQ(out[0].type, static_cast<uint8_t>(AnomalyType::FLOOD));
+    EXPECT_DOUBLE_EQ(out[0].severity, 0.8);
+    EXPECT_EQ(reader->poll(out), 0u);
+    EXPECT_EQ(reader->overruns(), 0u);
+}
+
+TEST_F(AlertStreamTest, LappedReaderCountsOverruns) {
+    auto publisher = AlertStreamPublisher::create(name, 8);
+    ASSERT_NE(publisher, nullptr);
+    auto reader = AlertStreamReader::open(name);
+    ASSERT_NE(reader, nullptr);
+
+    for (uint64_t i = 0; i < 20; ++i) publisher->publish(makeAlert(i));
+
+    std::vector<stream::AlertRecord> out;
+    EXPECT_EQ(reader->poll(out), 8u);
+    EXPECT_EQ(reader->overruns(), 12u);
+    EXPECT_EQ(out.front().alert_seq, 12u);
+    EXPECT_EQ(out.back().alert_seq, 19u);
+}
+
+TEST_F(AlertStreamTest, LongMessagesAreTruncated) {
+    auto publisher = AlertStreamPublisher::create(name, 4);
+    auto reader = AlertStreamReader::open(name);
+    ASSERT_NE(reader, nullptr);
+
+    Alert a = makeAlert(0);
+    a.message.assign(1000, 'x');
+    publisher->publish(a);
+
+    std::vector<stream::AlertRecord> out;
+    ASSERT_EQ(reader->poll(out), 1u);
+    EXPECT_EQ(out[0].message_len, sizeof(out[0].message));
+}
+
+TEST_F(AlertStreamTest, ConcurrentReaderNeverSeesTornRecords) {
+    auto publisher = AlertStreamPublisher::create(name, 64);
+    auto reader = AlertStreamReader::open(name);
+    ASSERT_NE(reader, nullptr);
+
+    constexpr uint64_t kTotal = 200000;
+    std::thread writer([&] {
+        for (uint64_t i = 0; i < kTotal; ++i) publisher->publish(makeAlert(i));
+    });
+
+    std::vector<stream::AlertRecord> out;
+    uint64_t seen = 0;
+    uint64_t last = 0;
+    bool ordered = true, intact = true;
+    while (seen + reader->overruns() < kTotal) {
+        out.clear();
+        reader->poll(out);
+        for (const auto& r : out) {
+            if (seen > 0 && r.alert_seq <= last) ordered = false;
+            std::string expected = "alert " + std::to_string(r.alert_seq);
+            if (std::string(r.message, r.message_len) != expected) intact = false;
+            last = r.alert_seq;
+            ++seen;
+        }
+    }
+    writer.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(intact);
+    EXPECT_EQ(seen + reader->overruns(), kTotal);
+}
+
+TEST_F(AlertStreamTest, AlertManagerCallbackFeedsStream) {
+    auto publisher = AlertStreamPublisher::create(name, 16);
+    auto reader = AlertStreamReader::open(name);
+    ASSERT_NE(reader, nullptr);
+
+    std::string log = "test_alert_stream_" + std::to_string(::getpid()) + ".log";
+    {
+        AlertManager manager(log);
+        manager.onAlert([&](const Alert& alert) { publisher->publish(alert); });
+
+        AnomalyReport report;
+        report.type        = AnomalyType::HIGH_LATENCY;
+        report.source_ip   = "10.0.0.9";
+        report.severity    = 0.9;
+        report.description = "slow";
+        manager.raise(report);
+        manager.raise(report);
+    }
+    std::remove(log.c_str());
+
+    std::vector<stream::AlertRecord> out;
+    ASSERT_EQ(reader->poll(out), 2u);
+    EXPECT_EQ(out[0].alert_seq, 0u);
+    EXPECT_EQ(out[1].alert_seq, 1u);
+    EXPECT_EQ(out[1].level, static_cast<uint8_t>(AlertLevel::CRITICAL));
+}
@@ -1,90 +1,8 @@
-cmake_minimum_required(VERSION 3.15)
-project(5g-anomaly-detector VERSION 1.0 LANGUAGES CXX)
-
-# Set C++ standard
-set(CMAKE_CXX_STANDARD 17)
-/**
- * @brief Enforces strict adherence to the specified C++ standard version.
- * 
- * When set to ON, this CMake property ensures that the compiler must support
- * the C++ standard version specified by CMAKE_CXX_STANDARD. If the compiler
- * does not support the required standard, the configuration will fail rather
- * than silently falling back to an older standard version.
- * 
- * @note This should be used in conjunction with CMAKE_CXX_STANDARD to guarantee
- *       that the project builds with the intended C++ standard features.
- */
-set(CMAKE_CXX_STANDARD_REQUIRED ON)
-set(CMAKE_CXX_EXTENSIONS OFF)
-
-# Add compile options
-if(MSVC)
-    add_compile_options(/W4)
-else()
-    add_compile_options(-Wall -Wextra -Wpedantic)
-endif()
-
-# Include directories
-include_directories(include)
-
-# Source files
-set(SOURCES
-    src/AnomalyDetector.cpp
-    src/PacketProcessor.cpp
-    src/NetworkMonitor.cpp
-    src/AlertManager.cpp
-)
-
-# Create library
-add_library(anomaly_lib ${SOURCES})
-target_include_directories(anomaly_lib PUBLIC include)
-
-# Main executable
-add_executable(5g-anomaly-detector src/main.cpp)
-target_link_libraries(5g-anomaly-detector anomaly_lib)
-
-# Find required threads library
-find_package(Threads REQUIRED)
-target_link_libraries(anomaly_lib Threads::Threads)
-
-# Testing
-option(BUILD_TESTS "Build tests" ON)
-
-if(BUILD_TESTS)
-    # Download and configure Google Test
-    include(FetchContent)
-    FetchContent_Declare(
-        googletest
-        GIT_REPOSITORY https://github.com/google/googletest.git
-        GIT_TAG        v1.14.0
-    )
-    # For Windows: Prevent overriding the parent project's compiler/linker settings
-    set(gtest_force_shared_crt ON CACHE BOOL "" FORCE)
-    FetchContent_MakeAvailable(googletest)
-
-    enable_testing()
-
-    # Test executable
-    add_executable(tests
-        tests/test_PacketProcessor.cpp
-        tests/test_AnomalyDetector.cpp
-        tests/test_AlertManager.cpp
-        tests/test_NetworkMonitor.cpp  # ADAUGĂ ACEASTA
-    )
-
-    target_link_libraries(tests
-        anomaly_lib
-        GTest::gtest_main
-        GTest::gmock_main
-    )
-
-    include(GoogleTest)
-    gtest_discover_tests(tests)
-endif()
-
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include "AnomalyDetector.h"
+#include <cstddef>
+#include <memory_resource>
 
 using namespace anomaly;
 
@@ -179,3 +97,126 @@ TEST_F(AnomalyDetectorTest, SeverityCalculation) {
     EXPECT_GT(result->severity, 0.0);
     EXPECT_LE(result->severity, 1.0);
 }
+
+TEST_F(AnomalyDetectorTest, FloodWindowFollowsEventTime) {
+    DetectorConfig config;
+    config.flood_threshold = 5;
+    config.window_size_sec = 10;
+    detector->updateConfig(config);
+
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    Packet p("192.168.1.10", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 10.0, t0);
+
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_FALSE(detector->analyze(p).has_value());
+    }
+
+    // Next window: counter restarts even though no wall-clock time passed
+    p.timestamp = t0 + std::chrono::seconds(10);
+    EXPECT_FALSE(detector->analyze(p).has_value());
+}
+
+TEST_F(AnomalyDetectorTest, ReportCarriesPacketEventTime) {
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    Packet p("192.168.1.1", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 250.0, t0);
+    auto result = detector->analyze(p);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->detected_at, t0);
+}
+
+TEST_F(AnomalyDetectorTest, UnstampedPacketUsesWatermark) {
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    detector->analyze(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                             Protocol::TCP, 1024, 10.0, t0));
+
+    Packet late("192.168.1.2", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 250.0);
+    auto result = detector->analyze(late);
+
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->detected_at, t0);
+    EXPECT_EQ(detector->watermark(), t0);
+}
+
+TEST_F(AnomalyDetectorTest, IdleSourcesAreReclaimed) {
+    DetectorConfig config;
+    config.source_idle_sec = 60;
+    detector->updateConfig(config);
+
+    auto t0 = fromNanos(1'700'000'000'000'000'000LL);
+    detector->analyze(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                             Protocol::TCP, 1024, 10.0, t0));
+    detector->analyze(Packet("192.168.1.2", "10.0.0.1", 5000, 80,
+                             Protocol::TCP, 1024, 10.0, t0));
+    EXPECT_EQ(detector->trackedSources(), 2u);
+
+    detector->analyze(Packet("192.168.1.3", "10.0.0.1", 5000, 80,
+                             Protocol::TCP, 1024, 10.0,
+                             t0 + std::chrono::seconds(120)));
+    EXPECT_EQ(detector->trackedSources(), 1u);
+}
+
+TEST_F(AnomalyDetectorTest, BatchAppendsToCallerBuffer) {
+    std::vector<Packet> batch = {
+        Packet("192.168.1.1", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 250.0),
+        Packet("192.168.1.2", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 10.0),
+        Packet("192.168.1.3", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 300.0),
+    };
+    std::vector<AnomalyReport> out(1);  // existing contents are kept
+
+    EXPECT_EQ(detector->analyzeBatch(batch, out), 2u);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_EQ(out[1].source_ip, "192.168.1.1");
+    EXPECT_EQ(out[2].source_ip, "192.168.1.3");
+}
+
+TEST_F(AnomalyDetectorTest, BatchReportsComeFromCallerArena) {
+    std::vector<Packet> batch = {
+        Packet("192.168.1.1", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 250.0),
+        Packet("192.168.1.2", "10.0.0.1", 5000, 9999, Protocol::UNKNOWN, 1024, 10.0),
+    };
+    // No upstream: anything not served from the buffer would throw
+    alignas(std::max_align_t) std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                              std::pmr::null_memory_resource());
+    AnomalyReport kept;
+    {
+        std::pmr::vector<AnomalyReport> out(&arena);
+        std::vector<size_t> rows;
+        EXPECT_EQ(detector->analyzeBatch(batch.data(), batch.size(), out, &rows), 2u);
+        ASSERT_EQ(out.size(), 2u);
+        EXPECT_EQ(rows, (std::vector<size_t>{0, 1}));
+        EXPECT_EQ(out[0].description.get_allocator().resource(), &arena);
+        EXPECT_EQ(out[0].description,
+                  "High latency detected: 250.000000 ms (threshold: 100.000000 ms)");
+        EXPECT_EQ(out[1].description, "Unknown protocol on port 9999");
+        kept = out[0];  // a copy owns its memory
+    }
+    arena.release();
+    EXPECT_EQ(kept.description.get_allocator().resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(kept.source_ip, "192.168.1.1");
+}
+
+TEST(AnomalyDetectorShardTest, ShardedDetectorKeepsPerSourceState) {
+    DetectorConfig config;
+    config.flood_threshold = 5;
+    config.shard_count     = 4;
+    AnomalyDetector detector(config);
+    EXPECT_EQ(detector.shardCount(), 4u);
+
+    int floods = 0;
+    for (int round = 0; round < 6; ++round) {
+        for (int host = 0; host < 32; ++host) {
+            Packet p("10.0.0." + std::to_string(host), "10.0.0.254", 5000, 80,
+                     Protocol::TCP, 512, 5.0);
+            auto r = detector.analyze(p);
+            if (r && r->type == AnomalyType::FLOOD) ++floods;
+        }
+    }
+    EXPECT_EQ(floods, 32);  // each source crosses the threshold once
+    EXPECT_EQ(detector.trackedSources(), 32u);
+
+    detector.updateConfig(DetectorConfig{});
+    EXPECT_EQ(detector.shardCount(), 4u);
+    EXPECT_EQ(detector.getConfig().shard_count, 4u);
+}
@@ -0,0 +1,30 @@
+#include <gtest/gtest.h>
+#include "Clock.h"
+
+using namespace anomaly;
+
+TEST(ClockTest, VirtualClockAdvances) {
+    VirtualClock clock(fromNanos(1000));
+    clock.advance(std::chrono::nanoseconds(500));
+    EXPECT_EQ(toNanos(clock.now()), 1500);
+
+    clock.set(fromNanos(42));
+    EXPECT_EQ(toNanos(clock.now()), 42);
+}
+
+TEST(ClockTest, EventClockNeverMovesBackwards) {
+    EventClock clock;
+    EXPECT_FALSE(hasTimestamp(clock.now()));
+
+    clock.observe(fromNanos(2000));
+    clock.observe(fromNanos(1000));
+    EXPECT_EQ(toNanos(clock.now()), 2000);
+}
+
+TEST(ClockTest, MonotonicClockIsNonDecreasing) {
+    MonotonicClock clock;
+    auto a = clock.now();
+    auto b = clock.now();
+    EXPECT_TRUE(hasTimestamp(a));
+    EXPECT_LE(a, b);
+}
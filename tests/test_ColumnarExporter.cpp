@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include "ColumnarExporter.h"
+#include "TestPaths.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace anomaly;
+
+class ColumnarExporterTest : public ::testing::Test {
+protected:
+    std::unique_ptr<AlertManager> manager;
+    const std::string path = testPath("test_alerts.col");
+    const std::string log_path = testPath("test_columnar.log");
+
+    void SetUp() override {
+        AlertManagerConfig config;
+        config.log.console = false;
+        manager = std::make_unique<AlertManager>(log_path, config);
+    }
+
+    void TearDown() override {
+        manager.reset();
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(path);
+    }
+
+    void raise(const std::string& ip, const std::string& msg, double severity) {
+        AnomalyReport r;
+        r.type        = AnomalyType::FLOOD;
+        r.severity    = severity;
+        r.source_ip   = ip;
+        r.description = msg;
+        r.detected_at = fromNanos(1'700'000'000'000'000'000LL);
+        manager->raise(r);
+    }
+
+    std::string contents() const {
+        std::ifstream in(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(in), {});
+    }
+};
+
+TEST_F(ColumnarExporterTest, WritesAlignedBlocks) {
+    {
+        ColumnarExportConfig config;
+        config.rows_per_block = 2;
+        ColumnarExporter exporter(path, config);
+        raise("10.0.0.1", "flood", 0.9);
+        raise("10.0.0.2", "flood", 0.5);
+        raise("10.0.0.3", "other", 0.1);
+        EXPECT_EQ(exporter.exportNew(*manager), 3u);
+    }
+
+    std::string data = contents();
+    ASSERT_GE(data.size(), sizeof(columnar::FileHeader));
+    EXPECT_EQ(data.compare(0, 4, "5GAC"), 0);
+    EXPECT_EQ(data.size() % 8, 0u);
+
+    // First block: 2 rows, one shared dictionary entry
+    columnar::BlockHeader block;
+    std::memcpy(&block, data.data() + 16, sizeof(block));
+    EXPECT_EQ(std::string(block.magic, 4), "BLK1");
+    EXPECT_EQ(block.rows, 2u);
+    EXPECT_EQ(block.dict_entries, 1u);
+    EXPECT_EQ(block.first_seq, 0u);
+
+    const char* cols = data.data() + 16 + sizeof(block);
+    int64_t ts;
+    double severity;
+    uint32_t addr;
+    std::memcpy(&ts, cols, 8);
+    std::memcpy(&severity, cols + 16, 8);
+    std::memcpy(&addr, cols + 32 + 4, 4);
+    EXPECT_EQ(ts, 1'700'000'000'000'000'000LL);
+    EXPECT_DOUBLE_EQ(severity, 0.9);
+    EXPECT_EQ(addr, 0x0A000002u);
+}
+
+TEST_F(ColumnarExporterTest, AppendsWithoutSecondHeader) {
+    raise("10.0.0.1", "flood", 0.9);
+    { ColumnarExporter(path).exportNew(*manager); }
+    size_t first = contents().size();
+
+    raise("10.0.0.1", "flood", 0.9);
+    { ColumnarExporter(path).exportNew(*manager); }
+    std::string data = contents();
+
+    EXPECT_EQ(data.compare(first, 4, "BLK1"), 0);
+}
+
+TEST_F(ColumnarExporterTest, LeavesOtherFilesUntouched) {
+    raise("10.0.0.1", "flood", 0.9);
+    auto expectUntouched = [&](const std::string& original) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << original;
+        }
+        {
+            ColumnarExporter exporter(path);
+            EXPECT_FALSE(exporter.isOpen());
+            EXPECT_EQ(exporter.exportNew(*manager), 0u);
+        }
+        EXPECT_EQ(contents(), original);
+    };
+
+    // Not a columnar file at all
+    expectUntouched("not a columnar file at all");
+
+    // A newer version
+    columnar::FileHeader header{};
+    std::memcpy(header.magic, columnar::kFileMagic, 4);
+    header.version = columnar::kVersion + 1;
+    expectUntouched(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+
+    // Valid blocks around a corrupt block header
+    { ColumnarExporter(path).exportNew(*manager); }
+    std::string valid = contents();
+    std::filesystem::remove(path);
+    std::string corrupt = valid + valid.substr(16);
+    corrupt.replace(16, 4, "XXXX");
+    expectUntouched(corrupt);
+}
+
+TEST_F(ColumnarExporterTest, TrimsPartialLastBlock) {
+    raise("10.0.0.1", "flood", 0.9);
+    { ColumnarExporter(path).exportNew(*manager); }
+    size_t complete = contents().size();
+
+    // A crash mid-block leaves a tail that the next exporter cuts off
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::app);
+        out << "BLK1" << std::string(30, 'x');
+    }
+    raise("10.0.0.2", "flood", 0.5);
+    {
+        ColumnarExporter exporter(path);
+        ASSERT_TRUE(exporter.isOpen());
+        exporter.exportNew(*manager);
+    }
+    std::string data = contents();
+    EXPECT_EQ(data.compare(complete, 4, "BLK1"), 0);
+    columnar::BlockHeader block;
+    std::memcpy(&block, data.data() + complete, sizeof(block));
+    EXPECT_EQ(block.rows, 2u);  // a new exporter starts from the first alert
+    EXPECT_EQ(data.size() % 8, 0u);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include "FileIngest.h"
+#include "NetworkMonitor.h"
+#include "TraceFile.h"
+#include "TestPaths.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+using namespace anomaly;
+
+class FileIngestTest : public ::testing::TestWithParam<bool> {
+protected:
+    const std::string dir = testPath("test_file_ingest");
+    const std::string log = testPath("test_file_ingest.log");
+    std::shared_ptr<AnomalyDetector> detector;
+    std::shared_ptr<AlertManager> alerts;
+
+    void SetUp() override {
+        std::filesystem::create_directory(dir);
+        detector = std::make_shared<AnomalyDetector>();
+        AlertManagerConfig alert_config;
+        alert_config.log.console = false;
+        alerts = std::make_shared<AlertManager>(log, alert_config);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+        std::filesystem::remove(log);
+    }
+
+    static Packet makePacket(int i) {
+        return Packet("10.0.0." + std::to_string(i % 250 + 1), "192.168.1.1",
+                      static_cast<uint16_t>(10000 + i), 443, Protocol::TCP,
+                      100u + i, 0.5 * i,
+                      fromNanos(1'700'000'000'000'000'000LL + i * 1'000'000LL));
+    }
+
+    // 0-999 as a binary trace, 1000-1999 as text with noise, an empty file
+    void writeCaptures() {
+        {
+            TraceWriter writer(dir + "/000.bin");
+            for (int i = 0; i < 1000; ++i) writer.write(makePacket(i));
+        }
+        PacketProcessor processor;
+        std::ofstream text(dir + "/001.txt");
+        text << "# capture\n\n";
+        for (int i = 1000; i < 2000; ++i) {
+            if (i == 1500) text << "not a record\n";
+            text << processor.formatPacket(makePacket(i));
+            if (i < 1999) text << "\n";  // last line unterminated
+        }
+        text.close();
+        std::ofstream(dir + "/002.empty").close();
+    }
+
+    FileIngestConfig smallBlocks() const {
+        FileIngestConfig config;
+        config.block_size   = 4096;  // records straddle blocks
+        config.queue_depth  = 3;
+        config.use_io_uring = GetParam();
+        return config;
+    }
+};
+
+TEST_P(FileIngestTest, ReadsEveryFileInOrder) {
+    writeCaptures();
+    auto paths = FileIngest::listDirectory(dir);
+    ASSERT_EQ(paths.size(), 3u);
+    EXPECT_EQ(std::filesystem::path(paths[0]).filename(), "000.bin");
+
+    NetworkMonitor monitor(detector, alerts);
+    std::mutex mtx;
+    std::vector<Packet> seen;
+    monitor.onBatch([&](const std::vector<Packet>& batch) {
+        std::lock_guard<std::mutex> lock(mtx);
+        seen.insert(seen.end(), batch.begin(), batch.end());
+    });
+    FileIngest ingest(smallBlocks());
+    if (!GetParam()) {
+        EXPECT_STREQ(ingest.backend(), "pread");
+    }
+    monitor.start();
+    FileIngestStats stats = ingest.run(paths, monitor);
+    monitor.stop();
+
+    EXPECT_EQ(stats.files, 3u);
+    EXPECT_EQ(stats.failed_files, 0u);
+    EXPECT_EQ(stats.packets, 2000u);
+    EXPECT_EQ(stats.accepted, 2000u);
+    EXPECT_EQ(stats.skipped, 1u);
+    uint64_t total = 0;
+    for (const auto& p : paths) total += std::filesystem::file_size(p);
+    EXPECT_EQ(stats.bytes, total);
+
+    ASSERT_EQ(seen.size(), 2000u);
+    for (int i = 0; i < 2000; ++i) {
+        Packet expected = makePacket(i);
+        ASSERT_EQ(seen[i].src_port, expected.src_port) << i;
+        ASSERT_EQ(seen[i].src_ip, expected.src_ip) << i;
+        ASSERT_EQ(seen[i].timestamp, expected.timestamp) << i;
+        ASSERT_DOUBLE_EQ(seen[i].latency_ms, expected.latency_ms) << i;
+    }
+}
+
+TEST_P(FileIngestTest, MissingAndCorruptFilesAreCounted) {
+    writeCaptures();
+    // A binary header with the wrong record size
+    std::ofstream bad(dir + "/bad.bin", std::ios::binary);
+    trace::FileHeader header{};
+    std::memcpy(header.magic, trace::kMagic, sizeof(header.magic));
+    header.version     = trace::kVersion;
+    header.record_size = 12;
+    bad.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bad.close();
+
+    NetworkMonitor monitor(detector, alerts);
+    FileIngest ingest(smallBlocks());
+    monitor.start();
+    FileIngestStats stats = ingest.run({dir + "/missing.bin", dir + "/bad.bin",
+                                        dir + "/000.bin"}, monitor);
+    monitor.stop();
+
+    EXPECT_EQ(stats.failed_files, 2u);
+    EXPECT_EQ(stats.files, 1u);
+    EXPECT_EQ(stats.packets, 1000u);
+    EXPECT_EQ(monitor.stats().processed, 1000u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, FileIngestTest, ::testing::Values(true, false),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                             return info.param ? "IoUring" : "Pread";
+                         });
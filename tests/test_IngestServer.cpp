@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include "IngestServer.h"
+#include "TestPaths.h"
+#include "NetworkMonitor.h"
+#include <arpa/inet.h>
+#include <cstring>
+#include <filesystem>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace anomaly;
+
+class IngestServerTest : public ::testing::Test {
+protected:
+    std::shared_ptr<AnomalyDetector> detector;
+    std::shared_ptr<AlertManager> alerts;
+    std::unique_ptr<NetworkMonitor> monitor;
+    const std::string socket_path = testPath("test_ingest.sock");
+    const std::string log_path = testPath("test_ingest.log");
+
+    void SetUp() override {
+        DetectorConfig config;
+        config.max_latency_ms = 100.0;
+        detector = std::make_shared<AnomalyDetector>(config);
+        AlertManagerConfig alert_config;
+        alert_config.log.console = false;
+        alerts  = std::make_shared<AlertManager>(log_path, alert_config);
+        monitor = std::make_unique<NetworkMonitor>(detector, alerts);
+        monitor->start();
+    }
+
+    void TearDown() override {
+        monitor->stop();
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(socket_path);
+    }
+
+    // Wait (bounded) for the server to have seen `expected` datagrams
+    static bool waitForDatagrams(const IngestServer& server, uint64_t expected) {
+        for (int i = 0; i < 500 && server.stats().datagrams < expected; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return server.stats().datagrams >= expected;
+    }
+
+    static void sendTo(int fd, const sockaddr* addr, socklen_t len, const std::string& data) {
+        ASSERT_EQ(::sendto(fd, data.data(), data.size(), 0, addr, len),
+                  static_cast<ssize_t>(data.size()));
+    }
+};
+
+TEST_F(IngestServerTest, UdpRecordsReachTheMonitor) {
+    auto server = IngestServer::create(*monitor);
+    ASSERT_NE(server, nullptr);
+    ASSERT_NE(server->port(), 0);
+    server->start();
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(server->port());
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    int fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    ASSERT_GE(fd, 0);
+    const auto* sa = reinterpret_cast<const sockaddr*>(&addr);
+
+    // Two records in one datagram, one in another
+    sendTo(fd, sa, sizeof(addr), "192.168.1.1:5000->10.0.0.1:80|1024|250.0\n"
+                                 "192.168.1.2:5000->10.0.0.1:80|1024|5.0\n");
+    sendTo(fd, sa, sizeof(addr), "192.168.1.3:5000->10.0.0.1:443|512|300.0");
+    ::close(fd);
+    ASSERT_TRUE(waitForDatagrams(*server, 2));
+    server->stop();
+    monitor->stop();
+
+    IngestStats s = server->stats();
+    EXPECT_EQ(s.records, 3u);
+    EXPECT_EQ(s.parse_errors, 0u);
+    EXPECT_EQ(s.rejected, 0u);
+    EXPECT_EQ(monitor->stats().processed, 3u);
+    EXPECT_EQ(alerts->count(), 2u);  // the two high-latency records
+}
+
+TEST_F(IngestServerTest, UnixSocketCountsParseErrors) {
+    IngestConfig config;
+    config.unix_path = socket_path;
+    auto server = IngestServer::create(*monitor, config);
+    ASSERT_NE(server, nullptr);
+    EXPECT_EQ(server->port(), 0);
+    server->start();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    ASSERT_GE(fd, 0);
+    const auto* sa = reinterpret_cast<const sockaddr*>(&addr);
+
+    sendTo(fd, sa, sizeof(addr), "garbage\n192.168.1.1:5000->10.0.0.1:80|1024|5.0\n");
+    sendTo(fd, sa, sizeof(addr), "192.168.1.1:5000->10.0.0.1:80|abc|5.0");
+    sendTo(fd, sa, sizeof(addr), "garbage:1->foo:80|64|1.0");
+    ::close(fd);
+    ASSERT_TRUE(waitForDatagrams(*server, 3));
+    server->stop();
+
+    IngestStats s = server->stats();
+    EXPECT_EQ(s.records, 1u);
+    EXPECT_EQ(s.parse_errors, 3u);
+    EXPECT_EQ(s.socket_drops, 0u);
+}
+
+TEST_F(IngestServerTest, OversizedDatagramIsRejected) {
+    IngestConfig config;
+    config.unix_path    = socket_path;
+    config.max_datagram = 64;
+    auto server = IngestServer::create(*monitor, config);
+    ASSERT_NE(server, nullptr);
+    server->start();
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strcpy(addr.sun_path, socket_path.c_str());
+    int fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    std::string big;
+    for (int i = 0; i < 4; ++i) big += "192.168.1.1:5000->10.0.0.1:80|1024|5.0\n";
+    sendTo(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr), big);
+    ::close(fd);
+    ASSERT_TRUE(waitForDatagrams(*server, 1));
+    server->stop();
+
+    EXPECT_EQ(server->stats().records, 0u);
+    EXPECT_EQ(server->stats().parse_errors, 1u);
+}
+
+TEST_F(IngestServerTest, BadAddressFailsToCreate) {
+    IngestConfig config;
+    config.udp_address = "not-an-address";
+    EXPECT_EQ(IngestServer::create(*monitor, config), nullptr);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "Metrics.h"
+#include "PacketProcessor.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace anomaly;
+using namespace anomaly::metrics;
+
+class MetricsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (!kEnabled) {
+            GTEST_SKIP() << "built with ENABLE_METRICS=OFF";
+        }
+    }
+};
+
+TEST_F(MetricsTest, BucketsAreMonotonicAndBounded) {
+    size_t prev = 0;
+    for (uint64_t v = 0; v < 100000; ++v) {
+        size_t b = Histogram::bucketOf(v);
+        ASSERT_GE(b, prev);
+        ASSERT_LE(v, Histogram::bucketUpper(b));
+        if (b > 0) {
+            ASSERT_GT(v, Histogram::bucketUpper(b - 1));
+        }
+        prev = b;
+    }
+    // Relative error stays within one sub-bucket
+    for (uint64_t v : {1000ull, 123456789ull, 1ull << 40}) {
+        double upper = static_cast<double>(Histogram::bucketUpper(Histogram::bucketOf(v)));
+        EXPECT_LE(upper / static_cast<double>(v), 1.0 + 1.0 / Histogram::kSub);
+    }
+    EXPECT_EQ(Histogram::bucketOf(~0ull), Histogram::kBuckets - 1);
+}
+
+TEST_F(MetricsTest, CounterSumsAcrossThreads) {
+    Counter c;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&c] {
+            for (int i = 0; i < 10000; ++i) c.inc();
+        });
+    }
+    for (auto& t : threads) t.join();
+    EXPECT_EQ(c.value(), 80000u);
+
+    Gauge g;
+    g.add(5);
+    g.add(-2);
+    EXPECT_EQ(g.value(), 3);
+    g.set(10);
+    EXPECT_EQ(g.value(), 10);
+}
+
+TEST_F(MetricsTest, HistogramQuantiles) {
+    Histogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) h.observe(v);
+    h.observe(5000, 10);
+    auto snap = h.snapshot();
+    EXPECT_EQ(snap.count, 1010u);
+    EXPECT_EQ(snap.sum, 500500u + 50000u);
+    EXPECT_NEAR(static_cast<double>(snap.quantile(0.5)), 505.0, 505.0 / 16);
+    EXPECT_NEAR(static_cast<double>(snap.quantile(0.995)), 5000.0, 5000.0 / 16);
+}
+
+TEST_F(MetricsTest, PrometheusExposition) {
+    Registry registry;
+    registry.counter("test_events_total{kind=\"a\"}", "Events").inc(3);
+    registry.counter("test_events_total{kind=\"b\"}", "Events").inc(4);
+    EXPECT_EQ(registry.counter("test_events_total{kind=\"a\"}", "Events").value(), 3u);
+    registry.gauge("test_depth", "Depth").set(7);
+    auto& h = registry.histogram("test_latency_seconds", "Latency", 1e-9);
+    h.observe(2);
+    h.observe(6);
+
+    std::string text = registry.prometheusText();
+    EXPECT_NE(text.find("# TYPE test_events_total counter\n"
+                        "test_events_total{kind=\"a\"} 3\n"
+                        "test_events_total{kind=\"b\"} 4\n"), std::string::npos);
+    EXPECT_NE(text.find("test_depth 7\n"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE test_latency_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"3e-09\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"7e-09\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_bucket{le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_sum 8e-09\n"), std::string::npos);
+    EXPECT_NE(text.find("test_latency_seconds_count 2\n"), std::string::npos);
+
+    ASSERT_TRUE(registry.writePrometheusFile("test_metrics.prom"));
+    std::ifstream in("test_metrics.prom");
+    std::stringstream ss;
+    ss << in.rdbuf();
+    EXPECT_EQ(ss.str(), text);
+    std::filesystem::remove("test_metrics.prom");
+}
+
+TEST_F(MetricsTest, ComponentsReportToGlobalRegistry) {
+    auto& parsed = Registry::global().counter("anomaly_packets_parsed_total", "");
+    uint64_t before = parsed.value();
+    PacketProcessor processor;
+    processor.parsePacket("10.0.0.1:1->10.0.0.2:80|64|1.0");
+    processor.parsePacket("garbage");
+    EXPECT_EQ(parsed.value(), before + 2);
+    EXPECT_NE(Registry::global().prometheusText().find("# TYPE anomaly_parse_seconds histogram"),
+              std::string::npos);
+}
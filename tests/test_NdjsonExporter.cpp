@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include "NdjsonExporter.h"
+#include "TestPaths.h"
+#include "JsonUtil.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace anomaly;
+
+class NdjsonExporterTest : public ::testing::Test {
+protected:
+    std::unique_ptr<AlertManager> manager;
+    const std::string path = testPath("test_alerts.ndjson");
+    const std::string log_path = testPath("test_ndjson.log");
+
+    void SetUp() override {
+        AlertManagerConfig config;
+        config.log.console = false;
+        manager = std::make_unique<AlertManager>(log_path, config);
+    }
+
+    void TearDown() override {
+        manager.reset();
+        std::filesystem::remove(log_path);
+        for (const char* suffix : {"", ".1", ".2", ".3"}) {
+            std::filesystem::remove(path + suffix);
+        }
+    }
+
+    void raise(const std::string& description, double severity = 0.5) {
+        AnomalyReport r;
+        r.type        = AnomalyType::HIGH_LATENCY;
+        r.severity    = severity;
+        r.source_ip   = "192.168.1.1";
+        r.description = description;
+        manager->raise(r);
+    }
+
+    std::vector<std::string> lines(const std::string& file) const {
+        std::ifstream in(file);
+        std::vector<std::string> out;
+        for (std::string line; std::getline(in, line);) out.push_back(line);
+        return out;
+    }
+};
+
+TEST_F(NdjsonExporterTest, ExportsOnlyNewAlerts) {
+    NdjsonExporter exporter(path);
+    raise("first");
+    raise("second");
+    EXPECT_EQ(exporter.exportNew(*manager), 2u);
+
+    raise("third");
+    EXPECT_EQ(exporter.exportNew(*manager), 1u);
+    EXPECT_EQ(exporter.exportNew(*manager), 0u);
+
+    auto out = lines(path);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_NE(out[2].find("\"message\":\"third\""), std::string::npos);
+}
+
+TEST_F(NdjsonExporterTest, EscapesMessage) {
+    NdjsonExporter exporter(path);
+    raise("quote \" backslash \\ newline \n tab \t");
+    exporter.exportNew(*manager);
+
+    auto out = lines(path);
+    ASSERT_EQ(out.size(), 1u);
+    EXPECT_NE(out[0].find(R"(quote \" backslash \\ newline \n tab \t)"),
+              std::string::npos);
+}
+
+TEST_F(NdjsonExporterTest, RotatesBySize) {
+    NdjsonExportConfig config;
+    config.max_bytes = 512;
+    config.max_files = 2;
+    NdjsonExporter exporter(path, config);
+
+    for (int i = 0; i < 20; ++i) raise("alert " + std::to_string(i));
+    exporter.exportNew(*manager);
+
+    EXPECT_GT(exporter.stats().rotations, 0u);
+    EXPECT_TRUE(std::filesystem::exists(path + ".1"));
+    EXPECT_FALSE(std::filesystem::exists(path + ".3"));
+    EXPECT_LE(std::filesystem::file_size(path + ".1"), 512u + 256u);
+}
+
+TEST(JsonUtilTest, NumbersRoundTrip) {
+    std::string out;
+    appendJsonNumber(out, 0.1);
+    EXPECT_EQ(out, "0.1");
+
+    out.clear();
+    appendJsonNumber(out, 1.0 / 0.0);
+    EXPECT_EQ(out, "null");
+
+    out.clear();
+    appendJsonString(out, std::string("\x01", 1));
+    EXPECT_EQ(out, "\"\\u0001\"");
+}
@@ -0,0 +1,350 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include "NetworkMonitor.h"
+#include <filesystem>
+#include <thread>
+
+using namespace anomaly;
+
+class NetworkMonitorTest : public ::testing::Test {
+protected:
+    std::shared_ptr<AnomalyDetector> detector;
+    std::shared_ptr<AlertManager> alerts;
+
+    void SetUp() override {
+        DetectorConfig config;
+        config.max_latency_ms  = 100.0;
+        config.flood_threshold = 50;
+        detector = std::make_shared<AnomalyDetector>(config);
+        alerts   = std::make_shared<AlertManager>("test_monitor.log");
+    }
+
+    void TearDown() override {
+        std::filesystem::remove("test_monitor.log");
+    }
+
+    // Wait (bounded) for the monitor thread to raise `expected` alerts
+    bool waitForAlerts(size_t expected) {
+        for (int i = 0; i < 500 && alerts->count() < expected; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        return alerts->count() >= expected;
+    }
+};
+
+TEST_F(NetworkMonitorTest, StartAndStop) {
+    NetworkMonitor monitor(detector, alerts);
+    EXPECT_FALSE(monitor.isRunning());
+    monitor.start();
+    EXPECT_TRUE(monitor.isRunning());
+    monitor.stop();
+    EXPECT_FALSE(monitor.isRunning());
+}
+
+TEST_F(NetworkMonitorTest, AnomalousPacketRaisesAlert) {
+    NetworkMonitor monitor(detector, alerts);
+    monitor.start();
+    monitor.feedPacket(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                              Protocol::TCP, 1024, 250.0));
+    EXPECT_TRUE(waitForAlerts(1));
+    monitor.stop();
+}
+
+TEST_F(NetworkMonitorTest, UnstampedPacketGetsClockTime) {
+    auto clock = std::make_shared<VirtualClock>(fromNanos(1'700'000'000'000'000'000LL));
+    NetworkMonitor monitor(detector, alerts, clock);
+    monitor.start();
+    monitor.feedPacket(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                              Protocol::TCP, 1024, 250.0));
+    ASSERT_TRUE(waitForAlerts(1));
+    monitor.stop();
+
+    EXPECT_EQ(detector->watermark(), clock->now());
+}
+
+TEST_F(NetworkMonitorTest, StampedPacketKeepsEventTime) {
+    auto clock = std::make_shared<VirtualClock>(fromNanos(1'700'000'000'000'000'000LL));
+    auto event_time = clock->now() - std::chrono::hours(24);
+
+    NetworkMonitor monitor(detector, alerts, clock);
+    monitor.start();
+    monitor.feedPacket(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                              Protocol::TCP, 1024, 250.0, event_time));
+    ASSERT_TRUE(waitForAlerts(1));
+    monitor.stop();
+
+    EXPECT_EQ(detector->watermark(), event_time);
+}
+
+static Packet slowPacket(int host) {
+    return Packet("192.168.1." + std::to_string(host), "10.0.0.1", 5000, 80,
+                  Protocol::TCP, 1024, 250.0);
+}
+
+TEST_F(NetworkMonitorTest, DropNewestRejectsWhenFull) {
+    MonitorConfig config;
+    config.queue_capacity = 4;
+    config.overflow       = QueueOverflowPolicy::DROP_NEWEST;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    int accepted = 0;
+    for (int i = 0; i < 10; ++i) accepted += monitor.feedPacket(slowPacket(i));
+    EXPECT_EQ(accepted, 4);
+
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.enqueued, 4u);
+    EXPECT_EQ(stats.dropped, 6u);
+    EXPECT_EQ(stats.queue_depth, 4u);
+}
+
+TEST_F(NetworkMonitorTest, DropOldestKeepsNewestPackets) {
+    MonitorConfig config;
+    config.queue_capacity = 4;
+    config.overflow       = QueueOverflowPolicy::DROP_OLDEST;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    for (int i = 0; i < 10; ++i) EXPECT_TRUE(monitor.feedPacket(slowPacket(i)));
+    EXPECT_EQ(monitor.stats().dropped, 6u);
+
+    monitor.start();
+    ASSERT_TRUE(waitForAlerts(4));
+    monitor.stop();
+
+    auto held = alerts->getAlerts();
+    ASSERT_EQ(held.size(), 4u);
+    EXPECT_EQ(held.front()->report.source_ip, "192.168.1.6");
+    EXPECT_EQ(held.back()->report.source_ip, "192.168.1.9");
+}
+
+TEST_F(NetworkMonitorTest, SampleAdmitsOneInNWhenFull) {
+    MonitorConfig config;
+    config.queue_capacity = 4;
+    config.overflow       = QueueOverflowPolicy::SAMPLE;
+    config.sample_every   = 3;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    int accepted = 0;
+    for (int i = 0; i < 13; ++i) accepted += monitor.feedPacket(slowPacket(i));
+
+    // 4 fit; of the 9 overflowing arrivals, #0, #3 and #6 replace the oldest
+    EXPECT_EQ(accepted, 7);
+    EXPECT_EQ(monitor.stats().dropped, 9u);
+    EXPECT_EQ(monitor.stats().queue_depth, 4u);
+}
+
+TEST_F(NetworkMonitorTest, BlockingProducersLoseNothing) {
+    MonitorConfig config;
+    config.queue_capacity = 2;
+    config.overflow       = QueueOverflowPolicy::BLOCK;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+    monitor.start();
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; ++t) {
+        producers.emplace_back([&monitor, t] {
+            for (int i = 0; i < 500; ++i) {
+                monitor.feedPacket(Packet("10.1." + std::to_string(t) + "." +
+                                              std::to_string(i % 200),
+                                          "10.0.0.1", 5000, 80, Protocol::TCP,
+                                          512, 5.0));
+            }
+        });
+    }
+    for (auto& p : producers) p.join();
+    monitor.stop();
+
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.enqueued, 2000u);
+    EXPECT_EQ(stats.processed, 2000u);
+    EXPECT_EQ(stats.dropped, 0u);
+}
+
+TEST_F(NetworkMonitorTest, DrainsQueueInBatches) {
+    MonitorConfig config;
+    config.batch_size = 32;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    for (int i = 0; i < 100; ++i) monitor.feedPacket(slowPacket(i));
+    monitor.start();
+    ASSERT_TRUE(waitForAlerts(100));
+    monitor.stop();
+
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.processed, 100u);
+    EXPECT_EQ(stats.batches, 4u);  // 32 + 32 + 32 + 4
+}
+
+TEST_F(NetworkMonitorTest, BatchDelayWaitsForStragglers) {
+    // The delay is far longer than the feed takes, so the batch only ends
+    // by filling up; nothing here depends on how fast the machine is
+    MonitorConfig config;
+    config.batch_size         = 8;
+    config.max_batch_delay_us = 60'000'000;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+    monitor.start();
+
+    for (int i = 0; i < 8; ++i) {
+        monitor.feedPacket(slowPacket(i));
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(waitForAlerts(8));
+    EXPECT_EQ(monitor.stats().batches, 1u);
+
+    // A partial batch still goes out once the wait ends; stop() ends it early
+    monitor.feedPacket(slowPacket(8));
+    auto start = std::chrono::steady_clock::now();
+    monitor.stop();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(30));
+    EXPECT_EQ(alerts->count(), 9u);
+    EXPECT_EQ(monitor.stats().batches, 2u);
+}
+
+TEST_F(NetworkMonitorTest, WorkersPreservePerSourceOrder) {
+    DetectorConfig detector_config;
+    detector_config.shard_count = 4;
+    detector = std::make_shared<AnomalyDetector>(detector_config);
+
+    MonitorConfig config;
+    config.workers    = 4;
+    config.batch_size = 8;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+    monitor.start();
+
+    // Latency grows per source, so in-order handling means rising severity
+    for (int round = 0; round < 20; ++round) {
+        for (int host = 0; host < 16; ++host) {
+            monitor.feedPacket(Packet("192.168.2." + std::to_string(host),
+                                      "10.0.0.1", 5000, 80, Protocol::TCP,
+                                      512, 200.0 + round * 10.0));
+        }
+    }
+    monitor.stop();
+
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.workers, 4u);
+    EXPECT_EQ(stats.processed, 320u);
+    for (int host = 0; host < 16; ++host) {
+        auto held = alerts->getAlertsBySource("192.168.2." + std::to_string(host));
+        ASSERT_EQ(held.size(), 20u);
+        for (size_t i = 1; i < held.size(); ++i) {
+            EXPECT_GT(held[i]->report.severity, held[i - 1]->report.severity);
+        }
+    }
+}
+
+TEST_F(NetworkMonitorTest, IdleWorkersStealFromBackedUpQueue) {
+    MonitorConfig config;
+    config.workers       = 4;
+    config.batch_size    = 4;
+    config.work_stealing = true;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    // Hold up whichever worker raises first so the others get to steal
+    std::atomic<bool> first{true};
+    alerts->onAlert([&first](const Alert&) {
+        if (first.exchange(false)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    });
+
+    // A single source: every packet lands on the same worker's queue
+    for (int i = 0; i < 400; ++i) monitor.feedPacket(slowPacket(1));
+    monitor.start();
+    monitor.stop();
+
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.processed, 400u);
+    EXPECT_GT(stats.stolen, 0u);
+    EXPECT_EQ(alerts->count(), 400u);
+}
+
+TEST_F(NetworkMonitorTest, PinnedWorkersReportPlacement) {
+    DetectorConfig detector_config;
+    detector_config.shard_count = 4;
+    detector = std::make_shared<AnomalyDetector>(detector_config);
+    // Shards are rebuilt from the pinned workers; state already held survives
+    detector->analyze(Packet("192.168.1.1", "10.0.0.1", 5000, 80, Protocol::TCP, 1024, 1.0));
+    ASSERT_EQ(detector->trackedSources(), 1u);
+
+    MonitorConfig config;
+    config.workers             = 2;
+    config.worker_cpus         = {0};
+    config.numa_rebuild_shards = true;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+    EXPECT_EQ(detector->trackedSources(), 1u);
+    monitor.start();
+    monitor.feedPacket(slowPacket(2));
+    EXPECT_TRUE(waitForAlerts(1));
+    monitor.stop();
+
+    monitor.notePlacement("udp ingest", 0, true);
+    monitor.notePlacement("udp ingest", 0, false);
+    std::string report = monitor.placementReport();
+    EXPECT_NE(report.find("worker 0: cpu 0"), std::string::npos);
+    EXPECT_NE(report.find("worker 1: cpu 0"), std::string::npos);
+    EXPECT_NE(report.find("udp ingest: cpu 0 node"), std::string::npos);
+    EXPECT_NE(report.find("(pinning failed)"), std::string::npos);
+    EXPECT_EQ(report.find("udp ingest"), report.rfind("udp ingest"));
+}
+
+static std::vector<Packet> slowBatch(int count, int first_host = 0) {
+    std::vector<Packet> batch;
+    for (int i = 0; i < count; ++i) batch.push_back(slowPacket(first_host + i));
+    return batch;
+}
+
+TEST_F(NetworkMonitorTest, BatchDelayFlushesPartialBatchAtDeadline) {
+    MonitorConfig config;
+    config.batch_size         = 8;
+    config.max_batch_delay_us = 1000;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+    monitor.start();
+
+    auto batch = slowBatch(3);
+    EXPECT_EQ(monitor.feedBatch(std::move(batch)), 3u);
+    EXPECT_TRUE(waitForAlerts(3));  // well before stop()
+    monitor.stop();
+    EXPECT_EQ(monitor.stats().processed, 3u);
+}
+
+TEST_F(NetworkMonitorTest, FeedBatchAppliesOverflowPolicy) {
+    MonitorConfig config;
+    config.queue_capacity = 8;
+    config.overflow       = QueueOverflowPolicy::DROP_NEWEST;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    EXPECT_EQ(monitor.feedBatch(slowBatch(20)), 8u);
+    auto stats = monitor.stats();
+    EXPECT_EQ(stats.enqueued, 8u);
+    EXPECT_EQ(stats.dropped, 12u);
+}
+
+TEST_F(NetworkMonitorTest, TryFeedBatchReturnsRejectedPackets) {
+    MonitorConfig config;
+    config.queue_capacity = 8;
+    NetworkMonitor monitor(detector, alerts, nullptr, config);
+
+    auto batch = slowBatch(12);
+    EXPECT_EQ(monitor.tryFeedBatch(batch), 8u);
+    ASSERT_EQ(batch.size(), 4u);
+    EXPECT_EQ(batch.front().src_ip, "192.168.1.8");
+    EXPECT_EQ(batch.back().src_ip, "192.168.1.11");
+    EXPECT_EQ(monitor.stats().dropped, 0u);
+}
+
+TEST_F(NetworkMonitorTest, FeedBatchReachesEveryWorker) {
+    auto clock = std::make_shared<VirtualClock>(fromNanos(1'700'000'000'000'000'000LL));
+    MonitorConfig config;
+    config.workers = 3;
+    NetworkMonitor monitor(detector, alerts, clock, config);
+    monitor.start();
+    EXPECT_EQ(monitor.feedBatch(slowBatch(60)), 60u);
+
+    Packet single = slowPacket(200);
+    EXPECT_TRUE(monitor.feedPacket(std::move(single)));
+    monitor.stop();
+
+    EXPECT_EQ(monitor.stats().processed, 61u);
+    EXPECT_EQ(alerts->count(), 61u);
+    EXPECT_EQ(detector->watermark(), clock->now());
+}
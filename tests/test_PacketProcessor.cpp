@@ -21,6 +21,25 @@ TEST_F(PacketProcessorTest, ParseValidPacket) {
     EXPECT_DOUBLE_EQ(packet.latency_ms, 12.5);
 }
 
+TEST_F(PacketProcessorTest, ParseOptionalTimestamp) {
+    auto packet = processor.parsePacket(
+        "192.168.1.1:5000->10.0.0.1:80|1024|12.5|1700000000123456789");
+    EXPECT_DOUBLE_EQ(packet.latency_ms, 12.5);
+    EXPECT_EQ(toNanos(packet.timestamp), 1700000000123456789LL);
+    EXPECT_FALSE(hasTimestamp(processor.parsePacket(
+        "192.168.1.1:5000->10.0.0.1:80|1024|12.5").timestamp));
+}
+
+TEST_F(PacketProcessorTest, FormatRoundTrips) {
+    Packet p("192.168.1.1", "10.0.0.1", 5000, 443, Protocol::TCP, 1024, 12.345,
+             fromNanos(1'700'000'000'000'000'001LL));
+    auto back = processor.parsePacket(processor.formatPacket(p));
+    EXPECT_EQ(back.src_ip, p.src_ip);
+    EXPECT_EQ(back.dst_port, 443);
+    EXPECT_DOUBLE_EQ(back.latency_ms, p.latency_ms);
+    EXPECT_EQ(back.timestamp, p.timestamp);
+}
+
 TEST_F(PacketProcessorTest, ParseInvalidPacketReturnsEmpty) {
     auto packet = processor.parsePacket("invalid_data");
     EXPECT_TRUE(packet.src_ip.empty());
@@ -37,6 +56,20 @@ TEST_F(PacketProcessorTest, ValidateEmptyIPFails) {
     EXPECT_FALSE(processor.isValidPacket(p));
 }
 
+TEST_F(PacketProcessorTest, ValidateIPv4Forms) {
+    EXPECT_TRUE(processor.isValidIP("0.0.0.0"));
+    EXPECT_TRUE(processor.isValidIP("255.255.255.255"));
+    EXPECT_TRUE(processor.isValidIP("010.001.1.1"));
+    EXPECT_FALSE(processor.isValidIP("256.0.0.1"));
+    EXPECT_FALSE(processor.isValidIP("1.2.3"));
+    EXPECT_FALSE(processor.isValidIP("1.2.3.4.5"));
+    EXPECT_FALSE(processor.isValidIP("1..3.4"));
+    EXPECT_FALSE(processor.isValidIP("1.2.3.4 "));
+    EXPECT_FALSE(processor.isValidIP("1.2.3.0004"));
+    EXPECT_FALSE(processor.isValidIP("a.b.c.d"));
+    EXPECT_FALSE(processor.isValidIP("::1"));
+}
+
 TEST_F(PacketProcessorTest, ValidateZeroSizeFails) {
     Packet p("192.168.1.1", "10.0.0.1", 5000, 80, Protocol::TCP, 0, 12.5);
     EXPECT_FALSE(processor.isValidPacket(p));
@@ -76,3 +109,39 @@ TEST_F(PacketProcessorTest, CallbackFiredOnProcessed) {
     // Callbacks are stored — verified they compile and store correctly
     EXPECT_EQ(callback_count, 0); // not fired until manually triggered
 }
+
+TEST_F(PacketProcessorTest, ParseIntoMatchesParsePacket) {
+    const std::string raw = "192.168.1.1:5000->10.0.0.1:80|1024|12.5|1700000000123456789\n";
+    Packet pkt;
+    ASSERT_TRUE(processor.parseInto(raw, pkt));
+    Packet expected = processor.parsePacket(raw.substr(0, raw.size() - 1));
+    EXPECT_EQ(pkt.src_ip, expected.src_ip);
+    EXPECT_EQ(pkt.dst_ip, expected.dst_ip);
+    EXPECT_EQ(pkt.src_port, expected.src_port);
+    EXPECT_EQ(pkt.dst_port, expected.dst_port);
+    EXPECT_EQ(pkt.protocol, expected.protocol);
+    EXPECT_EQ(pkt.size_bytes, expected.size_bytes);
+    EXPECT_DOUBLE_EQ(pkt.latency_ms, expected.latency_ms);
+    EXPECT_EQ(pkt.timestamp, expected.timestamp);
+
+    // Reusing the packet clears fields the next record does not carry
+    ASSERT_TRUE(processor.parseInto("10.0.0.9:1->10.0.0.1:53|64|0.5", pkt));
+    EXPECT_EQ(pkt.src_ip, "10.0.0.9");
+    EXPECT_FALSE(hasTimestamp(pkt.timestamp));
+}
+
+TEST_F(PacketProcessorTest, ParseIntoRejectsMalformed) {
+    Packet pkt;
+    for (const char* raw : {"", "invalid_data",
+                            "192.168.1.1:5000->10.0.0.1:80|1024",
+                            "192.168.1.1:5000->10.0.0.1:80|1024|x",
+                            "192.168.1.1:70000->10.0.0.1:80|1024|1.0",
+                            "192.168.1.1:5000->10.0.0.1:80|0|1.0",
+                            "192.168.1.1:5000->10.0.0.1:80|1024|-1.0",
+                            "192.168.1.1:5000->10.0.0.1:80|1024|1.0|12|extra",
+                            ":5000->10.0.0.1:80|1024|1.0",
+                            "garbage:1->foo:80|64|1.0",
+                            "192.168.1.1:5000->10.0.0.300:80|1024|1.0"}) {
+        EXPECT_FALSE(processor.parseInto(raw, pkt)) << raw;
+    }
+}
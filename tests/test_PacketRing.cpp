@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "PacketRing.h"
+#include "NetworkMonitor.h"
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+using namespace anomaly;
+
+class PacketRingTest : public ::testing::Test {
+protected:
+    std::string name = "/5g-ring-test-" + std::to_string(::getpid());
+
+    static trace::PacketRecord makeRecord(int i, uint32_t teid = 0) {
+        Packet p("10.0.0." + std::to_string(i % 250 + 1), "192.168.1.1",
+                 static_cast<uint16_t>(10000 + i), 2152, Protocol::UDP,
+                 100u + i, 0.5 * i,
+                 fromNanos(1'700'000'000'000'000'000LL + i * 1'000'000LL));
+        p.teid = teid;
+        trace::PacketRecord r;
+        trace::encodeRecord(p, r);
+        return r;
+    }
+};
+
+TEST_F(PacketRingTest, OpenFailsWithoutConsumer) {
+    EXPECT_EQ(PacketRingProducer::open(name), nullptr);
+}
+
+TEST_F(PacketRingTest, PeekReadsPublishedRecordsInPlace) {
+    auto consumer = PacketRingConsumer::create(name, 10);
+    ASSERT_NE(consumer, nullptr);
+    EXPECT_EQ(consumer->capacity(), 16u);
+    auto producer = PacketRingProducer::open(name);
+    ASSERT_NE(producer, nullptr);
+
+    const trace::PacketRecord* first = nullptr;
+    EXPECT_EQ(consumer->peek(first, 16), 0u);
+
+    EXPECT_TRUE(producer->tryPush(makeRecord(1, 0x1234)));
+    EXPECT_TRUE(producer->tryPush(makeRecord(2)));
+    ASSERT_EQ(consumer->peek(first, 16), 2u);
+
+    Packet p;
+    trace::decodeRecord(first[0], p);
+    EXPECT_EQ(p.src_ip, "10.0.0.2");
+    EXPECT_EQ(p.src_port, 10001);
+    EXPECT_EQ(p.teid, 0x1234u);
+    trace::decodeRecord(first[1], p);
+    EXPECT_EQ(p.teid, 0u);
+
+    consumer->release(2);
+    EXPECT_EQ(consumer->consumed(), 2u);
+    EXPECT_EQ(consumer->peek(first, 16), 0u);
+}
+
+TEST_F(PacketRingTest, FullRingRejectsAndWrapsAround) {
+    auto consumer = PacketRingConsumer::create(name, 8);
+    auto producer = PacketRingProducer::open(name);
+    ASSERT_NE(producer, nullptr);
+
+    std::vector<trace::PacketRecord> batch;
+    for (int i = 0; i < 12; ++i) batch.push_back(makeRecord(i));
+    EXPECT_EQ(producer->tryPush(batch.data(), 6), 6u);
+    EXPECT_EQ(producer->tryPush(batch.data() + 6, 6), 2u);  // only 8 slots
+    EXPECT_FALSE(producer->tryPush(batch[8]));
+
+    const trace::PacketRecord* first = nullptr;
+    ASSERT_EQ(consumer->peek(first, 5), 5u);
+    consumer->release(5);
+
+    // The next push straddles the end of the ring
+    EXPECT_EQ(producer->tryPush(batch.data() + 8, 4), 4u);
+
+    // Contiguous reads: slots 5-7, then 0-3 after the wrap
+    std::vector<uint16_t> ports;
+    size_t n;
+    while ((n = consumer->peek(first, 16)) > 0) {
+        for (size_t i = 0; i < n; ++i) ports.push_back(first[i].src_port);
+        consumer->release(n);
+    }
+    ASSERT_EQ(ports.size(), 7u);
+    for (size_t i = 0; i < ports.size(); ++i) EXPECT_EQ(ports[i], 10005 + i);
+}
+
+TEST_F(PacketRingTest, IngestFeedsMonitorAndReportsDrops) {
+    auto detector = std::make_shared<AnomalyDetector>();
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+    auto alerts = std::make_shared<AlertManager>("test_packet_ring.log", alert_config);
+    NetworkMonitor monitor(detector, alerts);
+    std::mutex mtx;
+    std::vector<Packet> seen;
+    monitor.onBatch([&](const std::vector<Packet>& batch) {
+        std::lock_guard<std::mutex> lock(mtx);
+        seen.insert(seen.end(), batch.begin(), batch.end());
+    });
+
+    auto consumer = PacketRingConsumer::create(name, 64);
+    ASSERT_NE(consumer, nullptr);
+    auto producer = PacketRingProducer::open(name);
+    ASSERT_NE(producer, nullptr);
+
+    RingIngestConfig config;
+    config.batch_size = 16;
+    config.cpu        = 0;
+    PacketRingIngest ingest(std::move(consumer), monitor, config);
+    monitor.start();
+    ingest.start();
+
+    // More records than the ring holds: the producer waits for the consumer
+    for (int i = 0; i < 1000; ++i) {
+        trace::PacketRecord r = makeRecord(i, 0x10000u + i);
+        while (!producer->tryPush(r)) std::this_thread::yield();
+    }
+    producer->countDropped(7);
+    ingest.stop();
+    monitor.stop();
+    std::remove("test_packet_ring.log");
+
+    RingIngestStats stats = ingest.stats();
+    EXPECT_EQ(stats.records, 1000u);
+    EXPECT_EQ(stats.accepted, 1000u);
+    EXPECT_EQ(stats.dropped, 7u);
+    EXPECT_GE(stats.batches, 1000u / 16);
+    EXPECT_NE(monitor.placementReport().find("ring ingest: cpu 0"), std::string::npos);
+    ASSERT_EQ(seen.size(), 1000u);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(seen[i].src_port, 10000 + i) << i;
+        ASSERT_EQ(seen[i].teid, 0x10000u + i) << i;
+    }
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "RingBuffer.h"
+#include <thread>
+#include <vector>
+#include <string>
+
+using namespace anomaly;
+
+TEST(RingBufferTest, CapacityRoundsUpToPowerOfTwo) {
+    RingBuffer<int> ring(5);
+    EXPECT_EQ(ring.capacity(), 8u);
+}
+
+TEST(RingBufferTest, FifoUntilFull) {
+    RingBuffer<int> ring(4);
+    for (int i = 0; i < 4; ++i) EXPECT_TRUE(ring.tryPush(int(i)));
+    EXPECT_FALSE(ring.tryPush(99));
+    EXPECT_EQ(ring.size(), 4u);
+
+    int v = -1;
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.tryPop(v));
+        EXPECT_EQ(v, i);
+    }
+    EXPECT_FALSE(ring.tryPop(v));
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(RingBufferTest, FailedPushLeavesValueIntact) {
+    RingBuffer<std::string> ring(2);
+    ring.tryPush(std::string("a"));
+    ring.tryPush(std::string("b"));
+    std::string value = "kept";
+    EXPECT_FALSE(ring.tryPush(std::move(value)));
+    EXPECT_EQ(value, "kept");
+}
+
+TEST(RingBufferTest, MultipleProducersDeliverEverything) {
+    RingBuffer<uint64_t> ring(64);
+    constexpr int kProducers = 4;
+    constexpr uint64_t kPerProducer = 50000;
+
+    std::vector<std::thread> producers;
+    for (int t = 0; t < kProducers; ++t) {
+        producers.emplace_back([&ring, t] {
+            for (uint64_t i = 0; i < kPerProducer; ++i) {
+                uint64_t v = (uint64_t(t) << 32) | i;
+                while (!ring.tryPush(std::move(v))) std::this_thread::yield();
+            }
+        });
+    }
+
+    // Per-producer order must be preserved
+    std::vector<uint64_t> next(kProducers, 0);
+    uint64_t received = 0;
+    bool ordered = true;
+    while (received < kProducers * kPerProducer) {
+        uint64_t v;
+        if (!ring.tryPop(v)) continue;
+        auto t = static_cast<size_t>(v >> 32);
+        if ((v & 0xffffffffu) != next[t]++) ordered = false;
+        ++received;
+    }
+    for (auto& p : producers) p.join();
+
+    EXPECT_TRUE(ordered);
+    EXPECT_TRUE(ring.empty());
+}
+
+TEST(ParkerTest, NotifyWakesParkedWaiter) {
+    Parker parker;
+    std::atomic<bool> flag{false};
+    std::thread waiter([&] {
+        parker.wait([&] { return flag.load(); }, 0);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    flag.store(true);
+    parker.notify();
+    waiter.join();
+    SUCCEED();
+}
+
+TEST(RingBufferTest, BulkPushFillsUpToCapacity) {
+    RingBuffer<int> ring(8);
+    int values[12];
+    for (int i = 0; i < 12; ++i) values[i] = i;
+
+    EXPECT_EQ(ring.tryPushBulk(5, [&](size_t i) { return values[i]; }), 5u);
+    EXPECT_EQ(ring.tryPushBulk(7, [&](size_t i) { return values[5 + i]; }), 3u);
+    EXPECT_EQ(ring.tryPushBulk(1, [&](size_t) { return 99; }), 0u);
+
+    int v;
+    for (int i = 0; i < 8; ++i) {
+        ASSERT_TRUE(ring.tryPop(v));
+        EXPECT_EQ(v, i);
+    }
+}
+
+TEST(RingBufferTest, BulkPushAfterWrapAround) {
+    RingBuffer<int> ring(4);
+    int v;
+    for (int round = 0; round < 10; ++round) {
+        ASSERT_EQ(ring.tryPushBulk(3, [&](size_t i) { return round * 3 + int(i); }), 3u);
+        for (int i = 0; i < 3; ++i) {
+            ASSERT_TRUE(ring.tryPop(v));
+            EXPECT_EQ(v, round * 3 + i);
+        }
+    }
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include "Rollups.h"
+#include "NetworkMonitor.h"
+#include "TestPaths.h"
+#include <cstdio>
+#include <thread>
+
+using namespace anomaly;
+
+class RollupsTest : public ::testing::Test {
+protected:
+    const std::string path = testPath("test_rollups.bin");
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        std::remove((path + ".idx").c_str());
+    }
+
+    static Packet makePacket(int64_t second, int src, uint16_t port, double latency,
+                             uint32_t size = 100) {
+        return Packet("10.0.0." + std::to_string(src), "192.168.1.1", 40000, port,
+                      Protocol::TCP, size, latency,
+                      fromNanos(second * 1'000'000'000LL + src * 1000));
+    }
+};
+
+TEST_F(RollupsTest, AggregatesEachSecondOverallAndByKey) {
+    {
+        TrafficRollups rollups(path);
+        ASSERT_TRUE(rollups.isOpen());
+        std::vector<Packet> batch;
+        // Second 1000: 100 packets from 10 sources, latencies 1..100 ms
+        for (int i = 0; i < 100; ++i) {
+            batch.push_back(makePacket(1000, i % 10 + 1, i < 60 ? 443 : 80, i + 1.0, 100 + i));
+        }
+        batch.push_back(makePacket(1001, 1, 53, 5.0));
+        rollups.observe(batch);
+        rollups.flush();
+        RollupStats stats = rollups.stats();
+        EXPECT_EQ(stats.seconds, 2u);
+        EXPECT_EQ(stats.records, 5u);  // 3 rows, then 2
+        EXPECT_EQ(stats.packets, 101u);
+    }
+
+    auto reader = RollupReader::open(path);
+    ASSERT_NE(reader, nullptr);
+    EXPECT_EQ(reader->keyKind(), RollupKey::DST_PORT);
+    ASSERT_EQ(reader->size(), 5u);
+
+    const rollup::Record* r = reader->records();
+    EXPECT_EQ(r[0].second, 1000);
+    EXPECT_EQ(r[0].kind, static_cast<uint8_t>(RollupKey::NONE));
+    EXPECT_EQ(r[0].packets, 100u);
+    EXPECT_EQ(r[0].bytes, 100u * 100 + 99 * 100 / 2);
+    EXPECT_FLOAT_EQ(r[0].latency_min_ms, 1.0f);
+    EXPECT_FLOAT_EQ(r[0].latency_max_ms, 100.0f);
+    EXPECT_FLOAT_EQ(r[0].latency_mean_ms, 50.5f);
+    EXPECT_GE(r[0].latency_p99_ms, 99.0f);
+    EXPECT_LE(r[0].latency_p99_ms, 100.0f);
+    EXPECT_NEAR(r[0].sources, 10u, 1u);  // HyperLogLog estimate
+
+    // Keyed rows in key order
+    EXPECT_EQ(r[1].key, 80u);
+    EXPECT_EQ(r[1].packets, 40u);
+    EXPECT_FLOAT_EQ(r[1].latency_min_ms, 61.0f);
+    EXPECT_EQ(r[2].key, 443u);
+    EXPECT_EQ(r[2].packets, 60u);
+    EXPECT_EQ(r[3].second, 1001);
+    EXPECT_EQ(r[4].key, 53u);
+    EXPECT_EQ(r[4].sources, 1u);
+}
+
+TEST_F(RollupsTest, LatePacketsAndReopenedFiles) {
+    RollupConfig config;
+    config.key = RollupKey::NONE;
+    config.flush_lag_sec = 1;
+    {
+        TrafficRollups rollups(path, config);
+        rollups.observe({makePacket(10, 1, 443, 1.0), makePacket(12, 1, 443, 1.0)});
+        // 12 is the newest second, so 10 and 11 are closed
+        rollups.observe({makePacket(11, 1, 443, 1.0), makePacket(12, 2, 443, 1.0)});
+        EXPECT_EQ(rollups.stats().late, 1u);
+        EXPECT_EQ(rollups.stats().seconds, 1u);
+    }
+    {
+        // Continues the file; seconds already written count as late
+        TrafficRollups rollups(path, config);
+        rollups.observe({makePacket(12, 3, 443, 1.0), makePacket(13, 1, 443, 1.0)});
+        EXPECT_EQ(rollups.stats().late, 1u);
+    }
+    auto reader = RollupReader::open(path);
+    ASSERT_NE(reader, nullptr);
+    auto series = reader->series(0, 100);
+    ASSERT_EQ(series.size(), 3u);
+    EXPECT_EQ(series[0].second, 10);
+    EXPECT_EQ(series[1].second, 12);
+    EXPECT_EQ(series[1].packets, 2u);
+    EXPECT_EQ(series[2].second, 13);
+}
+
+TEST_F(RollupsTest, RangeQueriesUseTheIndex) {
+    RollupConfig config;
+    config.key = RollupKey::SOURCE;
+    config.index_every_sec = 10;
+    {
+        TrafficRollups rollups(path, config);
+        std::vector<Packet> batch;
+        for (int64_t s = 0; s < 500; ++s) {
+            batch.clear();
+            // Sources 1..(s % 7 + 1) each send one packet
+            for (int src = 1; src <= s % 7 + 1; ++src) {
+                batch.push_back(makePacket(5000 + s, src, 443, static_cast<double>(s)));
+            }
+            rollups.observe(batch);
+        }
+    }
+
+    auto reader = RollupReader::open(path);
+    ASSERT_NE(reader, nullptr);
+    const rollup::Record* first = nullptr;
+    size_t n = reader->range(5123, 5125, first);
+    // Seconds 5123-5125 carry 5, 6 and 7 sources, plus an overall row each
+    ASSERT_EQ(n, 6u + 7u + 8u);
+    EXPECT_EQ(first[0].second, 5123);
+    EXPECT_EQ(first[n - 1].second, 5125);
+    EXPECT_EQ(reader->range(0, 4999, first), 0u);
+    EXPECT_EQ(reader->range(5499, INT64_MAX, first), 1u + 3u);
+
+    // 10.0.0.7 only appears when s % 7 == 6
+    auto series = reader->series(5000, 5099, RollupKey::SOURCE, 0x0A000007);
+    ASSERT_EQ(series.size(), 100u / 7);
+    for (const auto& r : series) {
+        EXPECT_EQ((r.second - 5000) % 7, 6);
+        EXPECT_EQ(r.packets, 1u);
+    }
+    EXPECT_EQ(reader->series(5000, 5499).size(), 500u);
+}
+
+TEST_F(RollupsTest, MergesLanesFromSeveralThreads) {
+    RollupConfig config;
+    config.flush_lag_sec = 10;  // nothing closes until flush()
+    {
+        TrafficRollups rollups(path, config);
+        // Thread t sends 50 packets per second from source t+1 to ports
+        // 443 and 80+t, latency t+1 ms
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                for (int64_t s = 3000; s < 3003; ++s) {
+                    std::vector<Packet> batch;
+                    for (int i = 0; i < 50; ++i) {
+                        batch.push_back(makePacket(s, t + 1, i % 2 ? 443 : 80 + t, t + 1.0));
+                    }
+                    rollups.observe(batch);
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+        rollups.flush();
+        RollupStats stats = rollups.stats();
+        EXPECT_EQ(stats.packets, 600u);
+        EXPECT_EQ(stats.late, 0u);
+        EXPECT_EQ(stats.seconds, 3u);
+        EXPECT_EQ(stats.records, 3u * 6);  // overall, 80..83, 443
+    }
+
+    auto reader = RollupReader::open(path);
+    ASSERT_NE(reader, nullptr);
+    ASSERT_EQ(reader->size(), 18u);
+    for (int64_t s = 3000; s < 3003; ++s) {
+        auto overall = reader->series(s, s);
+        ASSERT_EQ(overall.size(), 1u);
+        EXPECT_EQ(overall[0].packets, 200u);
+        EXPECT_FLOAT_EQ(overall[0].latency_min_ms, 1.0f);
+        EXPECT_FLOAT_EQ(overall[0].latency_max_ms, 4.0f);
+        EXPECT_FLOAT_EQ(overall[0].latency_mean_ms, 2.5f);
+        EXPECT_EQ(overall[0].sources, 4u);
+        auto https = reader->series(s, s, RollupKey::DST_PORT, 443);
+        ASSERT_EQ(https.size(), 1u);
+        EXPECT_EQ(https[0].packets, 100u);
+        EXPECT_EQ(https[0].sources, 4u);
+        auto own = reader->series(s, s, RollupKey::DST_PORT, 82);
+        ASSERT_EQ(own.size(), 1u);
+        EXPECT_EQ(own[0].packets, 25u);
+    }
+}
+
+TEST_F(RollupsTest, AttachesToMonitor) {
+    auto detector = std::make_shared<AnomalyDetector>();
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+    const std::string log = testPath("test_rollups.log");
+    auto alerts = std::make_shared<AlertManager>(log, alert_config);
+    {
+        TrafficRollups rollups(path);
+        NetworkMonitor monitor(detector, alerts);
+        rollups.attach(monitor);
+        monitor.start();
+        for (int i = 0; i < 300; ++i) monitor.feedPacket(makePacket(2000 + i / 100, 1, 443, 2.0));
+        monitor.stop();
+        rollups.flush();
+        EXPECT_EQ(rollups.stats().packets, 300u);
+    }
+    std::remove(log.c_str());
+    auto reader = RollupReader::open(path);
+    ASSERT_NE(reader, nullptr);
+    auto series = reader->series(2000, 2002);
+    ASSERT_EQ(series.size(), 3u);
+    for (const auto& r : series) EXPECT_EQ(r.packets, 100u);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include "SourceInterner.h"
+#include "IpAddress.h"
+
+using namespace anomaly;
+
+TEST(IpAddressTest, ParsesDottedQuad) {
+    uint32_t addr = 0;
+    ASSERT_TRUE(parseIPv4("192.168.1.10", addr));
+    EXPECT_EQ(addr, 0xC0A8010Au);
+    EXPECT_EQ(formatIPv4(addr), "192.168.1.10");
+}
+
+TEST(IpAddressTest, RejectsMalformed) {
+    uint32_t addr = 0;
+    EXPECT_FALSE(parseIPv4("256.1.1.1", addr));
+    EXPECT_FALSE(parseIPv4("1.2.3", addr));
+    EXPECT_FALSE(parseIPv4("1..2.3", addr));
+    EXPECT_FALSE(parseIPv4("1.2.3.4.5", addr));
+    EXPECT_FALSE(parseIPv4("fe80::1", addr));
+}
+
+TEST(SourceInternerTest, SameAddressSameId) {
+    SourceInterner interner;
+    uint32_t a = interner.intern("192.168.1.1");
+    uint32_t b = interner.intern("192.168.1.2");
+    EXPECT_NE(a, b);
+    EXPECT_EQ(interner.intern("192.168.1.1"), a);
+    EXPECT_EQ(interner.size(), 2u);
+    EXPECT_EQ(interner.keyOf(b), "192.168.1.2");
+}
+
+TEST(SourceInternerTest, NonIPv4KeysFallBackToStrings) {
+    SourceInterner interner;
+    uint32_t id = interner.intern("fe80::1");
+    EXPECT_EQ(interner.find("fe80::1"), id);
+    EXPECT_EQ(interner.find("fe80::2"), SourceInterner::kInvalidId);
+}
+
+TEST(SourceInternerTest, ReleasedIdsAreRecycled) {
+    SourceInterner interner;
+    uint32_t a = interner.intern("10.0.0.1");
+    interner.intern("10.0.0.2");
+    interner.release(a);
+    interner.release(a);  // double release is a no-op
+
+    EXPECT_EQ(interner.find("10.0.0.1"), SourceInterner::kInvalidId);
+    EXPECT_EQ(interner.intern("10.0.0.3"), a);
+    EXPECT_EQ(interner.capacity(), 2u);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "TraceFile.h"
+#include "TestPaths.h"
+#include <filesystem>
+#include <fstream>
+
+using namespace anomaly;
+
+class TraceFileTest : public ::testing::Test {
+protected:
+    const std::string path = testPath("test_trace.bin");
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+    }
+
+    static Packet makePacket(int i) {
+        return Packet("10.0.0." + std::to_string(i % 250 + 1), "192.168.1.1",
+                      static_cast<uint16_t>(40000 + i), 443, Protocol::TCP,
+                      100u + i, 0.5 * i,
+                      fromNanos(1'700'000'000'000'000'000LL + i * 1'000'000LL));
+    }
+};
+
+TEST_F(TraceFileTest, BinaryRoundTrip) {
+    {
+        TraceWriter writer(path);
+        ASSERT_TRUE(writer.isOpen());
+        for (int i = 0; i < 10000; ++i) writer.write(makePacket(i));
+        writer.write(Packet("fe80::1", "10.0.0.1", 1, 2, Protocol::UDP, 64, 1.0));
+        EXPECT_EQ(writer.written(), 10000u);
+        EXPECT_EQ(writer.skipped(), 1u);
+    }
+    EXPECT_EQ(std::filesystem::file_size(path),
+              sizeof(trace::FileHeader) + 10000 * sizeof(trace::PacketRecord));
+
+    TraceReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_TRUE(reader.isBinary());
+    Packet p;
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_TRUE(reader.next(p));
+        Packet want = makePacket(i);
+        EXPECT_EQ(p.src_ip, want.src_ip);
+        EXPECT_EQ(p.dst_ip, want.dst_ip);
+        EXPECT_EQ(p.src_port, want.src_port);
+        EXPECT_EQ(p.protocol, want.protocol);
+        EXPECT_EQ(p.size_bytes, want.size_bytes);
+        EXPECT_DOUBLE_EQ(p.latency_ms, want.latency_ms);
+        EXPECT_EQ(p.timestamp, want.timestamp);
+    }
+    EXPECT_FALSE(reader.next(p));
+}
+
+TEST_F(TraceFileTest, ReadsTextTraces) {
+    {
+        std::ofstream out(path);
+        out << "# recorded on gw-3\n"
+            << "10.0.0.1:5000->10.0.0.2:80|1024|12.5|1700000000000000000\n"
+            << "\n"
+            << "not a packet\n"
+            << "10.0.0.3:5001->10.0.0.2:53|64|1.25\r\n";
+    }
+    TraceReader reader(path);
+    ASSERT_TRUE(reader.isOpen());
+    EXPECT_FALSE(reader.isBinary());
+
+    std::vector<Packet> packets;
+    EXPECT_EQ(reader.next(packets, 100), 2u);
+    EXPECT_EQ(reader.skipped(), 1u);
+    ASSERT_EQ(packets.size(), 2u);
+    EXPECT_EQ(toNanos(packets[0].timestamp), 1700000000000000000LL);
+    EXPECT_EQ(packets[1].src_ip, "10.0.0.3");
+    EXPECT_EQ(packets[1].protocol, Protocol::UDP);
+    EXPECT_FALSE(hasTimestamp(packets[1].timestamp));
+}
+
+TEST_F(TraceFileTest, MissingFileIsNotOpen) {
+    TraceReader reader("no_such_trace.bin");
+    EXPECT_FALSE(reader.isOpen());
+    Packet p;
+    EXPECT_FALSE(reader.next(p));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "TraceReplayer.h"
+#include "TraceFile.h"
+#include "NetworkMonitor.h"
+#include "TestPaths.h"
+#include <filesystem>
+
+using namespace anomaly;
+
+class TraceReplayerTest : public ::testing::Test {
+protected:
+    const std::string trace_path  = testPath("test_replay.bin");
+    const std::string record_path = testPath("test_replay_record.bin");
+    const std::string log_path    = testPath("test_replay.log");
+    std::shared_ptr<AnomalyDetector> detector;
+    std::shared_ptr<AlertManager> alerts;
+    const TimePoint start{std::chrono::seconds(1'700'000'000)};
+
+    void SetUp() override {
+        DetectorConfig config;
+        config.flood_threshold = 100;
+        detector = std::make_shared<AnomalyDetector>(config);
+        AlertManagerConfig alert_config;
+        alert_config.log.console = false;
+        alerts = std::make_shared<AlertManager>(log_path, alert_config);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(trace_path);
+        std::filesystem::remove(record_path);
+        std::filesystem::remove(log_path);
+    }
+
+    // `count` packets from 10.0.0.1 spread evenly over `span` of trace time
+    void writeTrace(int count, std::chrono::milliseconds span) {
+        TraceWriter writer(trace_path);
+        for (int i = 0; i < count; ++i) {
+            writer.write(Packet("10.0.0.1", "10.0.0.2", 5000, 443, Protocol::TCP,
+                                512, 5.0, start + span * i / count));
+        }
+    }
+};
+
+TEST_F(TraceReplayerTest, HonoursSpeed) {
+    writeTrace(200, std::chrono::milliseconds(200));
+    NetworkMonitor monitor(detector, alerts);
+    monitor.start();
+
+    ReplayConfig config;
+    config.speed = 2.0;
+    TraceReader reader(trace_path);
+    ReplayStats stats = TraceReplayer(config).run(reader, monitor);
+    monitor.stop();
+
+    EXPECT_EQ(stats.packets, 200u);
+    EXPECT_EQ(stats.accepted, 200u);
+    EXPECT_NEAR(stats.trace_seconds, 0.199, 0.001);
+    // ~0.1 s of wall time; generous upper bound for loaded CI machines
+    EXPECT_GE(stats.seconds, 0.095);
+    EXPECT_LT(stats.seconds, 0.5);
+    EXPECT_NEAR(stats.target_pps, 2000.0, 20.0);
+}
+
+TEST_F(TraceReplayerTest, MaxSpeedKeepsEventTime) {
+    // A one-minute flood replayed flat out is still a flood in event time
+    writeTrace(5000, std::chrono::milliseconds(60'000));
+    NetworkMonitor monitor(detector, alerts);
+    monitor.start();
+
+    ReplayConfig config;
+    config.speed = 0.0;
+    TraceReader reader(trace_path);
+    ReplayStats stats = TraceReplayer(config).run(reader, monitor);
+    monitor.stop();
+
+    EXPECT_EQ(stats.packets, 5000u);
+    EXPECT_LT(stats.seconds, 5.0);
+    EXPECT_EQ(stats.target_pps, 0.0);
+    EXPECT_GT(alerts->count(), 0u);
+    for (const auto& a : alerts->getAlerts()) {
+        EXPECT_GE(a->report.detected_at, start);
+        EXPECT_LE(a->report.detected_at, start + std::chrono::seconds(60));
+    }
+}
+
+TEST_F(TraceReplayerTest, MonitorTapRecordsReplayableTrace) {
+    writeTrace(1000, std::chrono::milliseconds(1000));
+    {
+        NetworkMonitor monitor(detector, alerts);
+        TraceWriter recorder(record_path);
+        monitor.onBatch([&](const std::vector<Packet>& batch) { recorder.write(batch); });
+        monitor.start();
+        ReplayConfig config;
+        config.speed = 0.0;
+        TraceReader reader(trace_path);
+        TraceReplayer(config).run(reader, monitor);
+        monitor.stop();
+        EXPECT_EQ(recorder.written(), 1000u);
+    }
+    EXPECT_EQ(std::filesystem::file_size(record_path),
+              std::filesystem::file_size(trace_path));
+
+    TraceReader reader(record_path);
+    std::vector<Packet> packets;
+    EXPECT_EQ(reader.next(packets, 2000), 1000u);
+    EXPECT_EQ(packets.front().timestamp, start);
+}
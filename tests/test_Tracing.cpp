@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include "Tracing.h"
+#include "NetworkMonitor.h"
+#include "TestPaths.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace anomaly;
+
+class TracingTest : public ::testing::Test {
+protected:
+    const std::string log_path   = testPath("test_tracing.log");
+    const std::string trace_path = testPath("test_tracing.json");
+
+    void SetUp() override { tracing::clear(); }
+
+    void TearDown() override {
+        tracing::configure({});
+        tracing::clear();
+        std::filesystem::remove(log_path);
+        std::filesystem::remove(trace_path);
+    }
+};
+
+TEST_F(TracingTest, OffByDefault) {
+    EXPECT_FALSE(tracing::active());
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(tracing::sample(), 0u);
+    }
+    tracing::record(0, tracing::Stage::INGEST);
+    EXPECT_EQ(tracing::stats().records, 0u);
+}
+
+TEST_F(TracingTest, SamplesOneInN) {
+    tracing::configure({10});
+    size_t sampled = 0;
+    for (int i = 0; i < 1000; ++i) {
+        if (tracing::sample() != 0) ++sampled;
+    }
+    EXPECT_EQ(sampled, 100u);
+}
+
+TEST_F(TracingTest, FullBufferDropsRecords) {
+    tracing::TracerConfig config;
+    config.sample_every       = 1;
+    config.records_per_thread = 4;
+    tracing::configure(config);
+    // A fresh thread so its buffer is sized by this config
+    std::thread([] {
+        uint64_t id = tracing::sample();
+        for (int i = 0; i < 10; ++i) tracing::record(id, tracing::Stage::INGEST);
+    }).join();
+    tracing::TraceStats s = tracing::stats();
+    EXPECT_EQ(s.records, 4u);
+    EXPECT_EQ(s.dropped, 6u);
+}
+
+TEST_F(TracingTest, ExitedThreadsHandTheirBuffersOn) {
+    tracing::configure({1});
+    size_t buffers = tracing::stats().buffers;
+    size_t threads = tracing::stats().threads;
+    for (int i = 0; i < 20; ++i) {
+        std::thread([] { tracing::record(tracing::sample(), tracing::Stage::INGEST); }).join();
+    }
+    auto stats = tracing::stats();
+    EXPECT_EQ(stats.records, 20u);  // earlier owners' records are kept
+    EXPECT_EQ(stats.threads, threads + 20);
+    EXPECT_LE(stats.buffers, buffers + 1);
+}
+
+TEST_F(TracingTest, MonitorPipelineWritesChromeTrace) {
+    DetectorConfig config;
+    config.max_latency_ms = 100.0;
+    auto detector = std::make_shared<AnomalyDetector>(config);
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+    auto alerts = std::make_shared<AlertManager>(log_path, alert_config);
+
+    tracing::configure({1});
+    {
+        NetworkMonitor monitor(detector, alerts);
+        monitor.start();
+        for (int i = 0; i < 5; ++i) {
+            ASSERT_TRUE(monitor.feedPacket(Packet("192.168.1.1", "10.0.0.1", 5000, 80,
+                                                  Protocol::TCP, 1024, 250.0)));
+        }
+        monitor.stop();
+    }
+    alerts->flushLog();
+    ASSERT_TRUE(tracing::writeChromeTrace(trace_path));
+
+    std::ifstream in(trace_path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string json = ss.str();
+    EXPECT_EQ(json.rfind("{\"displayTimeUnit\"", 0), 0u);
+    for (auto stage : {tracing::Stage::INGEST, tracing::Stage::ENQUEUE,
+                       tracing::Stage::DEQUEUE, tracing::Stage::ANALYZE_START,
+                       tracing::Stage::ANALYZE_END, tracing::Stage::ALERT_RAISED,
+                       tracing::Stage::ALERT_PERSISTED}) {
+        EXPECT_NE(json.find(std::string("\"name\":\"") + tracing::stageName(stage) + "\""),
+                  std::string::npos) << tracing::stageName(stage);
+    }
+    EXPECT_NE(json.find("\"name\":\"ingest -> enqueue\",\"ph\":\"b\""), std::string::npos);
+    // Every packet is stamped at all seven stages
+    EXPECT_EQ(tracing::stats().records, 5u * 7u);
+}
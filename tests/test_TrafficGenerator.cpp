@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "TrafficGenerator.h"
+#include "NetworkMonitor.h"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <tuple>
+
+using namespace anomaly;
+
+class TrafficGeneratorTest : public ::testing::Test {
+protected:
+    TrafficConfig config;
+
+    void SetUp() override {
+        config.sources         = 1000;
+        config.packets_per_sec = 10000;
+    }
+
+    static std::vector<Packet> drain(TrafficGenerator::Stream stream) {
+        std::vector<Packet> out;
+        while (stream.next(out, 4096) > 0) {}
+        return out;
+    }
+
+    static auto key(const Packet& p) {
+        return std::make_tuple(p.timestamp, p.src_ip, p.dst_ip, p.src_port,
+                               p.dst_port, p.size_bytes, p.latency_ms);
+    }
+};
+
+TEST_F(TrafficGeneratorTest, StreamIsTimeOrderedAndBounded) {
+    config.attacks.push_back({AttackKind::FLOOD, 0.2, 0.3, 2000.0});
+    TrafficGenerator gen(config);
+    auto packets = drain(gen.stream(0, 1, 1.0));
+
+    EXPECT_EQ(packets.size(), 10000u + 600u);
+    EXPECT_TRUE(std::is_sorted(packets.begin(), packets.end(),
+                               [](const Packet& a, const Packet& b) {
+                                   return a.timestamp < b.timestamp;
+                               }));
+    EXPECT_LT(packets.back().timestamp, config.start + std::chrono::seconds(1));
+}
+
+TEST_F(TrafficGeneratorTest, SameTrafficForAnyStreamCount) {
+    config.attacks.push_back({AttackKind::SCAN, 0.1, 0.2, 500.0});
+    TrafficGenerator gen(config);
+
+    auto single = drain(gen.stream(0, 1, 0.5));
+    std::vector<Packet> split;
+    for (size_t i = 0; i < 3; ++i) {
+        auto part = drain(gen.stream(i, 3, 0.5));
+        split.insert(split.end(), part.begin(), part.end());
+    }
+    ASSERT_EQ(single.size(), split.size());
+
+    auto less = [](const Packet& a, const Packet& b) { return key(a) < key(b); };
+    std::sort(single.begin(), single.end(), less);
+    std::sort(split.begin(), split.end(), less);
+    for (size_t i = 0; i < single.size(); ++i) {
+        ASSERT_EQ(key(single[i]), key(split[i]));
+    }
+}
+
+TEST_F(TrafficGeneratorTest, ZipfSkewConcentratesTraffic) {
+    config.zipf_skew = 1.2;
+    TrafficGenerator gen(config);
+    auto packets = drain(gen.stream(0, 1, 2.0));
+
+    std::map<std::string, size_t> counts;
+    for (const auto& p : packets) ++counts[p.src_ip];
+    // Rank 0 (10.0.0.0) is the most popular source by a wide margin
+    size_t top = counts["10.0.0.0"];
+    for (const auto& [ip, n] : counts) EXPECT_LE(n, top);
+    EXPECT_GT(top, packets.size() / 10);
+
+    config.zipf_skew = 0.0;
+    TrafficGenerator uniform(config);
+    counts.clear();
+    for (const auto& p : drain(uniform.stream(0, 1, 2.0))) ++counts[p.src_ip];
+    EXPECT_LT(counts["10.0.0.0"], packets.size() / 100);
+}
+
+TEST_F(TrafficGeneratorTest, GroundTruthDescribesScenarios) {
+    config.attacks.push_back({AttackKind::DISTRIBUTED_FLOOD, 1.0, 2.0, 1000.0, 8});
+    config.attacks.push_back({AttackKind::LATENCY_SPIKE, 3.0, 1.0, 0.0, 1, 800.0});
+    TrafficGenerator gen(config);
+
+    auto truth = gen.groundTruth();
+    ASSERT_EQ(truth.size(), 2u);
+    EXPECT_EQ(truth[0].expected, AnomalyType::FLOOD);
+    EXPECT_EQ(truth[0].sources.size(), 8u);
+    EXPECT_EQ(truth[0].packets, 2000u);
+    EXPECT_EQ(truth[0].start, config.start + std::chrono::seconds(1));
+    EXPECT_EQ(truth[1].expected, AnomalyType::HIGH_LATENCY);
+    EXPECT_TRUE(truth[1].sources.empty());
+
+    // Every DISTRIBUTED_FLOOD packet comes from a listed attacker
+    auto packets = drain(gen.stream(0, 1, 4.0));
+    size_t attack_packets = 0, slow = 0;
+    for (const auto& p : packets) {
+        if (std::find(truth[0].sources.begin(), truth[0].sources.end(), p.src_ip) !=
+            truth[0].sources.end()) {
+            ++attack_packets;
+        }
+        if (p.latency_ms > 500) ++slow;
+    }
+    EXPECT_EQ(attack_packets, 2000u);
+    EXPECT_GE(slow, 10000u);  // the spike second of background traffic
+}
+
+TEST_F(TrafficGeneratorTest, DrivenMonitorDetectsScenarios) {
+    config.latency_sigma = 0.1;  // keep background well under the latency threshold
+    config.zipf_skew     = 0.5;  // busiest background source stays under the flood threshold
+    config.attacks.push_back({AttackKind::FLOOD, 0.5, 1.0, 2000.0});
+    config.attacks.push_back({AttackKind::SCAN, 1.0, 0.5, 100.0});
+    config.attacks.push_back({AttackKind::LATENCY_SPIKE, 1.5, 0.2, 0.0, 1, 400.0});
+    TrafficGenerator gen(config);
+
+    DetectorConfig detector_config;
+    detector_config.max_latency_ms  = 100.0;
+    detector_config.flood_threshold = 500;
+    detector_config.window_size_sec = 1;
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+    auto detector = std::make_shared<AnomalyDetector>(detector_config);
+    auto alerts   = std::make_shared<AlertManager>("test_traffic.log", alert_config);
+
+    MonitorConfig monitor_config;
+    monitor_config.workers = 2;
+    NetworkMonitor monitor(detector, alerts, nullptr, monitor_config);
+    monitor.start();
+    DriveOptions options;
+    options.duration_sec = 2.0;
+    options.threads      = 2;
+    auto result = driveMonitor(monitor, gen, options);
+    monitor.stop();
+    std::filesystem::remove("test_traffic.log");
+
+    EXPECT_EQ(result.offered, result.accepted);
+    EXPECT_EQ(monitor.stats().processed, result.offered);
+
+    auto score = TrafficGenerator::score(gen.groundTruth(), alerts->getAlerts());
+    EXPECT_EQ(score.events, 3u);
+    EXPECT_EQ(score.detected, 3u);
+    EXPECT_DOUBLE_EQ(score.recall, 1.0);
+    EXPECT_EQ(score.unmatched_alerts, 0u);
+}
+
+TEST_F(TrafficGeneratorTest, StreamsPartitionSources) {
+    config.attacks.push_back({AttackKind::DISTRIBUTED_FLOOD, 0.0, 0.5, 1000.0, 16});
+    TrafficGenerator gen(config);
+
+    std::map<std::string, size_t> owner;
+    for (size_t i = 0; i < 4; ++i) {
+        for (const auto& p : drain(gen.stream(i, 4, 0.5))) {
+            auto [it, inserted] = owner.emplace(p.src_ip, i);
+            ASSERT_EQ(it->second, i) << p.src_ip << " appears in two streams";
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "anomaly_c.h"
+#include "AnomalyDetector.h"
+#include "IpAddress.h"
+#include "TrafficGenerator.h"
+
+using namespace anomaly;
+
+namespace {
+// Column copies of a packet vector, as a caller's arrays would hold them
+struct Columns {
+    std::vector<uint32_t> src, dst, size;
+    std::vector<uint16_t> sport, dport;
+    std::vector<uint8_t> proto;
+    std::vector<double> latency;
+    std::vector<int64_t> ts;
+
+    explicit Columns(const std::vector<Packet>& packets) {
+        for (const auto& p : packets) {
+            uint32_t a = 0, b = 0;
+            parseIPv4(p.src_ip, a);
+            parseIPv4(p.dst_ip, b);
+            src.push_back(a);
+            dst.push_back(b);
+            sport.push_back(p.src_port);
+            dport.push_back(p.dst_port);
+            proto.push_back(static_cast<uint8_t>(p.protocol));
+            size.push_back(p.size_bytes);
+            latency.push_back(p.latency_ms);
+            ts.push_back(toNanos(p.timestamp));
+        }
+    }
+
+    anomaly_batch batch() const {
+        return anomaly_batch{src.size(), src.data(), dst.data(), sport.data(), dport.data(),
+                             proto.data(), size.data(), latency.data(), ts.data()};
+    }
+};
+
+struct Results {
+    std::vector<uint64_t> row;
+    std::vector<uint8_t> type;
+    std::vector<double> severity;
+    std::vector<int64_t> detected;
+
+    explicit Results(size_t n) : row(n), type(n), severity(n), detected(n) {}
+
+    anomaly_results out() {
+        return anomaly_results{row.size(), row.data(), type.data(), severity.data(),
+                               detected.data(), 0};
+    }
+};
+} // namespace
+
+TEST(AnomalyCApiTest, MatchesDetectorOnGeneratedTraffic) {
+    TrafficConfig traffic;
+    traffic.sources = 200;
+    traffic.attacks.push_back({AttackKind::FLOOD, 0.2, 0.5, 20000.0});
+    traffic.attacks.push_back({AttackKind::LATENCY_SPIKE, 0.5, 0.2, 0.0, 1, 400.0});
+    TrafficGenerator generator(traffic);
+    std::vector<Packet> packets;
+    auto stream = generator.stream(0, 1, 1.0);
+    while (stream.next(packets, 4096) > 0) {}
+    ASSERT_GT(packets.size(), 10000u);  // several C API chunks
+
+    DetectorConfig config;
+    config.flood_threshold = 500;
+    AnomalyDetector reference(config);
+    std::vector<AnomalyReport> expected;
+    std::vector<size_t> expected_rows;
+    reference.analyzeBatch(packets.data(), packets.size(), expected, &expected_rows);
+    ASSERT_FALSE(expected.empty());
+
+    EXPECT_EQ(anomaly_abi_version(), ANOMALY_C_ABI_VERSION);
+    anomaly_config c;
+    anomaly_config_init(&c);
+    EXPECT_DOUBLE_EQ(c.max_latency_ms, DetectorConfig{}.max_latency_ms);
+    c.flood_threshold = 500;
+    anomaly_detector* detector = anomaly_detector_create(&c);
+    ASSERT_NE(detector, nullptr);
+
+    Columns columns(packets);
+    anomaly_batch batch = columns.batch();
+    Results results(packets.size());
+    anomaly_results out = results.out();
+    int64_t n = anomaly_detector_analyze(detector, &batch, &out);
+    ASSERT_EQ(n, static_cast<int64_t>(expected.size()));
+    EXPECT_EQ(out.overflow, 0u);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(results.row[i], expected_rows[i]) << i;
+        ASSERT_EQ(results.type[i], static_cast<uint8_t>(expected[i].type)) << i;
+        ASSERT_DOUBLE_EQ(results.severity[i], expected[i].severity) << i;
+        ASSERT_EQ(results.detected[i], toNanos(expected[i].detected_at)) << i;
+    }
+    EXPECT_EQ(anomaly_detector_sources(detector), reference.trackedSources());
+    EXPECT_STREQ(anomaly_type_name(results.type[0]), anomalyTypeName(expected[0].type));
+
+    anomaly_detector_reset(detector);
+    EXPECT_EQ(anomaly_detector_sources(detector), 0u);
+    anomaly_detector_destroy(detector);
+}
+
+TEST(AnomalyCApiTest, OptionalColumnsAndOverflow) {
+    anomaly_detector* detector = anomaly_detector_create(nullptr);
+    ASSERT_NE(detector, nullptr);
+
+    // Only the required columns: every row is over the latency threshold
+    std::vector<uint32_t> src{0x0A000001, 0x0A000002, 0x0A000003};
+    std::vector<double> latency{150.0, 300.0, 450.0};
+    anomaly_batch batch{};
+    batch.count      = src.size();
+    batch.src_addr   = src.data();
+    batch.latency_ms = latency.data();
+
+    Results results(2);
+    anomaly_results out = results.out();
+    EXPECT_EQ(anomaly_detector_analyze(detector, &batch, &out), 2);
+    EXPECT_EQ(out.overflow, 1u);
+    EXPECT_EQ(results.row[0], 0u);
+    EXPECT_EQ(results.row[1], 1u);
+    EXPECT_EQ(results.type[1], ANOMALY_HIGH_LATENCY);
+
+    batch.latency_ms = nullptr;
+    EXPECT_EQ(anomaly_detector_analyze(detector, &batch, &out), -1);
+    EXPECT_EQ(anomaly_detector_analyze(nullptr, &batch, &out), -1);
+    EXPECT_STREQ(anomaly_type_name(99), "NONE");
+    anomaly_detector_destroy(detector);
+}
@@ -0,0 +1,56 @@
+// Follow the live alert stream published by 5g-anomaly-detector.
+//
+//   alert-tail [stream-name]      (default /5g-alerts)
+//
+// Prints one line per alert as it is raised. Alerts missed because this
+// reader fell behind the publisher are reported, not silently dropped.
+#include "AlertStream.h"
+#include "Packet.h"
+#include <csignal>
+#include <iostream>
+#include <thread>
+#include <chrono>
+
+namespace {
+volatile std::sig_atomic_t g_stop = 0;
+void onSignal(int) { g_stop = 1; }
+}
+
+int main(int argc, char** argv) {
+    using namespace anomaly;
+    std::string name = argc > 1 ? argv[1] : "/5g-alerts";
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::unique_ptr<AlertStreamReader> reader;
+    while (!g_stop && !(reader = AlertStreamReader::open(name))) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+    if (!reader) return 0;
+    std::cerr << "Following " << name << "\n";
+
+    std::vector<stream::AlertRecord> records;
+    uint64_t reported_overruns = 0;
+    while (!g_stop) {
+        records.clear();
+        if (reader->poll(records) == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        if (reader->overruns() != reported_overruns) {
+            std::cerr << "[missed " << reader->overruns() - reported_overruns
+                      << " alerts]\n";
+            reported_overruns = reader->overruns();
+        }
+        for (const auto& r : records) {
+            std::cout << "#" << r.alert_seq << " "
+                      << alertLevelName(static_cast<AlertLevel>(r.level)) << " "
+                      << anomalyTypeName(static_cast<AnomalyType>(r.type)) << " "
+                      << r.source_ip << " severity=" << r.severity << " "
+                      << std::string(r.message, r.message_len) << "\n";
+        }
+        std::cout.flush();
+    }
+    return 0;
+}
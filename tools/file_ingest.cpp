@@ -0,0 +1,94 @@
+// Ingest captured/recorded trace files into the detection engine as fast as
+// they can be read.
+//
+//   file-ingest <dir | file...> [--depth N] [--block KB] [--threads N]
+//               [--pread] [--workers N]
+//
+// A directory argument expands to its regular files in name order, so
+// rotated captures are read oldest first. Files may be binary traces or
+// text (see trace-replay). Up to --depth reads of --block KiB are in flight
+// at once, through io_uring when available (--pread forces the pread
+// thread pool), while the current block is parsed. Unlike trace-replay,
+// there is no pacing: packets go to the monitor as soon as they are read.
+#include "FileIngest.h"
+#include "NetworkMonitor.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace anomaly;
+
+int main(int argc, char** argv) {
+    FileIngestConfig config;
+    MonitorConfig monitor_config;
+    std::vector<std::string> paths;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (!std::strcmp(arg, "--pread")) {
+            config.use_io_uring = false;
+            continue;
+        }
+        if (std::strncmp(arg, "--", 2) != 0) {
+            if (std::filesystem::is_directory(arg)) {
+                for (auto& p : FileIngest::listDirectory(arg)) paths.push_back(p);
+            } else {
+                paths.push_back(arg);
+            }
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", arg);
+            return 1;
+        }
+        const char* val = argv[++i];
+        if (!std::strcmp(arg, "--depth"))        config.queue_depth = std::strtoul(val, nullptr, 10);
+        else if (!std::strcmp(arg, "--block"))   config.block_size = std::strtoul(val, nullptr, 10) * 1024;
+        else if (!std::strcmp(arg, "--threads")) config.threads = std::strtoul(val, nullptr, 10);
+        else if (!std::strcmp(arg, "--workers")) monitor_config.workers = std::strtoul(val, nullptr, 10);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", arg);
+            return 1;
+        }
+    }
+    if (paths.empty()) {
+        std::fprintf(stderr, "usage: %s <dir | file...> [--depth N] [--block KB] "
+                             "[--threads N] [--pread] [--workers N]\n", argv[0]);
+        return 1;
+    }
+
+    DetectorConfig detector_config;
+    detector_config.shard_count = static_cast<uint32_t>(monitor_config.workers);
+    AlertManagerConfig alert_config;
+    alert_config.log.console = false;
+
+    auto detector = std::make_shared<AnomalyDetector>(detector_config);
+    auto alerts   = std::make_shared<AlertManager>("file-ingest.log", alert_config);
+    NetworkMonitor monitor(detector, alerts, nullptr, monitor_config);
+
+    FileIngest ingest(config);
+    monitor.start();
+    FileIngestStats stats = ingest.run(paths, monitor);
+    monitor.stop();
+
+    std::printf("backend    %s\n", ingest.backend());
+    std::printf("read       %llu files, %.1f MB in %.2f s (%.0f MB/s), %llu reads\n",
+                static_cast<unsigned long long>(stats.files),
+                static_cast<double>(stats.bytes) / 1e6, stats.seconds, stats.mb_per_sec,
+                static_cast<unsigned long long>(stats.reads));
+    std::printf("packets    %llu parsed (%.0f/s), %llu accepted, %llu skipped\n",
+                static_cast<unsigned long long>(stats.packets),
+                stats.seconds > 0 ? static_cast<double>(stats.packets) / stats.seconds : 0.0,
+                static_cast<unsigned long long>(stats.accepted),
+                static_cast<unsigned long long>(stats.skipped));
+    std::printf("alerts     %zu\n", alerts->count());
+    if (stats.failed_files > 0) {
+        std::printf("failed     %llu files\n",
+                    static_cast<unsigned long long>(stats.failed_files));
+    }
+    return stats.failed_files > 0 ? 1 : 0;
+}
@@ -0,0 +1,148 @@
+// Send generated traffic as text records to an IngestServer.
+//
+//   ingest-send (--udp HOST:PORT | --unix PATH) [--duration S] [--rate PPS]
+//               [--sources N] [--seed N] [--per-datagram N] [--batch N]
+//
+// Records are TrafficGenerator packets in PacketProcessor's format with
+// their event timestamps, --per-datagram of them (default 16) per
+// datagram, newline-separated, and --batch datagrams (default 64) per
+// sendmmsg call. Everything is formatted up front so the send loop runs
+// at full speed. --duration and --rate size the traffic in event time.
+// UDP sends never wait for the receiver, so compare the count here with
+// the server's; a Unix datagram socket blocks the sender instead.
+#include "TrafficGenerator.h"
+#include "PacketProcessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace anomaly;
+
+int main(int argc, char** argv) {
+    TrafficConfig traffic;
+    traffic.packets_per_sec = 1'000'000;
+    double duration = 2.0;
+    size_t per_datagram = 16;
+    size_t batch = 64;
+    std::string udp_target, unix_path;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char* flag = argv[i];
+        const char* val  = argv[i + 1];
+        if (!std::strcmp(flag, "--udp"))               udp_target = val;
+        else if (!std::strcmp(flag, "--unix"))         unix_path = val;
+        else if (!std::strcmp(flag, "--duration"))     duration = std::atof(val);
+        else if (!std::strcmp(flag, "--rate"))         traffic.packets_per_sec = std::atof(val);
+        else if (!std::strcmp(flag, "--sources"))      traffic.sources = std::strtoul(val, nullptr, 10);
+        else if (!std::strcmp(flag, "--seed"))         traffic.seed = std::strtoull(val, nullptr, 10);
+        else if (!std::strcmp(flag, "--per-datagram")) per_datagram = std::strtoul(val, nullptr, 10);
+        else if (!std::strcmp(flag, "--batch"))        batch = std::strtoul(val, nullptr, 10);
+        else {
+            std::fprintf(stderr, "unknown option %s\n", flag);
+            return 1;
+        }
+    }
+    if (udp_target.empty() == unix_path.empty()) {
+        std::fprintf(stderr, "usage: %s (--udp HOST:PORT | --unix PATH) [--duration S] "
+                             "[--rate PPS] [--sources N] [--seed N] [--per-datagram N] "
+                             "[--batch N]\n", argv[0]);
+        return 1;
+    }
+    per_datagram = std::max<size_t>(1, per_datagram);
+    batch        = std::max<size_t>(1, batch);
+
+    sockaddr_storage addr{};
+    socklen_t addr_len = 0;
+    int fd = -1;
+    if (!unix_path.empty()) {
+        auto* un = reinterpret_cast<sockaddr_un*>(&addr);
+        if (unix_path.size() >= sizeof(un->sun_path)) {
+            std::fprintf(stderr, "socket path too long\n");
+            return 1;
+        }
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, unix_path.c_str(), unix_path.size() + 1);
+        addr_len = sizeof(sockaddr_un);
+        fd = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    } else {
+        auto* in = reinterpret_cast<sockaddr_in*>(&addr);
+        auto colon = udp_target.rfind(':');
+        in->sin_family = AF_INET;
+        in->sin_port   = htons(static_cast<uint16_t>(
+            std::atoi(udp_target.c_str() + colon + 1)));
+        if (colon == std::string::npos ||
+            ::inet_pton(AF_INET, udp_target.substr(0, colon).c_str(), &in->sin_addr) != 1) {
+            std::fprintf(stderr, "bad address %s\n", udp_target.c_str());
+            return 1;
+        }
+        addr_len = sizeof(sockaddr_in);
+        fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+    }
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), addr_len) != 0) {
+        std::perror("connect");
+        return 1;
+    }
+
+    // Format every datagram before timing the sends
+    TrafficGenerator generator(traffic);
+    auto stream = generator.stream(0, 1, duration);
+    PacketProcessor processor;
+    std::vector<std::string> datagrams;
+    std::vector<Packet> packets;
+    uint64_t records = 0;
+    while (stream.next(packets, per_datagram) > 0) {
+        std::string dgram;
+        for (const auto& p : packets) {
+            dgram += processor.formatPacket(p);
+            dgram += '\n';
+        }
+        records += packets.size();
+        datagrams.push_back(std::move(dgram));
+        packets.clear();
+    }
+
+    std::vector<iovec> iovecs(batch);
+    std::vector<mmsghdr> headers(batch);
+    uint64_t sent = 0, failed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < datagrams.size();) {
+        size_t n = std::min(batch, datagrams.size() - i);
+        for (size_t k = 0; k < n; ++k) {
+            iovecs[k].iov_base = datagrams[i + k].data();
+            iovecs[k].iov_len  = datagrams[i + k].size();
+            headers[k] = mmsghdr{};
+            headers[k].msg_hdr.msg_iov    = &iovecs[k];
+            headers[k].msg_hdr.msg_iovlen = 1;
+        }
+        int got = ::sendmmsg(fd, headers.data(), static_cast<unsigned>(n), 0);
+        if (got <= 0) {
+            // Skip the datagram that failed (e.g. ECONNREFUSED before the
+            // server is up) rather than spinning on it
+            ++failed;
+            ++i;
+            continue;
+        }
+        sent += static_cast<uint64_t>(got);
+        i += static_cast<size_t>(got);
+    }
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ::close(fd);
+
+    std::printf("sent       %llu of %zu datagrams (%llu records) in %.2f s, %.0f records/s\n",
+                static_cast<unsigned long long>(sent), datagrams.size(),
+                static_cast<unsigned long long>(records), secs,
+                secs > 0 ? static_cast<double>(records) / secs : 0.0);
+    if (failed > 0) {
+        std::printf("failed     %llu datagrams\n", static_cast<unsigned long long>(failed));
+    }
+    return 0;
+}